@@ -110,6 +110,16 @@ void arm_fir_f32(const arm_fir_instance_f32* S,
     uint32_t blockSize 
 );
 
+/**
+ * Products are accumulated in 64 bits (2.62) and truncated back to 1.31.
+ * @param blockSize Number of INPUT samples to process
+ */
+void arm_fir_q31(const arm_fir_instance_q31* S,
+    const q31_t* pSrc,
+    q31_t* pDst,
+    uint32_t blockSize 
+);
+
 /**
  * @param blockSize Number of INPUT samples to process
  */
@@ -15,7 +15,8 @@ void arm_fir_init_f32(arm_fir_instance_f32*	s,
     s->pCoeffs = pCoeffs;
     // EXTRA
     s->blockSize = blockSize;
-    for (unsigned i = 0; i < numTaps - 1; i++)
+    // Same as CMSIS, the whole state area is cleared
+    for (unsigned i = 0; i < numTaps + blockSize - 1; i++)
         s->pState[i] = 0;
 }
 
@@ -33,7 +34,8 @@ arm_status arm_fir_decimate_init_f32(arm_fir_decimate_instance_f32* s,
     s->pCoeffs = pCoeffs;
     // EXTRA
     s->blockSize = blockSize;
-    for (unsigned i = 0; i < numTaps - 1; i++)
+    // Same as CMSIS, the whole state area is cleared
+    for (unsigned i = 0; i < numTaps + blockSize - 1; i++)
         s->pState[i] = 0;
     return arm_status::ARM_MATH_SUCCESS;
 }
@@ -51,37 +53,83 @@ arm_status arm_fir_interpolate_init_f32(arm_fir_interpolate_instance_f32* s,
     s->pCoeffs = pCoeffs;
     // EXTRA
     s->blockSize = blockSize;
-    for (unsigned i = 0; i < numTaps / L - 1; i++)
+    // Same as CMSIS, the whole state area is cleared
+    for (unsigned i = 0; i < numTaps / L + blockSize - 1; i++)
         s->pState[i] = 0;
     return arm_status::ARM_MATH_SUCCESS;
 }
 
+void arm_fir_init_q31(arm_fir_instance_q31* s,
+    uint16_t numTaps,
+    const q31_t* pCoeffs,
+    q31_t* pState,
+    uint32_t blockSize) {
+    s->numTaps = numTaps;
+    s->pState = pState;
+    s->pCoeffs = pCoeffs;
+    // EXTRA
+    s->blockSize = blockSize;
+    for (unsigned i = 0; i < numTaps + blockSize - 1; i++)
+        s->pState[i] = 0;
+}
+
+// All of the filters use the same state layout as CMSIS: the history 
+// (oldest sample first) followed by room for one block of new samples. 
+// The new block is copied in, the outputs are computed straight out of 
+// the state, and then the newest history is moved back to the front. 
+// That copy is proportional to the number of taps, which is small next 
+// to the taps x block size multiply-adds.
+//
+// The multiply-adds are done for LANES outputs at a time so that the 
+// inner loop has no dependencies between iterations and the compiler can
+// turn it into SIMD instructions. Each output is still summed one tap at
+// a time in order, so the results are exactly the same as doing one 
+// output at a time.
+static const unsigned LANES = 8;
+
+/**
+ * Computes count outputs of an FIR. Output k is the dot product of the 
+ * coefficients and numTaps samples starting at history[k * STRIDE].
+ * Zero taps (i.e. half-band filters) are skipped.
+ */
+template<unsigned STRIDE> static void firDot(const float32_t* history,
+    const float32_t* coeffs, unsigned numTaps, unsigned coeffStride,
+    float32_t* out, unsigned outStride, unsigned count) {
+    unsigned k = 0;
+    for (; k + LANES <= count; k += LANES) {
+        float32_t acc[LANES] = { };
+        const float32_t* x = history + k * STRIDE;
+        for (unsigned i = 0; i < numTaps; i++, x++) {
+            const float32_t c = coeffs[i * coeffStride];
+            if (c == 0)
+                continue;
+            for (unsigned l = 0; l < LANES; l++)
+                acc[l] += x[l * STRIDE] * c;
+        }
+        for (unsigned l = 0; l < LANES; l++)
+            out[(k + l) * outStride] = acc[l];
+    }
+    for (; k < count; k++) {
+        float32_t a = 0;
+        const float32_t* x = history + k * STRIDE;
+        for (unsigned i = 0; i < numTaps; i++) {
+            const float32_t c = coeffs[i * coeffStride];
+            if (c != 0)
+                a += x[i] * c;
+        }
+        out[k * outStride] = a;
+    }
+}
+
 void arm_fir_f32(const arm_fir_instance_f32* s,
     const float32_t* pSrc,
     float32_t* pDst,
     uint32_t blockSize) {
     assert(blockSize == s->blockSize);
-    // Shift left to free space for new data   
-    memmove((void*)(s->pState), (const void*)&(s->pState[blockSize]), 
-        (s->numTaps - 1) * sizeof(float32_t));
-    // Fill in new data on far right
-    memcpy((void*)&(s->pState[s->numTaps - 1]), (const void*)pSrc, 
-        blockSize * sizeof(float32_t));
-    // Do the MA
-    const float32_t* dataHistory = s->pState;
-    for (unsigned k = 0; k < blockSize; k++) {
-        float a = 0;
-        for (unsigned i = 0; i < s->numTaps; i++)
-            a += dataHistory[i] * s->pCoeffs[i];
-        pDst[k] = a;
-        dataHistory++;
-    }
-}
-
-// TODO: CONSOLIDATE
-static q31_t mult_q31(q31_t a, q31_t b) {
-    int64_t c = a * b;
-    return c >> 31;
+    const unsigned h = s->numTaps - 1;
+    memcpy(s->pState + h, pSrc, blockSize * sizeof(float32_t));
+    firDot<1>(s->pState, s->pCoeffs, s->numTaps, 1, pDst, 1, blockSize);
+    memmove(s->pState, s->pState + blockSize, h * sizeof(float32_t));
 }
 
 void arm_fir_q31(const arm_fir_instance_q31* s,
@@ -89,22 +137,18 @@ void arm_fir_q31(const arm_fir_instance_q31* s,
     q31_t* pDst,
     uint32_t blockSize) {
     assert(blockSize == s->blockSize);
-    // Shift left to free space for new data   
-    memmove((void*)(s->pState), (const void*)&(s->pState[blockSize]), 
-        (s->numTaps - 1) * sizeof(q31_t));
-    // Fill in new data on far right
-    memcpy((void*)&(s->pState[s->numTaps - 1]), (const void*)pSrc, 
-        blockSize * sizeof(q31_t));
-    // Do the MA
-    const q31_t* dataHistory = s->pState;
+    const unsigned h = s->numTaps - 1;
+    memcpy(s->pState + h, pSrc, blockSize * sizeof(q31_t));
+    // Same as CMSIS: the 1.31 x 1.31 products are accumulated in a 64-bit
+    // (2.62) accumulator that is truncated back to 1.31 at the end.
     for (unsigned k = 0; k < blockSize; k++) {
-        q31_t a = 0;
+        const q31_t* x = s->pState + k;
+        int64_t acc = 0;
         for (unsigned i = 0; i < s->numTaps; i++)
-            //a += dataHistory[i] * s->pCoeffs[i];
-            a += mult_q31(dataHistory[i], s->pCoeffs[i]);
-        pDst[k] = a;
-        dataHistory++;
+            acc += (int64_t)x[i] * (int64_t)s->pCoeffs[i];
+        pDst[k] = (q31_t)(acc >> 31);
     }
+    memmove(s->pState, s->pState + blockSize, h * sizeof(q31_t));
 }
 
 void arm_fir_decimate_f32(const arm_fir_decimate_instance_f32* s,
@@ -112,26 +156,13 @@ void arm_fir_decimate_f32(const arm_fir_decimate_instance_f32* s,
     float32_t* pDst,
     uint32_t blockSize) {
     assert(blockSize == s->blockSize);
-    // Shift left to free space for new data. At the end of this 
-    // operation the oldest sample will be at the lowest memory
-    // location and the highest locations will be availlable.  
-    memmove((void*)(s->pState), (const void*)&(s->pState[blockSize]), 
-        (s->numTaps - 1) * sizeof(float32_t));
-    // Fill in new data on far right (highest). At the end of 
-    // this operation the newest sample will be at the highest 
-    // memory location.
-    memcpy((void*)&(s->pState[s->numTaps - 1]), (const void*)pSrc, 
-        blockSize * sizeof(float32_t));
-    // Do the MA
-    const float32_t* dataHistory = s->pState;
-    // Here we are only processing every other output point
-    for (unsigned k = 0; k < blockSize / 2; k++) {
-        float a = 0;
-        for (unsigned i = 0; i < s->numTaps; i++)
-            a += dataHistory[i] * s->pCoeffs[i];
-        pDst[k] = a;
-        dataHistory += 2;
-    }
+    const unsigned h = s->numTaps - 1;
+    memcpy(s->pState + h, pSrc, blockSize * sizeof(float32_t));
+    // Only the outputs that survive are computed. As with CMSIS, the 
+    // newest input sample used for output k is pSrc[2k + 1] (M is 
+    // always 2 here, see the init).
+    firDot<2>(s->pState + 1, s->pCoeffs, s->numTaps, 1, pDst, 1, blockSize / 2);
+    memmove(s->pState, s->pState + blockSize, h * sizeof(float32_t));
 }
 
 void arm_fir_interpolate_f32(const arm_fir_interpolate_instance_f32* s,
@@ -139,59 +170,49 @@ void arm_fir_interpolate_f32(const arm_fir_interpolate_instance_f32* s,
     float32_t* pDst,
     uint32_t blockSize)	{
     assert(blockSize == s->blockSize);
-    unsigned numTaps = s->phaseLength * s->L;
-    // Shift left to free space for new data. At the end of this 
-    // operation the oldest sample will be at the lowest memory
-    // location and the highest locations will be availlable.  
-    memmove((void*)(s->pState), (const void*)&(s->pState[blockSize]), 
-        (numTaps - 1) * sizeof(float32_t));
-    // Fill in new data on far right (highest). At the end of 
-    // this operation the newest sample will be at the highest 
-    // memory location.
-    memcpy((void*)&(s->pState[numTaps - 1]), (const void*)pSrc, 
-        blockSize * sizeof(float32_t));
-    // Do the multipy-add
-    const float32_t* dataHistory = s->pState;
-    unsigned phaseStart = 0;
-    // k iterates through the output positions
-    for (unsigned k = 0; k < blockSize * s->L; k++) {
-        float a = 0;
-        // The starting point for the iteration across the filter coefficients
-        // rotates through L possible starting points. The increment is always
-        // L.  THIS IS ESSENTIALLY A POLYPHASE FILTER.
-        // 
-        // i is iterating across the input history
-        // j is iterating accross the coefficients
-        for (unsigned i = 0, j = phaseStart; i < s->phaseLength; i++, j += s->L) {
-            //assert( j < numTaps);
-            a += dataHistory[i] * s->pCoeffs[j];
-        }
-        //assert(k < blockSize * s->L);
-        pDst[k] = a;
-        // Advance on the data history and filter coefficient starting point.
-        if (phaseStart == 0) {
-            // At the completion of phase 0 we shift to the next input sample
-            ++dataHistory;
-            // Wrap around to the next phase
-            phaseStart = s->L - 1;
-        }
-        else {
-            // Loop through the L phases
-            phaseStart--;
-        }
-    }
+    const unsigned h = s->phaseLength - 1;
+    memcpy(s->pState + h, pSrc, blockSize * sizeof(float32_t));
+    // THIS IS ESSENTIALLY A POLYPHASE FILTER. Each input sample n 
+    // produces L outputs, all of which use the phaseLength samples 
+    // ending at that input. Output n * L + j uses every L'th coefficient
+    // starting at L - 1 - j (same as CMSIS).
+    for (unsigned j = 0; j < s->L; j++)
+        firDot<1>(s->pState, s->pCoeffs + (s->L - 1 - j), s->phaseLength, s->L,
+            pDst + j, s->L, blockSize);
+    memmove(s->pState, s->pState + blockSize, h * sizeof(float32_t));
 }
 
-
 void arm_biquad_cascade_df1_init_f32(arm_biquad_casd_df1_inst_f32* s, 
     uint8_t numStages, const float32_t* pCoeffs, 
     float32_t *pState) {
-    // #### TODO
+    s->numStages = numStages;
+    s->pCoeffs = pCoeffs;
+    s->pState = pState;
+    for (unsigned i = 0; i < 4 * numStages; i++)
+        s->pState[i] = 0;
 }
 
 void arm_biquad_cascade_df1_f32(const arm_biquad_casd_df1_inst_f32* s, 
     const float32_t* pSrc, float32_t* pDst, uint32_t blockSize) {
-    // #### TODO
+    // The first stage works from the input and the others work in place
+    // on the output.
+    const float32_t* in = pSrc;
+    for (unsigned stage = 0; stage < s->numStages; stage++) {
+        const float32_t* c = s->pCoeffs + 5 * stage;
+        float32_t* st = s->pState + 4 * stage;
+        float32_t x1 = st[0], x2 = st[1], y1 = st[2], y2 = st[3];
+        for (unsigned i = 0; i < blockSize; i++) {
+            const float32_t x0 = in[i];
+            const float32_t y0 = c[0] * x0 + c[1] * x1 + c[2] * x2 + c[3] * y1 + c[4] * y2;
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = y0;
+            pDst[i] = y0;
+        }
+        st[0] = x1; st[1] = x2; st[2] = y1; st[3] = y2;
+        in = pDst;
+    }
 }
 
 void arm_rms_f32(const float32_t* pSrc,
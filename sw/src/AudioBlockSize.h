@@ -0,0 +1,35 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+// Number of 32k CODEC samples in an audio block. This controls the
+// DMA buffers, the audio processing tick, and the 8k block size
+// (which is 1/4 of this value). Smaller blocks reduce the latency
+// through the repeater at the cost of more per-block overhead.
+//
+// Normally set from the build (-DAUDIO_BLOCK_SIZE_ADC=xxx).
+// Supported values are 64 (2ms), 128 (4ms) and 256 (8ms).
+#ifndef AUDIO_BLOCK_SIZE_ADC
+#define AUDIO_BLOCK_SIZE_ADC (256)
+#endif
+
+#if AUDIO_BLOCK_SIZE_ADC != 64 && AUDIO_BLOCK_SIZE_ADC != 128 && AUDIO_BLOCK_SIZE_ADC != 256
+#error "AUDIO_BLOCK_SIZE_ADC must be 64, 128 or 256"
+#endif
@@ -27,26 +27,14 @@
 
 #include <arm_math.h>
 
-#ifdef PICO_BUILD
-#include <hardware/sync.h>
-#endif
-
 using namespace std;
 
 namespace kc1fsz {
 
 // NOTE: REMEMBER: FIR coefficients need to be in reverse order for ARM CMSIS-DSP!
 
-// HPF for noise measurement 41 taps, [0, 4000/32000]:0, [6000/32000, 0.5]:1.0
-const float AudioCore::FILTER_B[] = 
-{
-//0.009496502349662752, 0.032168266001826, -0.004020017447607337, -0.029774359071379836, -0.03025119554604127, 0.02111609845361212, 0.07216728736619965, 0.038324850322965634, -0.10997562615757675, -0.292262898960302, 0.6251660988707263, -0.292262898960302, -0.10997562615757675, 0.038324850322965634, 0.07216728736619965, 0.02111609845361212, -0.03025119554604127, -0.029774359071379836, -0.004020017447607337, 0.032168266001826, 0.009496502349662752
-// REVERSE COEFFICIENTS!
-0.009496502349662725, 0.03216826600182601, -0.004020017447607354, -0.029774359071379798, -0.030251195546041294, 0.02111609845361209, 0.07216728736619958, 0.03832485032296566, -0.10997562615757675, -0.292262898960302, 0.6251660988707263, -0.292262898960302, -0.10997562615757675, 0.03832485032296566, 0.07216728736619958, 0.02111609845361209, -0.030251195546041294, -0.029774359071379798, -0.004020017447607354, 0.03216826600182601, 0.009496502349662725
-};
-
 // Half-band LPF for decimation
-const float AudioCore::FILTER_C[] =
+static const float FILTER_C[] =
 {
 //0, -0.0022612636393077577, 0, 0.003657523706990156, 0, -0.006253237573582923, 0, 0.010223415066636696, 0, -0.015918543076970815, 0, 0.02405816723332713, 0, -0.03626191327686043, 0, 0.05685837837449928, 0, -0.10193071949733788, 0, 0.3169038896556724, 0.5, 0.3169038896556724, 0, -0.10193071949733788, 0, 0.05685837837449928, 0, -0.03626191327686043, 0, 0.02405816723332713, 0, -0.015918543076970815, 0, 0.010223415066636696, 0, -0.006253237573582923, 0, 0.003657523706990156, 0, -0.0022612636393077577, 0
 // REVERSE COEFFICIENTS!
@@ -55,7 +43,7 @@ const float AudioCore::FILTER_C[] =
 
 // HPF used for CTCSS removal
 // REVERSE COEFFICIENTS!
-const float AudioCore::FILTER_F[] =
+static const float FILTER_F[] =
 {
 // 127-tap original:
 //0.02070878043975188, -0.006324224216431379, -0.005677798561569507, -0.00524354475350004, -0.004981349594381399, -0.004834153754098684, -0.004772565887540212, -0.00475204225422949, -0.004757955427671967, -0.004750627578011964, -0.004722972879043864, -0.0046412797618454816, -0.004505862994306819, -0.0042899016990077905, -0.004001130994563254, -0.003617926747297938, -0.0031444444584648773, -0.0025782470861995853, -0.0019310525006366308, -0.0011943519959224554, -0.00038634036373217404, 0.00048195834490003496, 0.0013952400918113266, 0.002350030994395716, 0.0033068661738514518, 0.00426761387676808, 0.005189712702783839, 0.006071611363913372, 0.0068673749896513165, 0.007575400302018154, 0.008148252885193111, 0.008588320131040005, 0.008847911269918846, 0.008938981791615196, 0.00881346396800166, 0.008450962969732459, 0.007920025301270863, 0.007078656392525976, 0.006006329167054252, 0.004702732580582351, 0.003160114368198346, 0.001365775395616708, -0.0006632435270387494, -0.002904238751413749, -0.005337808947427522, -0.007936908045186666, -0.010682263471881944, -0.013540933193764227, -0.016488077352270338, -0.01948458899210727, -0.022501406948924135, -0.025495934574520162, -0.02842232630231531, -0.031243661790454232, -0.03393235354327609, -0.03645310897965045, -0.0387515941537407, -0.04082195111747263, -0.04262951823796724, -0.04413542485054956, -0.04533888415639066, -0.04620383813872065, -0.04673512105434083, 0.953092637712722, -0.04673512105434083, -0.04620383813872065, -0.04533888415639066, -0.04413542485054956, -0.04262951823796724, -0.04082195111747263, -0.0387515941537407, -0.03645310897965045, -0.03393235354327609, -0.031243661790454232, -0.02842232630231531, -0.025495934574520162, -0.022501406948924135, -0.01948458899210727, -0.016488077352270338, -0.013540933193764227, -0.010682263471881944, -0.007936908045186666, -0.005337808947427522, -0.002904238751413749, -0.0006632435270387494, 0.001365775395616708, 0.003160114368198346, 0.004702732580582351, 0.006006329167054252, 0.007078656392525976, 0.007920025301270863, 0.008450962969732459, 0.00881346396800166, 0.008938981791615196, 0.008847911269918846, 0.008588320131040005, 0.008148252885193111, 0.007575400302018154, 0.0068673749896513165, 0.006071611363913372, 0.005189712702783839, 0.00426761387676808, 0.0033068661738514518, 0.002350030994395716, 0.0013952400918113266, 0.00048195834490003496, -0.00038634036373217404, -0.0011943519959224554, -0.0019310525006366308, -0.0025782470861995853, -0.0031444444584648773, -0.003617926747297938, -0.004001130994563254, -0.0042899016990077905, -0.004505862994306819, -0.0046412797618454816, -0.004722972879043864, -0.004750627578011964, -0.004757955427671967, -0.00475204225422949, -0.004772565887540212, -0.004834153754098684, -0.004981349594381399, -0.00524354475350004, -0.005677798561569507, -0.006324224216431379, 0.02070878043975188
@@ -66,7 +54,7 @@ const float AudioCore::FILTER_F[] =
 };
 
 // LPF for interpolation
-const float AudioCore::FILTER_N[] =
+static const float FILTER_N[] =
 {
 // REVERSE COEFFICIENTS!
 //-0.0019825341580406775, 0.0012963792259580215, 0.001293907866250324, 0.0013765109242978076, 0.0013968186928423024, 0.0012480721545734112, 0.0008800216715366516, 0.00030426721961879016, -0.0004024394043320078, -0.0011136850206245447, -0.0016755131354902427, -0.0019434746619824052, -0.0018146968228833946, -0.0012610574278670691, -0.00034442156978793713, 0.0007801426854267996, 0.0018929383213531323, 0.002743885527609692, 0.003109694178350429, 0.002844304050723996, 0.0019227175794022645, 0.00046147955762847485, -0.001287889586019224, -0.002980307044482419, -0.0042383244079130114, -0.004734140148539201, -0.00426519749959238, -0.002815047457251659, -0.0005787159006973347, 0.00205413924351423, 0.0045616984757730515, 0.006387149532614009, 0.007054086354219846, 0.006279682528275538, 0.004056395231688764, 0.0006896069110308182, -0.0032408629789279753, -0.006951255288381242, -0.009629788140398098, -0.010565495097337086, -0.009333139035536057, -0.00592599261244852, -0.0007843498147293366, 0.005223603470014924, 0.010936156689657379, 0.01508938806936962, 0.01657187665663939, 0.014661602074320943, 0.009233638479219456, 0.0008600121296568335, -0.009193261941836084, -0.019112753997065607, -0.02677678199239151, -0.030102246253995386, -0.027394183148712364, -0.01767306201867829, -0.0009078337587586828, 0.02189194212625807, 0.048744329511468336, 0.07692043188583148, 0.10330470554818026, 0.12482383586152623, 0.13889094803946475, 0.1437812874579531, 0.13889094803946475, 0.12482383586152623, 0.10330470554818026, 0.07692043188583148, 0.048744329511468336, 0.02189194212625807, -0.0009078337587586828, -0.01767306201867829, -0.027394183148712364, -0.030102246253995386, -0.02677678199239151, -0.019112753997065607, -0.009193261941836084, 0.0008600121296568335, 0.009233638479219456, 0.014661602074320943, 0.01657187665663939, 0.01508938806936962, 0.010936156689657379, 0.005223603470014924, -0.0007843498147293366, -0.00592599261244852, -0.009333139035536057, -0.010565495097337086, -0.009629788140398098, -0.006951255288381242, -0.0032408629789279753, 0.0006896069110308182, 0.004056395231688764, 0.006279682528275538, 0.007054086354219846, 0.006387149532614009, 0.0045616984757730515, 0.00205413924351423, -0.0005787159006973347, -0.002815047457251659, -0.00426519749959238, -0.004734140148539201, -0.0042383244079130114, -0.002980307044482419, -0.001287889586019224, 0.00046147955762847485, 0.0019227175794022645, 0.002844304050723996, 0.003109694178350429, 0.002743885527609692, 0.0018929383213531323, 0.0007801426854267996, -0.00034442156978793713, -0.0012610574278670691, -0.0018146968228833946, -0.0019434746619824052, -0.0016755131354902427, -0.0011136850206245447, -0.0004024394043320078, 0.00030426721961879016, 0.0008800216715366516, 0.0012480721545734112, 0.0013968186928423024, 0.0013765109242978076, 0.001293907866250324, 0.0012963792259580215, -0.0019825341580406775
@@ -78,15 +66,18 @@ const float AudioCore::FILTER_N[] =
 0.0005572937138517061, -0.0030636259464356533, -0.0013676556767146801, -0.000633893424690145, 0.00023440808546965194, 0.00107779318132219, 0.0014892233265632092, 0.0011850227967143585, 0.0002083171977904706, -0.0010337658605629406, -0.001930301257981993, -0.001957040461460326, -0.0009692278645551276, 0.0006663011328026081, 0.0021907716539832185, 0.0027970960328218882, 0.0020412397816721366, 0.00012992855003948756, -0.0021052963480760866, -0.0035519481436693517, -0.0033620040275903697, -0.0014205445998324612, 0.0014965558210901873, 0.004014851649425318, 0.004790092788402415, 0.0032094508217984773, -0.00020941096720659687, -0.003938305262073914, -0.006108148826720405, -0.005418752873254499, -0.0018782103130357566, 0.0030521228339721986, 0.0070209427684541255, 0.007888479637379531, 0.0048291909994736424, -0.0010728363905925737, -0.007163848315106745, -0.0103487432871681, -0.008641056326419507, -0.0022895958452259155, 0.0060766450752190925, 0.01244418119364951, 0.013288249217044282, 0.007404870353549808, -0.003159148695155765, -0.013687122422041209, -0.01876882939368493, -0.01491525867196002, -0.002596825311417532, 0.013346551898607829, 0.02536808610954708, 0.02643509361206034, 0.013574585072858057, -0.00989124649542537, -0.03456092897640826, -0.047881464574771854, -0.038855750010794374, -0.0027638364288998293, 0.056045248197843206, 0.12458961378328931, 0.1849999167267121, 0.22033099103023165, 0.22033099103023165, 0.1849999167267121, 0.12458961378328931, 0.056045248197843206, -0.0027638364288998293, -0.038855750010794374, -0.047881464574771854, -0.03456092897640826, -0.00989124649542537, 0.013574585072858057, 0.02643509361206034, 0.02536808610954708, 0.013346551898607829, -0.002596825311417532, -0.01491525867196002, -0.01876882939368493, -0.013687122422041209, -0.003159148695155765, 0.007404870353549808, 0.013288249217044282, 0.01244418119364951, 0.0060766450752190925, -0.0022895958452259155, -0.008641056326419507, -0.0103487432871681, -0.007163848315106745, -0.0010728363905925737, 0.0048291909994736424, 0.007888479637379531, 0.0070209427684541255, 0.0030521228339721986, -0.0018782103130357566, -0.005418752873254499, -0.006108148826720405, -0.003938305262073914, -0.00020941096720659687, 0.0032094508217984773, 0.004790092788402415, 0.004014851649425318, 0.0014965558210901873, -0.0014205445998324612, -0.0033620040275903697, -0.0035519481436693517, -0.0021052963480760866, 0.00012992855003948756, 0.0020412397816721366, 0.0027970960328218882, 0.0021907716539832185, 0.0006663011328026081, -0.0009692278645551276, -0.001957040461460326, -0.001930301257981993, -0.0010337658605629406, 0.0002083171977904706, 0.0011850227967143585, 0.0014892233265632092, 0.00107779318132219, 0.00023440808546965194, -0.000633893424690145, -0.0013676556767146801, -0.0030636259464356533, 0.0005572937138517061
 };
 
-// LPF for de-emphasis
+// LPF for de-emphasis (75us, 2120 Hz corner, bilinear with pre-warping)
 // The coefficients are stored in the array pCoeffs in the following order:
 // { b10, b11, b12, a11, a12, b20, b21, b22, a21, a22, ...}
-const float AudioCore::FILTER_J[] = 
+static const float FILTER_J[] = 
 {
-    0.17436489093174606,
-    0.17436489093174606,
+// Original 32k version (before the filter was moved after the decimation)
+//    0.17436489093174606, 0.17436489093174606, 0, 0.6512702181365079, 0
+// 8k version
+    0.5235794014387403,
+    0.5235794014387403,
     0,
-    0.6512702181365079,
+    -0.04715880287748051,
     0
 };
 
@@ -104,34 +95,119 @@ static unsigned decAndWrap(unsigned i, unsigned len) {
         return i - 1;
 }
 
-AudioCore::AudioCore(unsigned id, unsigned crossCount, Clock& clock)
+template<unsigned BS>
+AudioCoreT<BS>::AudioCoreT(unsigned id, Clock& clock)
 :   _id(id),
-    _crossCount(crossCount),
-    _dtmfDetector(clock),
-    _tonePhi(0),
-    _ctcssEncodePhi(0) {
+    _dtmfDetector(clock) {
     // Filter initializations
-    arm_fir_init_f32(&_filtB, FILTER_B_LEN, FILTER_B, _filtBState, BLOCK_SIZE_ADC);
-    // This filter works on 32k audio
-    arm_fir_decimate_init_f32(&_filtC, FILTER_C_LEN, 2, FILTER_C, _filtCState, BLOCK_SIZE_ADC);
-    // This filter works on 16k audio
-    arm_fir_decimate_init_f32(&_filtD, FILTER_C_LEN, 2, FILTER_C, _filtDState, BLOCK_SIZE_ADC / 2);
-    arm_fir_init_f32(&_filtF, FILTER_F_LEN, FILTER_F, _filtFState, BLOCK_SIZE);
+    // This works on 32k audio and produces 8k audio
+    _filtCD.init(FILTER_C, FILTER_C_LEN, _filtCDState, BLOCK_SIZE_ADC);
+    fir_sym_init_f32(&_filtF, FILTER_F_LEN, FILTER_F, _filtFState, BLOCK_SIZE);
+    // The notch (stage 0) is filled in by _applyCtcssDecodeFreq() below
+    BiquadDesign::butterworthHpf(_filtICoeffs + BiquadDesign::COEFFS_PER_STAGE, 
+        (FILTER_I_STAGES - 1) * 2, FILTER_I_HPF_HZ, FS);
+    arm_biquad_cascade_df1_init_f32(&_filtI, FILTER_I_STAGES, _filtICoeffs, _filtIState);
     //arm_fir_init_f32(&_filtN, FILTER_N_LEN, FILTER_N, _filtNState, BLOCK_SIZE_ADC);
-    arm_fir_interpolate_init_f32(&_filtN, 4, FILTER_N_LEN, FILTER_N, _filtNState, BLOCK_SIZE);
+    fir_sym_interpolate_init_f32(&_filtN, 4, FILTER_N_LEN, FILTER_N, _filtNFolded, 
+        _filtNState, BLOCK_SIZE);
     arm_biquad_cascade_df1_init_f32(&_filtJ, 1, FILTER_J, _filtJState);
     for (unsigned i = 0; i < _delayAreaLen; i++)
         _delayArea[i] = 0;
-    for (unsigned i = 0; i < MAX_CROSS_COUNT; i++)
-        _crossGains[i] = 0;
     for (unsigned i = 0; i < SIGNAL_RMS_HISTORY_SIZE; i++)
         _signalRmsHistory[i] = 0;
+    _applyCtcssDecodeFreq(_p.ctcssDecodeFreq);
+    _ctcssEncodeNco.setFreq(_p.ctcssEncodeFreq);
+    _toneNco.setFreq(_p.toneFreq);
+    _injectNco.setFreq(_injectHz);
+}
+
+// ****************************************************************************
+// NOTE: This function is called once per audio block so keep it short!
+// ****************************************************************************
+//
+// Picks up any settings that were published by the main loop since the 
+// last block. Changes that need more than a copy (i.e. that reset some 
+// state) are dealt with here so that they happen between blocks.
+//
+template<unsigned BS>
+void AudioCoreT<BS>::_adoptParams() {
+
+    if (_params.getSeq() == _pSeq)
+        return;
+    Params n;
+    // If the copy was torn (very unlikely) the change will be picked
+    // up on the next block.
+    if (!_params.read(n, &_pSeq))
+        return;
+
+    if (n.ctcssDecodeFreq != _p.ctcssDecodeFreq)
+        _applyCtcssDecodeFreq(n.ctcssDecodeFreq);
+    if (n.ctcssEncodeFreq != _p.ctcssEncodeFreq)
+        _ctcssEncodeNco.setFreq(n.ctcssEncodeFreq);
+    if (n.rxDelayMs != _p.rxDelayMs)
+        _applyRxDelay(n.rxDelayMs);
+    if (n.delayResetCount != _p.delayResetCount)
+        _delayCountdown = _delaySamples;
+    if (n.toneFreq != _p.toneFreq)
+        _toneNco.setFreq(n.toneFreq);
+    if (!std::isnan(n.dtmfDetectLevel) && n.dtmfDetectLevel != _p.dtmfDetectLevel)
+        _dtmfDetector.setSignalThreshold(n.dtmfDetectLevel);
+    // Don't start the newly selected filter with stale history
+    if (n.hpfMode != _p.hpfMode) {
+        memset(_filtFState, 0, sizeof(_filtFState));
+        memset(_filtIState, 0, sizeof(_filtIState));
+    }
+
+    const bool toneChanged = n.toneEnabled != _p.toneEnabled;
+    _p = n;
+    // This uses the new transition time
+    if (toneChanged)
+        _applyToneEnabled(_p.toneEnabled);
+}
+
+template<unsigned BS>
+void AudioCoreT<BS>::_publishMeters() {
+    Meters m;
+    m.noiseRms = _noiseRms;
+    m.signalRms = _signalRms;
+    m.signalPeak = _signalPeak;
+    m.signalRmsAvg = _signalRmsAvg;
+    m.signalPeakAvg = _signalPeakAvg;
+    m.signalRmsAvgMoving = _signalRmsAvgMoving;
+    m.outRms = _outRms;
+    m.outPeak = _outPeak;
+    m.outRmsAvg = _outRmsAvg;
+    m.outPeakAvg = _outPeakAvg;
+    m.ctcssMag = _ctcssDetector.getMag();
+    m.ctcssConfidence = _ctcssDetector.getConfidence();
+    m.ctcssScanTone = _ctcssScanner.getStrongestTone();
+    m.ctcssScanMag = _ctcssScanner.getStrongestMag();
+    m.agcGain = _agcGain;
+    m.dtmfDiag = _dtmfDetector.getDiagValue();
+    _meters.publish(m);
+}
+
+template<unsigned BS>
+typename AudioCoreT<BS>::Meters AudioCoreT<BS>::_readMeters() const {
+    // The audio side publishes at most twice per block so a retry is 
+    // very rare.
+    Meters m;
+    while (!_meters.read(m));
+    return m;
 }
 
 /**
- * Implementation is approximately 1.1ms on an RP2350.
+ * Implementation is approximately 1.1ms on an RP2350. Build with 
+ * AUDIO_PROFILE defined to get the per-stage numbers (prof command).
  */
-void AudioCore::cycleRx(const int32_t* codec_in, float* cross_out) {
+template<unsigned BS>
+void AudioCoreT<BS>::cycleRx(const int32_t* codec_in, float* cross_out) {
+
+    AUDIO_PROFILE_START(_prof);
+
+    // Settings changes only happen between blocks
+    _adoptParams();
+    AUDIO_PROFILE_MARK(_prof, RX_PARAMS);
 
     // Convert fixed-point to floating point
     float adc_in[BLOCK_SIZE_ADC];
@@ -142,51 +218,58 @@ void AudioCore::cycleRx(const int32_t* codec_in, float* cross_out) {
     } else {
         // This is a special feature that allows a signal to be 
         // injected into the input of the core.
-        for (unsigned i = 0; i < BLOCK_SIZE_ADC; i++) {
-            adc_in[i] = _injectLevel * arm_cos_f32(_injectPhi);
-            _injectPhi += _injectOmega;
-        }
-        // We do this to avoid phi growing very large and 
-        // creating overflow/precision problems.
-        _injectPhi = fmod(_injectPhi, 2.0 * PI);
+        _injectNco.generate(adc_in, BLOCK_SIZE_ADC, _injectLevel);
     }
+    AUDIO_PROFILE_MARK(_prof, RX_Q31_IN);
 
-    // Apply HPF to 32kHz samples to isolate noise energy
-    float filtOutB[BLOCK_SIZE_ADC];
-    arm_fir_f32(&_filtB, adc_in, filtOutB, BLOCK_SIZE_ADC);
+    // Decimate from 32K to 8K in two half-band steps (one pass)
+    float filtOutC[BLOCK_SIZE];
+    _filtCD.process(adc_in, filtOutC);
+    AUDIO_PROFILE_MARK(_prof, RX_DECIMATE);
 
-    // Apply the de-emphasis filter. This filter operates at 32kHz
-    float filtOutJ[BLOCK_SIZE_ADC];
-    if (_deemphMode == 1)
-        arm_biquad_cascade_df1_f32(&_filtJ, adc_in, filtOutJ, BLOCK_SIZE_ADC);
-    else 
-        memmove(filtOutJ, adc_in, BLOCK_SIZE_ADC * sizeof(float));
-
-    // Decimate from 32K to 8K in two steps
-    float filtOutC[BLOCK_SIZE_ADC / 2];
-    arm_fir_decimate_f32(&_filtC, filtOutJ, filtOutC, BLOCK_SIZE_ADC);
+    // Apply the de-emphasis filter. This filter operates at 8kHz
     float filtOutD[BLOCK_SIZE];
-    arm_fir_decimate_f32(&_filtD, filtOutC, filtOutD, BLOCK_SIZE_ADC / 2);
+    if (_p.deemphMode == 1)
+        arm_biquad_cascade_df1_f32(&_filtJ, filtOutC, filtOutD, BLOCK_SIZE);
+    else 
+        memmove(filtOutD, filtOutC, BLOCK_SIZE * sizeof(float));
+    AUDIO_PROFILE_MARK(_prof, RX_DEEMPH);
 
     // Apply the CTCSS elimination (HPF) filter
     float filtOutF[BLOCK_SIZE];
-    if (_hpfEnabled)
-        arm_fir_f32(&_filtF, filtOutD, filtOutF, BLOCK_SIZE);
+    if (_p.hpfEnabled && _p.hpfMode == HPF_MODE_IIR)
+        arm_biquad_cascade_df1_f32(&_filtI, filtOutD, filtOutF, BLOCK_SIZE);
+    else if (_p.hpfEnabled)
+        fir_sym_f32(&_filtF, filtOutD, filtOutF, BLOCK_SIZE);
     else 
         for (unsigned i = 0; i < BLOCK_SIZE; i++)
             filtOutF[i] = filtOutD[i];
-
-    // Do tone decode processing on the final 8K audio
-    for (unsigned int i = 0; i < BLOCK_SIZE; i++) {
-        float s = filtOutD[i];
-        // CTCSS decode
-        float z0 = s + _gc * _gz1 - _gz2;
-        _gz2 = _gz1;
-        _gz1 = z0;
+    AUDIO_PROFILE_MARK(_prof, RX_HPF);
+
+    // Look for all of the standard tones. This also produces the 
+    // sub-audible (1k) audio that the CTCSS decoder works on.
+    _ctcssScanner.process(filtOutD, BLOCK_SIZE);
+    AUDIO_PROFILE_MARK(_prof, RX_TONE_SCAN);
+
+    // CTCSS decode. This is a sliding window so there is a new 
+    // reading every block.
+    _ctcssDetector.process(_ctcssScanner.getLowRate(), 
+        _ctcssScanner.getLowRateCount());
+    AUDIO_PROFILE_MARK(_prof, RX_CTCSS_DECODE);
+
+    // Show the block to the DTMF decoder for analysis. The detector is 
+    // only called once a full 64 sample block has been accumulated. 
+    // Detections are passed to the main loop through a queue.
+    memcpy(_dtmfBlock + _dtmfBlockLen, filtOutD, BLOCK_SIZE * sizeof(float));
+    _dtmfBlockLen += BLOCK_SIZE;
+    if (_dtmfBlockLen == DTMF_BLOCK_SIZE) {
+        _dtmfDetector.processBlock(_dtmfBlock);
+        char d;
+        while ((d = _dtmfDetector.popDetection()) != 0)
+            _dtmfDetections.push(d);
+        _dtmfBlockLen = 0;
     }
-
-    // Show the block to the DTMF decoder for analysis
-    _dtmfDetector.processBlock(filtOutD);
+    AUDIO_PROFILE_MARK(_prof, RX_DTMF);
 
     // Apply the delay to the final audio. 
     for (unsigned int i = 0; i < BLOCK_SIZE; i++) {
@@ -201,28 +284,21 @@ void AudioCore::cycleRx(const int32_t* codec_in, float* cross_out) {
             cross_out[i] = 0;
             _delayCountdown--;
         } else { 
-            cross_out[i] = _rxMute ? 0 : 
-                _delayArea[_delayAreaReadPtr] * _rxGain;
+            cross_out[i] = _p.rxMute ? 0 : 
+                _delayArea[_delayAreaReadPtr] * _p.rxGain;
         }
         _delayAreaReadPtr = incAndWrap(_delayAreaReadPtr, _delayAreaLen);
     }
+    AUDIO_PROFILE_MARK(_prof, RX_DELAY);
 
-    // Look to see if we can update the CTCSS estimation
-    if (++_ctcssBlock == _ctcssBlocks) {
-        float gi = _gcw * _gz1 - _gz2;
-        float gq = _gsw * _gz1;
-        float ms = gi * gi + gq * gq;
-        arm_sqrt_f32(ms, &_ctcssMag);
-        // Scale down by half of the sample count
-        _ctcssMag /= (float)(_ctcssBlocks * BLOCK_SIZE / 2.0);
-        // Reset for the next block
-        _gz1 = 0;
-        _gz2 = 0;
-        _ctcssBlock = 0;
-    }
-
-    // Compute noise RMS
-    arm_rms_f32(filtOutB, BLOCK_SIZE_ADC, &_noiseRms);
+    // Compute noise RMS. This uses the energy that was removed by the 
+    // half-band decimation filters (roughly 4k-16k) rather than a 
+    // separate HPF on the 32k audio. The calibration factor lines the 
+    // result up with the 41-tap [6000/32000, 0.5] HPF that was used 
+    // previously (exact for white noise, within 0.6 dB for the rising 
+    // noise spectrum of an FM discriminator).
+    arm_sqrt_f32(_filtCD.getHighBandPower() * NOISE_POWER_CAL, &_noiseRms);
+    AUDIO_PROFILE_MARK(_prof, RX_NOISE);
 
     // Compute the signal RMS/peak
     arm_rms_f32(filtOutD, BLOCK_SIZE, &_signalRms);
@@ -250,8 +326,8 @@ void AudioCore::cycleRx(const int32_t* codec_in, float* cross_out) {
     // AGC control loop
     float agcGainNeeded = 1.0;
     // TODO: SETUP A MINIMUM RMS
-    if (_agcEnabled && _signalRmsAvgMoving > 0.001) {
-        agcGainNeeded = _agcTargetRms / _signalRmsAvgMoving;
+    if (_p.agcEnabled && _signalRmsAvgMoving > 0.001) {
+        agcGainNeeded = _p.agcTargetRms / _signalRmsAvgMoving;
         // Keep inside of the range
         if (agcGainNeeded > _agcMaxGain) {
             agcGainNeeded = _agcMaxGain;
@@ -265,12 +341,18 @@ void AudioCore::cycleRx(const int32_t* codec_in, float* cross_out) {
         _agcGain += (agcGainNeeded - _agcGain) * _agcAttackCoeff;
     else 
         _agcGain += (agcGainNeeded - _agcGain) * _agcDecayCoeff;
+
+    _publishMeters();
+    AUDIO_PROFILE_MARK(_prof, RX_METERS);
 }
 
 /**
  * Implementation is approximately 980uS on an RP2350
  */
-void AudioCore::cycleTx(const float** cross_ins, int32_t* codec_out) {
+template<unsigned BS>
+void AudioCoreT<BS>::cycleTx(const float* bus_in, int32_t* codec_out) {
+
+    AUDIO_PROFILE_START(_prof);
 
     float final_out[BLOCK_SIZE_ADC];
 
@@ -282,27 +364,22 @@ void AudioCore::cycleTx(const float** cross_ins, int32_t* codec_out) {
     // generate the CTCSS tone are performed regardless 
     // of whether the encoding is enabled.  This is to 
     // maintain a consistent CPU cost.
-    float ctcssLevel = _ctcssEncodeEnabled ? _ctcssEncodeLevel : 0;
-    for (unsigned i = 0; 
-        i < BLOCK_SIZE; 
-        i++, _ctcssEncodePhi += _ctcssEncodeOmega)
-        mix[i] = ctcssLevel * arm_cos_f32(_ctcssEncodePhi);
+    float ctcssLevel = _p.ctcssEncodeEnabled ? _p.ctcssEncodeLevel : 0;
+    _ctcssEncodeNco.generate(mix, BLOCK_SIZE, ctcssLevel);
+    AUDIO_PROFILE_MARK(_prof, TX_CTCSS);
 
-    // We do this to avoid phi growing very large and 
-    // creating overflow/precision problems.
-    _ctcssEncodePhi = fmod(_ctcssEncodePhi, 2.0 * PI);
+    // Tone generation [see flow diagram reference K] 
+    // Notice that all of the calculations needed to 
+    // generate the tone(s) are performed regardless 
+    // of whether the tone is enabled.  This is to 
+    // maintain a consistent CPU cost. The level is 
+    // applied below.
+    float tone[BLOCK_SIZE];
+    _toneNco.generate(tone, BLOCK_SIZE, 1.0);
 
     // Tone and audio mixing
-    for (unsigned i = 0; 
-        i < BLOCK_SIZE; 
-        i++, _tonePhi += _toneOmega) {
-
-        // Tone generation [see flow diagram reference K] 
-        // Notice that all of the calculations needed to 
-        // generate the tone(s) are performed regardless 
-        // of whether the tone is enabled.  This is to 
-        // maintain a consistent CPU cost.
-        // 
+    for (unsigned i = 0; i < BLOCK_SIZE; i++) {
+
         // Tone level changes during transition windows
         if (_toneTransitionIncrement > 0) {
             if (_toneTransitionLevel < _toneTransitionLimit) {
@@ -321,10 +398,10 @@ void AudioCore::cycleTx(const float** cross_ins, int32_t* codec_out) {
 
         // At the moment the transition is linear (i.e. trapazoidal
         // shaping).  We may consider a more complex envelope later.
-        float toneLevel = _toneLevel * _toneTransitionLevel;
+        float toneLevel = _p.toneLevel * _toneTransitionLevel;
 
         float toneAndAudio = mix[i];
-        toneAndAudio += toneLevel * arm_cos_f32(_tonePhi);
+        toneAndAudio += toneLevel * tone[i];
 
         // Transmit Mix [float diagram reference L]
         //
@@ -333,21 +410,18 @@ void AudioCore::cycleTx(const float** cross_ins, int32_t* codec_out) {
         float audioLevel = 1.0 - toneLevel - ctcssLevel;
         //float audioLevel = 0.0;
 
-        for (unsigned k = 0; k < _crossCount; k++)
-            toneAndAudio += audioLevel * cross_ins[k][i] * _crossGains[k];
+        toneAndAudio += audioLevel * bus_in[i];
 
         // IMPORTANT: The 8k->32k interpolation will reduce the magnitude
         // of the signal by 1/4, this x4.0 compensates.
         mix[i] = toneAndAudio * 4.0;
     }
-
-    // We do this to avoid phi growing very large and 
-    // creating overflow/precision problems.
-    _tonePhi = fmod(_tonePhi, 2.0 * PI);
+    AUDIO_PROFILE_MARK(_prof, TX_TONE_MIX);
 
     // Interpolation x4 [flow diagram reference N]   
     // WARNING: CHECK FOR *4 SITUATION
-    arm_fir_interpolate_f32(&_filtN, mix, final_out, BLOCK_SIZE);
+    fir_sym_interpolate_f32(&_filtN, mix, final_out, BLOCK_SIZE);
+    AUDIO_PROFILE_MARK(_prof, TX_INTERPOLATE);
 
     // Compute output RMS
     arm_rms_f32(final_out, BLOCK_SIZE_ADC, &_outRms);
@@ -364,41 +438,32 @@ void AudioCore::cycleTx(const float** cross_ins, int32_t* codec_out) {
         _outPeakAvgAttackCoeff : _outPeakAvgDecayCoeff;
     _outPeakAvg += c * (_outPeak - _outPeakAvg);
 
+    _publishMeters();
+    AUDIO_PROFILE_MARK(_prof, TX_METERS);
+
     // Convert back to fixed point
     arm_float_to_q31(final_out, codec_out, BLOCK_SIZE_ADC);
+    AUDIO_PROFILE_MARK(_prof, TX_Q31_OUT);
+    AUDIO_PROFILE_END_BLOCK(_prof);
 }
 
-void AudioCore::setCtcssDecodeFreq(float hz) {
-    _ctcssDecodeFreq = hz;
-    _ctcssBlocks = 8;
-    _ctcssBlock = 0;
-    float gw =  2.0 * PI * hz / (float)FS;
-    _gcw = arm_cos_f32(gw);
-    _gsw = arm_sin_f32(gw);
-    _gc = 2.0 * _gcw;
-    _gz1 = 0;
-    _gz2 = 0;
+template<unsigned BS>
+void AudioCoreT<BS>::_applyCtcssDecodeFreq(float hz) {
+    _ctcssDetector.setFreq(hz, _ctcssScanner.getLowRateGain(hz));
+    // The filter history is kept, the notch just moves
+    BiquadDesign::notch(_filtICoeffs, hz, FS, FILTER_I_NOTCH_Q);
 }
 
-float AudioCore::getCtcssDecodeRms() const { 
+template<unsigned BS>
+float AudioCoreT<BS>::getCtcssDecodeRms() const { 
     // Since the DFT is computing the peak amplitude and the 
     // CTCSS is assumed to be sinusoidal, we convert peak
     // to RMS here.
-    return _ctcssMag * 0.707; 
-}
-
-void AudioCore::setCtcssEncodeEnabled(bool b) {
-    _ctcssEncodeEnabled = b;
+    return _readMeters().ctcssMag * 0.707; 
 }
 
-void AudioCore::setCtcssEncodeFreq(float hz) {
-    _ctcssEncodeFreq = hz;
-    // Convert frequency to radians/sample.  The CTCSS
-    // generation happens at the FS (8k) rate.
-    _ctcssEncodeOmega = 2.0 * PI * hz / (float)FS;
-}
-
-void AudioCore::setRxDelayMs(unsigned ms) {
+template<unsigned BS>
+void AudioCoreT<BS>::_applyRxDelay(unsigned ms) {
 
     _delaySamples = FS * ms / 1000;
 
@@ -413,10 +478,11 @@ void AudioCore::setRxDelayMs(unsigned ms) {
     }
 }
 
-void AudioCore::setToneEnabled(bool b) {
-    
+template<unsigned BS>
+void AudioCoreT<BS>::_applyToneEnabled(bool b) {
+
     // This is the number of samples in the transition
-    unsigned transitionCycles = FS * _toneTransitionMs / 1000;
+    unsigned transitionCycles = FS * _p.toneTransitionMs / 1000;
     // Since we only adjust the gain once/block, the number of
     // cycles is smaller.
     //transitionCycles /= BLOCK_SIZE;
@@ -432,26 +498,22 @@ void AudioCore::setToneEnabled(bool b) {
     }
 }
 
-void AudioCore::setToneFreq(float hz) {
-    // Convert frequency to radians/sample.  The tone generation 
-    // happens at the FS (8k) rate.
-    _toneOmega = 2.0 * PI * hz / (float)FS;
-}
-
-void AudioCore::setCrossGainLinear(unsigned i, float gain) {
-    assert(i < MAX_CROSS_COUNT);
-    _crossGains[i] = gain;
+template<unsigned BS>
+char AudioCoreT<BS>::getLastDtmfDetection() {
+    char d;
+    if (!_dtmfDetections.pop(d))
+        return 0;
+    return d;
 }
 
-char AudioCore::getLastDtmfDetection() {
-#ifdef PICO_BUILD
-    uint32_t i = save_and_disable_interrupts();
-#endif
-    char d = _dtmfDetector.popDetection();
+// The firmware only needs the configured block size. The host build 
+// creates all of them so they can be compared.
 #ifdef PICO_BUILD
-    restore_interrupts(i);
+template class AudioCoreT<AUDIO_BLOCK_SIZE_ADC>;
+#else
+template class AudioCoreT<64>;
+template class AudioCoreT<128>;
+template class AudioCoreT<256>;
 #endif
-    return d;
-}
 
 }
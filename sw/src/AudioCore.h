@@ -26,23 +26,53 @@
 
 #include "kc1fsz-tools/DTMFDetector2.h"
 
+#include "AudioBlockSize.h"
+#include "AudioProfiler.h"
+#include "BiquadDesign.h"
+#include "CtcssDetector.h"
+#include "CtcssScanner.h"
+#include "HalfBandDecimator.h"
+#include "Nco.h"
+#include "Snapshot.h"
+#include "SymmetricFir.h"
+#include "SpscRing.h"
+
 namespace kc1fsz {
 
 class Clock;
 
 /**
  * @brief Audio processing core.
+ *
+ * The block size is a template parameter so that the latency can be 
+ * traded against the per-block overhead. Normally this is used through 
+ * the AudioCore typedef below, which picks up the size that the 
+ * firmware was built with.
+ *
+ * Threading: cycleRx()/cycleTx() run in the audio context and everything
+ * else is called from the main loop. The setters change a copy of the 
+ * settings that is published as a Snapshot and picked up by the audio 
+ * side at the start of the next block, so a block never sees a half-made
+ * change. Meter readings come back the same way and DTMF detections come
+ * back through an SpscRing. Nothing needs to disable interrupts.
+ *
+ * @tparam BS Number of 32k CODEC samples per block (64, 128 or 256).
  */
-class AudioCore {
+template<unsigned BS> class AudioCoreT {
 public:
 
+    static_assert(BS == 64 || BS == 128 || BS == 256, "Unsupported block size");
+
     static const unsigned FS_ADC = 32000;
-    static const unsigned BLOCK_SIZE_ADC = 256;
+    static const unsigned BLOCK_SIZE_ADC = BS;
     static const unsigned FS = FS_ADC / 4;
     static const unsigned BLOCK_SIZE = BLOCK_SIZE_ADC / 4;
-    static const unsigned MAX_CROSS_COUNT = 8;
 
-    AudioCore(unsigned id, unsigned crossCount, Clock& clock);
+    // CTCSS elimination filter implementations (see setHpfMode())
+    static const uint32_t HPF_MODE_FIR = 0;
+    static const uint32_t HPF_MODE_IIR = 1;
+
+    AudioCoreT(unsigned id, Clock& clock);
 
     /**
      * @brief Called once per CODEC block. Expected to run quickly 
@@ -58,25 +88,26 @@ public:
      * @brief Called once per CODEC block. Expected to run quickly 
      * inside of the interrupt service routine.
      *
+     * @param bus_in One block of 8k audio from the MixBus that should be 
+     * transmitted.
      * @param dac_out A block of 32-bit signed PCM samples will be written here
      */
-    void cycleTx(const float** cross_ins, int32_t* codec_out);
+    void cycleTx(const float* bus_in, int32_t* codec_out);
 
+#ifdef AUDIO_PROFILE
     /**
-     * Controls how much of each cross input gets included in the output
-     * during calls to cycleTx.
-     * 
-     * @param i The contributor index, corresponds to the cross_ins array
-     * index in the cycleTx() function.
-     * @param gain 0->1 linear scale.
+     * @brief Per-stage timing of cycleRx()/cycleTx(). Only present in 
+     * builds with AUDIO_PROFILE defined.
      */
-    void setCrossGainLinear(unsigned i, float gain);
+    AudioProfiler& getProfiler() { return _prof; }
+    const AudioProfiler& getProfiler() const { return _prof; }
+#endif
 
     /**
      * The "noise" is basically all power above ~5kHz.
      * @returns Signal voltage in Vrms, assuming full-scale is 1.0. Note
      */
-    float getNoiseRms() const { return _noiseRms; }
+    float getNoiseRms() const { return _readMeters().noiseRms; }
 
     /**
      * The "signal" is basically all power below 4kHz, includes the sub-audible 
@@ -84,20 +115,20 @@ public:
      *
      * @returns Signal voltage in Vrms, assuming full-scale is 1.0. Note
      */
-    float getSignalRms() const { return _signalRms; }
-    float getSignalPeak() const { return _signalPeak; }    
+    float getSignalRms() const { return _readMeters().signalRms; }
+    float getSignalPeak() const { return _readMeters().signalPeak; }    
 
     /**
      * A version of the signal RMS smoothed over some period (around 64ms)
      */
-    float getSignalRmsAvgMoving() const { return _signalRmsAvgMoving; }
+    float getSignalRmsAvgMoving() const { return _readMeters().signalRmsAvgMoving; }
 
     /**
      * These versions of the RMS/peak functions include smoothing that is 
      * compatible with VU meter ballistics.
      */
-    float getSignalRms2() const { return _signalRmsAvg; }
-    float getSignalPeak2() const { return _signalPeakAvg; }
+    float getSignalRms2() const { return _readMeters().signalRmsAvg; }
+    float getSignalPeak2() const { return _readMeters().signalPeakAvg; }
 
     /**
      * Voltage of all audio being routed to the transmitter, inclusive of 
@@ -105,70 +136,115 @@ public:
      *
      * @returns Signal voltage in Vrms, assuming full-scale is 1.0. Note
      */
-    float getOutRms() const { return _outRms; }    
-    float getOutPeak() const { return _outPeak; }    
+    float getOutRms() const { return _readMeters().outRms; }    
+    float getOutPeak() const { return _readMeters().outPeak; }    
 
     /**
      * These versions of the RMS/peak functions include smoothing that is 
      * compatible with VU meter ballistics.
      */
-    float getOutRms2() const { return _outRmsAvg; }
-    float getOutPeak2() const { return _outPeakAvg; }
+    float getOutRms2() const { return _readMeters().outRmsAvg; }
+    float getOutPeak2() const { return _readMeters().outPeakAvg; }
 
-    void setRxMute(bool mute) { _rxMute = mute; }
+    void setRxMute(bool mute) { _next.rxMute = mute; _publish(); }
 
     /**
      * @brief The received audio is multiplied by this value.
      */
-    void setRxGainLinear(float gain) { _rxGain = gain; }
+    void setRxGainLinear(float gain) { _next.rxGain = gain; _publish(); }
 
     /**
      * @brief Controls the HPF that is intended to filter out the low
      * end of the received audio, generally PL tone elimination.
      */
-    void setHPFEnabled(bool b) { _hpfEnabled = b; }
+    void setHPFEnabled(bool b) { _next.hpfEnabled = b; _publish(); }
+
+    /**
+     * @brief Selects how the CTCSS elimination is done.
+     *
+     * HPF_MODE_FIR is the 127-tap linear-phase HPF (stop band below 
+     * 100 Hz, pass band above 225 Hz) whatever the tone is. It adds 
+     * ~7.9ms of delay.
+     *
+     * HPF_MODE_IIR is a notch at the decode frequency (set by 
+     * setCtcssDecodeFreq()) plus a 4th order Butterworth HPF at 200 Hz.
+     * It is about an eighth of the work and adds almost no delay, but
+     * isn't linear-phase and only deals with the one tone.
+     */
+    void setHpfMode(uint32_t m) { _next.hpfMode = m; _publish(); }
 
-    void setCtcssDecodeFreq(float hz);
+    void setCtcssDecodeFreq(float hz) { _next.ctcssDecodeFreq = hz; _publish(); }
 
     /**
-     * Voltage detected at the frequency set by setCtcssDecodeFreq().
+     * Voltage detected at the frequency set by setCtcssDecodeFreq()
+     * over the last 64ms. This is updated every block.
      *
      * @returns Signal voltage in Vrms, assuming full-scale is 1.0. Note
      */
     float getCtcssDecodeRms() const;
 
-    void setCtcssEncodeEnabled(bool b);
+    /**
+     * How sure the decoder is that the tone is really there (as opposed
+     * to a neighbouring tone, or noise). See CtcssDetector.
+     *
+     * @returns 0.0 -> 1.0
+     */
+    float getCtcssDecodeConfidence() const { return _readMeters().ctcssConfidence; }
+
+    /**
+     * The scanner measures all of the standard CTCSS tones at once. 
+     * 
+     * @returns The index (into CtcssScanner::TONES) of the strongest 
+     * tone in the last scan window, or -1 if there was nothing at all.
+     */
+    int getCtcssScanTone() const { return _readMeters().ctcssScanTone; }
+
+    /**
+     * Voltage of the tone reported by getCtcssScanTone().
+     *
+     * @returns Signal voltage in Vrms, assuming full-scale is 1.0.
+     */
+    float getCtcssScanRms() const { return _readMeters().ctcssScanMag * 0.707; }
+
+    void setCtcssEncodeEnabled(bool b) { _next.ctcssEncodeEnabled = b; _publish(); }
 
-    void setCtcssEncodeFreq(float hz);
+    void setCtcssEncodeFreq(float hz) { _next.ctcssEncodeFreq = hz; _publish(); }
 
-    void setCtcssEncodeLevel(float dbv) { _ctcssEncodeLevel = dbvToPeak(dbv); }
+    void setCtcssEncodeLevel(float dbv) { 
+        _next.ctcssEncodeLevel = dbvToPeak(dbv); 
+        _publish(); 
+    }
 
-    void setRxDelayMs(unsigned ms);
+    void setRxDelayMs(unsigned ms) { _next.rxDelayMs = ms; _publish(); }
 
-    void resetDelay() { _delayCountdown = _delaySamples; }
+    /**
+     * @brief Restarts the receive delay (i.e. silence until the delay
+     * area has been re-filled).
+     */
+    void resetDelay() { _next.delayResetCount++; _publish(); }
 
     // TODO: SOFT GAINS ON RX AND TX
     
-    void setToneEnabled(bool b);
-    void setToneFreq(float hz);
-    void setToneLevel(float dbv) { _toneLevel = dbvToPeak(dbv); }
+    void setToneEnabled(bool b) { _next.toneEnabled = b; _publish(); }
+    void setToneFreq(float hz) { _next.toneFreq = hz; _publish(); }
+    void setToneLevel(float dbv) { _next.toneLevel = dbvToPeak(dbv); _publish(); }
 
-    void setToneTransitionTime(unsigned ms) { _toneTransitionMs = ms; }
+    void setToneTransitionTime(unsigned ms) { _next.toneTransitionMs = ms; _publish(); }
 
-    void setAgcEnabled(bool e) { _agcEnabled = e; }
+    void setAgcEnabled(bool e) { _next.agcEnabled = e; _publish(); }
 
     /**
      * @brief Sets AGC target level in dBFS
      */
-    void setAgcTargetDbv(float dbv) { _agcTargetRms = dbvToVrms(dbv); }
+    void setAgcTargetDbv(float dbv) { _next.agcTargetRms = dbvToVrms(dbv); _publish(); }
     
-    float getAgcGain () const { return _agcGain; }
+    float getAgcGain () const { return _readMeters().agcGain; }
 
-    void setDtmfDetectLevel(float dbfs) { _dtmfDetector.setSignalThreshold(dbfs); }
+    void setDtmfDetectLevel(float dbfs) { _next.dtmfDetectLevel = dbfs; _publish(); }
     
-    float getDtmfDetectDiagValue() { return _dtmfDetector.getDiagValue(); }
+    float getDtmfDetectDiagValue() const { return _readMeters().dtmfDiag; }
 
-    void setDeemphMode(uint32_t m) { _deemphMode = m; }
+    void setDeemphMode(uint32_t m) { _next.deemphMode = m; _publish(); }
 
     /**
       * @returns The last detected DTMF symbol, or zero if none since
@@ -217,42 +293,128 @@ public:
     
 private:
 
+    /**
+     * Everything that the main loop can change. The audio side works 
+     * from its own copy which is only updated at the start of a block.
+     */
+    struct Params {
+        bool rxMute = false;
+        // A soft gain that is applied to received audio just before it
+        // it passed into the crossing network.
+        float rxGain = 1.0;
+        bool hpfEnabled = true;
+        uint32_t hpfMode = HPF_MODE_FIR;
+        float ctcssDecodeFreq = 123;
+        bool ctcssEncodeEnabled = false;
+        float ctcssEncodeFreq = 123;
+        float ctcssEncodeLevel = 0;
+        unsigned rxDelayMs = 0;
+        // Bumped each time the delay should be restarted
+        uint32_t delayResetCount = 0;
+        bool toneEnabled = false;
+        float toneFreq = 0;
+        // This is a fixed level that can be used to set the overall
+        // (i.e. after transition) level of the tone
+        float toneLevel = dbvToPeak(-10);
+        // Controls how long the tone on/off transition should last.
+        unsigned toneTransitionMs = 20;
+        bool agcEnabled = true;
+        float agcTargetRms = dbvToVrms(-10);
+        // NAN leaves the detector at its default
+        float dtmfDetectLevel = NAN;
+        // Deemphasis/Preemphasis related
+        uint32_t deemphMode = 0;
+    };
+
+    /**
+     * Readings that go back to the main loop.
+     */
+    struct Meters {
+        float noiseRms = 0;
+        float signalRms = 0;
+        float signalPeak = 0;
+        float signalRmsAvg = 0;
+        float signalPeakAvg = 0;
+        float signalRmsAvgMoving = 0;
+        float outRms = 0;
+        float outPeak = 0;
+        float outRmsAvg = 0;
+        float outPeakAvg = 0;
+        float ctcssMag = 0;
+        float ctcssConfidence = 0;
+        int ctcssScanTone = -1;
+        float ctcssScanMag = 0;
+        float agcGain = 1.0;
+        float dtmfDiag = 0;
+    };
+
+    // Main loop side
+    void _publish() { _params.publish(_next); }
+    Meters _readMeters() const;
+
+    // Audio side
+    void _adoptParams();
+    void _publishMeters();
+    void _applyCtcssDecodeFreq(float hz);
+    void _applyRxDelay(unsigned ms);
+    void _applyToneEnabled(bool b);
+
+    /**
+     * The various smoothing coefficients were originally tuned for 8ms 
+     * blocks. This adjusts a coefficient so that the time constant stays
+     * the same at the current block rate.
+     */
+    static float blockCoeff(float c8ms) {
+        return 1.0 - pow(1.0 - c8ms, (float)BLOCK_SIZE_ADC / 256.0);
+    }
+
     const unsigned _id;
-    const unsigned _crossCount;
 
-    float _crossGains[MAX_CROSS_COUNT];
+    // The settings being built up by the main loop. This is value-
+    // initialized so that the padding is zero (see Snapshot::publish()).
+    Params _next = Params();
+    Snapshot<Params> _params;
+    // The settings in use by the audio side and the version number
+    Params _p;
+    uint32_t _pSeq = 0;
+
+    Snapshot<Meters> _meters;
 
-    // Noise HPF, runs at 32k
-    static const unsigned FILTER_B_LEN = 41;
-    static const float32_t FILTER_B[FILTER_B_LEN];
-    arm_fir_instance_f32 _filtB;
-    float32_t _filtBState[FILTER_B_LEN + BLOCK_SIZE_ADC - 1];
-  
-    // Decimation LPFs (two half-band filters)
+    // Decimation LPFs (two half-band filters, 32k->16k->8k in one pass)
     static const unsigned FILTER_C_LEN = 41;
-    static const float32_t FILTER_C[FILTER_C_LEN];
-    // For the 16k filter, but still runs on 32k audio
-    arm_fir_decimate_instance_f32 _filtC;
-    float32_t _filtCState[FILTER_C_LEN + BLOCK_SIZE_ADC - 1];
-    // For the 8k filter, but still runs on 16k audio
-    arm_fir_decimate_instance_f32 _filtD;
-    float32_t _filtDState[FILTER_C_LEN + (BLOCK_SIZE_ADC / 2) - 1];
-
-    // Band pass filter (CTCSS removal), runs at 8k
+    // The high-band output of the decimator is also used for the noise 
+    // measurement.
+    HalfBandDecimator _filtCD;
+    float32_t _filtCDState[HalfBandDecimator::stateSize(FILTER_C_LEN, BLOCK_SIZE_ADC)];
+    // Scales the decimator high-band power to match the original noise HPF
+    static constexpr float NOISE_POWER_CAL = 0.857;
+
+    // Band pass filter (CTCSS removal), runs at 8k. This is linear-phase
+    // so the folded (symmetric) FIR is used.
     static const unsigned FILTER_F_LEN = 127;
-    static const float32_t FILTER_F[FILTER_F_LEN];
-    arm_fir_instance_f32 _filtF;
+    fir_sym_instance_f32 _filtF;
     float32_t _filtFState[FILTER_F_LEN + BLOCK_SIZE - 1];
 
+    // The low-cost alternative to FILTER_F, runs at 8k. The first stage
+    // is the notch, which is re-designed when the decode frequency 
+    // changes, and the rest are the fixed HPF.
+    static const unsigned FILTER_I_STAGES = 3;
+    static constexpr float FILTER_I_HPF_HZ = 200;
+    static constexpr float FILTER_I_NOTCH_Q = 10;
+    arm_biquad_casd_df1_inst_f32 _filtI;
+    float32_t _filtICoeffs[FILTER_I_STAGES * BiquadDesign::COEFFS_PER_STAGE];
+    float32_t _filtIState[FILTER_I_STAGES * 4];
+
     // Low-pass filter for interpolation 8K->32K, runs at 32k
-    // Needs to be multiple of 4 for interpolation 
+    // Needs to be multiple of 4 for interpolation. Also linear-phase, so
+    // this uses the folded interpolator.
     static const unsigned FILTER_N_LEN = 124;
-    static const float32_t FILTER_N[FILTER_N_LEN];
-    arm_fir_interpolate_instance_f32 _filtN;
+    fir_sym_interpolate_instance_f32 _filtN;
+    float32_t _filtNFolded[fir_sym_interpolate_folded_size(FILTER_N_LEN)];
     float32_t _filtNState[(FILTER_N_LEN / 4) + BLOCK_SIZE_ADC - 1];
 
     // The low-pass IIR filter used for de-emphasis. This is using one 
-    // biquad stage. Runs at 32kHz.
+    // biquad stage. Runs at 8kHz after the decimation.
     // 
     // Per CMSIS documentation:
     //
@@ -270,7 +432,6 @@ private:
     // the coefficients for the second stage, and so on. The pCoeffs array contains a 
     // total of 5*numStages values.
 
-    static const float32_t FILTER_J[5];
     arm_biquad_casd_df1_inst_f32 _filtJ;
     float32_t _filtJState[4];
 
@@ -281,60 +442,44 @@ private:
     float _outRms;
     float _outPeak;
 
-    float _signalRmsAvgAttackCoeff = 0.12;
-    float _signalRmsAvgDecayCoeff = 0.12;
+    float _signalRmsAvgAttackCoeff = blockCoeff(0.12);
+    float _signalRmsAvgDecayCoeff = blockCoeff(0.12);
     float _signalRmsAvg = 0;    
 
-    float _signalPeakAvgAttackCoeff = 0.50;
-    float _signalPeakAvgDecayCoeff = 0.12;
+    float _signalPeakAvgAttackCoeff = blockCoeff(0.50);
+    float _signalPeakAvgDecayCoeff = blockCoeff(0.12);
     float _signalPeakAvg = 0;
 
-    float _outRmsAvgAttackCoeff = 0.12;
-    float _outRmsAvgDecayCoeff = 0.12;
+    float _outRmsAvgAttackCoeff = blockCoeff(0.12);
+    float _outRmsAvgDecayCoeff = blockCoeff(0.12);
     float _outRmsAvg = 0;    
 
-    float _outPeakAvgAttackCoeff = 0.50;
-    float _outPeakAvgDecayCoeff = 0.12;
+    float _outPeakAvgAttackCoeff = blockCoeff(0.50);
+    float _outPeakAvgDecayCoeff = blockCoeff(0.12);
     float _outPeakAvg = 0;
 
-    // Signal RMS history used for maintaining an RMS average.
-    static const unsigned SIGNAL_RMS_HISTORY_SIZE = 8;
+    // Signal RMS history used for maintaining an RMS average (64ms).
+    static const unsigned SIGNAL_RMS_HISTORY_SIZE = (FS * 64 / 1000) / BLOCK_SIZE;
     unsigned _signalRmsHistoryPtr = 0;
     float _signalRmsHistory[SIGNAL_RMS_HISTORY_SIZE];
     float _signalRmsAvgMoving = 0;
 
-    bool _rxMute = false;
-
-    // A soft gain that is applied to received audio just before it
-    // it passed into the crossing network.
-    float _rxGain = 1.0;
-
     // AGC related
-    bool _agcEnabled = true;
-    float _agcTargetRms = dbvToVrms(-10);
     float _agcGain = 1.0;    
     float _agcMaxGain = pow(10.0, (10.0 / 20.0));
     float _agcMinGain = pow(10.0, (-10.0 / 20.0));
     // These parameters control how quickly the AGC gain comes up or down.
-    float _agcAttackCoeff = 0.05;
-    float _agcDecayCoeff = 0.05;
-
-    bool _hpfEnabled = true;
+    float _agcAttackCoeff = blockCoeff(0.05);
+    float _agcDecayCoeff = blockCoeff(0.05);
 
     // Used for CTCSS encoding
-    bool _ctcssEncodeEnabled = false;
-    float _ctcssEncodeFreq = 123;
-    float _ctcssEncodeOmega = 0;
-    float _ctcssEncodePhi = 0;
-    float _ctcssEncodeLevel = 0;
+    Nco _ctcssEncodeNco { FS };
 
+    // Used to identify the tone (any of the standard ones). This also
+    // provides the sub-audible audio for the CTCSS decoder.
+    CtcssScanner _ctcssScanner;
     // Used for CTCSS decoding
-    float _ctcssDecodeFreq = 123;
-    float _gz1 = 0, _gz2 = 0;
-    float _gcw, _gsw, _gc;
-    float _ctcssMag = 0;
-    unsigned _ctcssBlock = 0;
-    unsigned _ctcssBlocks = 0;
+    CtcssDetector _ctcssDetector;
 
     // Audio delay (250ms)
     static const unsigned _delayAreaLen = 2000;
@@ -345,11 +490,7 @@ private:
     unsigned _delayCountdown = 0;
 
     // Used for synthesis of tone 
-    // This is a fixed level that can be used to set the overall
-    // (i.e. after transition) level of the tone
-    float _toneLevel =  dbvToPeak(-10);
-    float _toneOmega = 0;
-    float _tonePhi = 0;
+    Nco _toneNco { FS };
     // Tones turn on/off transitions are smoothed to minimize clicks.
     // This contains the current level (i.e. a value from 0.0->1.0)
     float _toneTransitionLevel = 0;
@@ -358,21 +499,31 @@ private:
     // This controls the final target value, generally 0.0 or 1.0 depending
     // on whether we are fading in or fading out.
     float _toneTransitionLimit = 0;
-    // Controls how long the transition should last.
-    unsigned _toneTransitionMs = 20;
-
-    // Deemphasis/Preemphasis related
-    uint32_t _deemphMode = 0;
 
     // Input injection feature for testing
     bool _injectEnabled = false;
     float _injectHz = 800;
     float _injectLevel =  dbvToPeak(-10);
     // Injection runs at CODEC speed
-    float _injectOmega = 2.0 * PI * _injectHz / (float)FS_ADC;
-    float _injectPhi = 0;
+    Nco _injectNco { FS_ADC };
 
     DTMFDetector2 _dtmfDetector;
+    // The DTMF detector always works on 64 sample (8k) blocks so the
+    // audio is accumulated here when running with smaller blocks.
+    static const unsigned DTMF_BLOCK_SIZE = 64;
+    float _dtmfBlock[DTMF_BLOCK_SIZE];
+    unsigned _dtmfBlockLen = 0;
+    // Detections on their way to the main loop
+    SpscRing<char, 8> _dtmfDetections;
+
+#ifdef AUDIO_PROFILE
+    AudioProfiler _prof;
+#endif
 };
 
+/**
+ * The audio core for the block size that the firmware was built with.
+ */
+typedef AudioCoreT<AUDIO_BLOCK_SIZE_ADC> AudioCore;
+
 }
@@ -20,11 +20,11 @@
 #include <cstdint>
 
 #include "AudioCoreOutputPort.h"
+#include "AudioCore.h"
 
 namespace kc1fsz {
 
 class Clock;
-class AudioCore;
 class Activatable;
 
 class AudioCoreOutputPortStd : public AudioCoreOutputPort {
@@ -0,0 +1,131 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include <cstdio>
+#include <cstring>
+
+#include "AudioProfiler.h"
+
+namespace kc1fsz {
+
+static const char* STAGE_NAMES[AudioProfiler::STAGE_COUNT] = {
+    "rx params",
+    "rx q31->float",
+    "rx decimate",
+    "rx deemph",
+    "rx hpf",
+    "rx tone scan",
+    "rx ctcss decode",
+    "rx dtmf",
+    "rx delay",
+    "rx noise",
+    "rx meters/agc",
+    "tx ctcss",
+    "tx tone/mix",
+    "tx interpolate",
+    "tx meters",
+    "tx float->q31"
+};
+
+AudioProfiler::AudioProfiler() {
+    memset(&_work, 0, sizeof(_work));
+}
+
+void AudioProfiler::enableCounter() {
+#ifdef PICO_BUILD
+    m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+    m33_hw->dwt_cyccnt = 0;
+    m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+#endif
+}
+
+const char* AudioProfiler::stageName(Stage s) {
+    return (s < STAGE_COUNT) ? STAGE_NAMES[s] : "?";
+}
+
+// ****************************************************************************
+// NOTE: This function is called once per audio block so keep it short!
+// ****************************************************************************
+void AudioProfiler::endBlock() {
+    _work.blocks++;
+    const uint32_t r = _resetCount.load(std::memory_order_acquire);
+    if (r != _resetSeen) {
+        _resetSeen = r;
+        memset(&_work, 0, sizeof(_work));
+        _blocksSincePublish = PUBLISH_BLOCKS;
+    }
+    // The copy is large so it isn't done on every block
+    if (++_blocksSincePublish >= PUBLISH_BLOCKS) {
+        _blocksSincePublish = 0;
+        _stats.publish(_work);
+    }
+}
+
+void AudioProfiler::getStats(Stats* stats) const {
+    // A torn read is only possible if two publishes happen during the
+    // copy, so just try again.
+    while (!_stats.read(*stats));
+}
+
+void AudioProfiler::show() const {
+
+    Stats stats;
+    getStats(&stats);
+
+#ifdef PICO_BUILD
+    const char* units = "cycles";
+#else
+    const char* units = "ns";
+#endif
+
+    printf("Blocks: %lu, times in %s\n", (unsigned long)stats.blocks, units);
+    printf("%-16s %10s %8s %8s %8s\n", "Stage", "Count", "Min", "Avg", "Max");
+
+    uint32_t totalAvg = 0;
+    uint32_t totalMax = 0;
+
+    for (unsigned s = 0; s < STAGE_COUNT; s++) {
+        const StageStats& st = stats.stages[s];
+        if (st.count == 0)
+            continue;
+        const uint32_t avg = (uint32_t)(st.total / st.count);
+        totalAvg += avg;
+        totalMax += st.max;
+        printf("%-16s %10lu %8lu %8lu %8lu\n", stageName((Stage)s),
+            (unsigned long)st.count, (unsigned long)st.min, 
+            (unsigned long)avg, (unsigned long)st.max);
+        // Only the buckets that have something in them, labeled with 
+        // the bottom of the bucket.
+        printf("  ");
+        for (unsigned b = 0; b < HIST_BUCKETS; b++) {
+            if (st.hist[b] == 0)
+                continue;
+            const unsigned long low = (b == 0) ? 0 : 1UL << (HIST_BASE_BITS + b - 1);
+            printf(" %lu+:%.1f%%", low, 100.0 * (float)st.hist[b] / (float)st.count);
+        }
+        printf("\n");
+    }
+
+    // The sum of the worst cases is pessimistic since they don't all 
+    // happen in the same block.
+    printf("%-16s %10s %8s %8lu %8lu\n", "total", "", "", 
+        (unsigned long)totalAvg, (unsigned long)totalMax);
+}
+
+}
@@ -0,0 +1,188 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#ifdef PICO_BUILD
+#include "hardware/structs/m33.h"
+#else
+#include <chrono>
+#endif
+
+#include "Snapshot.h"
+
+// Hooks for timing the stages of the audio processing. These expand to 
+// nothing unless the firmware is built with AUDIO_PROFILE defined 
+// (cmake -DAUDIO_PROFILE=ON).
+#ifdef AUDIO_PROFILE
+#define AUDIO_PROFILE_START(p) (p).start()
+#define AUDIO_PROFILE_MARK(p, stage) (p).mark(AudioProfiler::stage)
+#define AUDIO_PROFILE_END_BLOCK(p) (p).endBlock()
+#else
+#define AUDIO_PROFILE_START(p)
+#define AUDIO_PROFILE_MARK(p, stage)
+#define AUDIO_PROFILE_END_BLOCK(p)
+#endif
+
+namespace kc1fsz {
+
+/**
+ * @brief Collects the time spent in each stage of the audio processing.
+ *
+ * The audio side calls start() at the top of cycleRx()/cycleTx() and 
+ * then mark() at the end of each stage, which charges everything since 
+ * the previous mark to that stage. endBlock() is called once per block.
+ *
+ * On the RP2350 the times are in CPU cycles from the Cortex-M33 DWT 
+ * cycle counter. The counter belongs to the core that is running the 
+ * audio, so that core needs to call enableCounter() once at startup. On
+ * the host the times are in nanoseconds.
+ *
+ * Each stage keeps min/avg/max and a histogram with power-of-two 
+ * buckets. The totals are published to the main loop as a Snapshot 
+ * every PUBLISH_BLOCKS blocks so reading them never disturbs the audio.
+ */
+class AudioProfiler {
+public:
+
+    enum Stage {
+        RX_PARAMS,
+        RX_Q31_IN,
+        RX_DECIMATE,
+        RX_DEEMPH,
+        RX_HPF,
+        RX_TONE_SCAN,
+        RX_CTCSS_DECODE,
+        RX_DTMF,
+        RX_DELAY,
+        RX_NOISE,
+        RX_METERS,
+        TX_CTCSS,
+        TX_TONE_MIX,
+        TX_INTERPOLATE,
+        TX_METERS,
+        TX_Q31_OUT,
+        STAGE_COUNT
+    };
+
+    // Bucket 0 is anything below 2^HIST_BASE_BITS, each bucket after 
+    // that is twice as wide and the last one takes everything above.
+    static const unsigned HIST_BUCKETS = 12;
+    static const unsigned HIST_BASE_BITS = 7;
+    static const unsigned PUBLISH_BLOCKS = 64;
+
+    struct StageStats {
+        uint32_t count;
+        uint32_t min;
+        uint32_t max;
+        uint64_t total;
+        uint32_t hist[HIST_BUCKETS];
+    };
+
+    struct Stats {
+        uint32_t blocks;
+        StageStats stages[STAGE_COUNT];
+    };
+
+    AudioProfiler();
+
+    /**
+     * @brief Turns on the cycle counter for the calling core. 
+     */
+    static void enableCounter();
+
+    static uint32_t now() {
+#ifdef PICO_BUILD
+        return m33_hw->dwt_cyccnt;
+#else
+        return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    static const char* stageName(Stage s);
+
+    /**
+     * @returns The histogram bucket for a time.
+     */
+    static unsigned bucket(uint32_t t) {
+        const uint32_t v = t >> HIST_BASE_BITS;
+        const unsigned b = (v == 0) ? 0 : 32 - __builtin_clz(v);
+        return (b < HIST_BUCKETS) ? b : HIST_BUCKETS - 1;
+    }
+
+    // ----- Audio side -------------------------------------------------------
+
+    void start() { 
+        _last = now(); 
+    }
+
+    void mark(Stage s) {
+        const uint32_t t = now();
+        _record(s, t - _last);
+        // Read again so that the bookkeeping isn't charged to the next stage
+        _last = now();
+    }
+
+    void endBlock();
+
+    // ----- Main loop side ---------------------------------------------------
+
+    /**
+     * @brief Gets the most recently published totals.
+     */
+    void getStats(Stats* stats) const;
+
+    /**
+     * @brief Clears the totals. This happens on the audio side at the 
+     * end of the next block.
+     */
+    void reset() { _resetCount.fetch_add(1, std::memory_order_release); }
+
+    /**
+     * @brief Prints the totals as a table.
+     */
+    void show() const;
+
+private:
+
+    void _record(Stage s, uint32_t t) {
+        StageStats& st = _work.stages[s];
+        if (st.count == 0 || t < st.min)
+            st.min = t;
+        if (t > st.max)
+            st.max = t;
+        st.count++;
+        st.total += t;
+        st.hist[bucket(t)]++;
+    }
+
+    uint32_t _last = 0;
+    unsigned _blocksSincePublish = 0;
+    // Only touched by the audio side
+    Stats _work;
+    Snapshot<Stats> _stats;
+    std::atomic<uint32_t> _resetCount = 0;
+    uint32_t _resetSeen = 0;
+};
+
+}
@@ -0,0 +1,101 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include "BiquadDesign.h"
+
+#include <cmath>
+#include <cassert>
+
+namespace kc1fsz {
+
+static const double PI_D = 3.14159265358979323846;
+
+void BiquadDesign::_lpfStage(float* c, float fc, float fs, float q) {
+    // See the RBJ "Audio EQ Cookbook"
+    const double w0 = 2.0 * PI_D * fc / fs;
+    const double cw = cos(w0);
+    const double alpha = sin(w0) / (2.0 * q);
+    const double a0 = 1.0 + alpha;
+    c[0] = ((1.0 - cw) / 2.0) / a0;
+    c[1] = (1.0 - cw) / a0;
+    c[2] = c[0];
+    // CMSIS sign convention for the feedback terms
+    c[3] = (2.0 * cw) / a0;
+    c[4] = -(1.0 - alpha) / a0;
+}
+
+void BiquadDesign::_hpfStage(float* c, float fc, float fs, float q) {
+    const double w0 = 2.0 * PI_D * fc / fs;
+    const double cw = cos(w0);
+    const double alpha = sin(w0) / (2.0 * q);
+    const double a0 = 1.0 + alpha;
+    c[0] = ((1.0 + cw) / 2.0) / a0;
+    c[1] = -(1.0 + cw) / a0;
+    c[2] = c[0];
+    c[3] = (2.0 * cw) / a0;
+    c[4] = -(1.0 - alpha) / a0;
+}
+
+// Each stage takes one conjugate pair of the Butterworth poles, which 
+// is just a particular Q.
+double BiquadDesign::_butterworthQ(unsigned k, unsigned order) {
+    return 1.0 / (2.0 * cos(PI_D * (2 * k + 1) / (2.0 * order)));
+}
+
+void BiquadDesign::butterworthLpf(float* coeffs, unsigned order, float fc, float fs) {
+    assert(order % 2 == 0);
+    for (unsigned k = 0; k < order / 2; k++)
+        _lpfStage(coeffs + k * COEFFS_PER_STAGE, fc, fs, _butterworthQ(k, order));
+}
+
+void BiquadDesign::butterworthHpf(float* coeffs, unsigned order, float fc, float fs) {
+    assert(order % 2 == 0);
+    for (unsigned k = 0; k < order / 2; k++)
+        _hpfStage(coeffs + k * COEFFS_PER_STAGE, fc, fs, _butterworthQ(k, order));
+}
+
+void BiquadDesign::notch(float* c, float f0, float fs, float q) {
+    const double w0 = 2.0 * PI_D * f0 / fs;
+    const double cw = cos(w0);
+    const double alpha = sin(w0) / (2.0 * q);
+    const double a0 = 1.0 + alpha;
+    c[0] = 1.0 / a0;
+    c[1] = (-2.0 * cw) / a0;
+    c[2] = c[0];
+    c[3] = (2.0 * cw) / a0;
+    c[4] = -(1.0 - alpha) / a0;
+}
+
+float BiquadDesign::magnitude(const float* coeffs, unsigned stages, float f, float fs) {
+    const double w = 2.0 * PI_D * f / fs;
+    double mag = 1.0;
+    for (unsigned k = 0; k < stages; k++) {
+        const float* c = coeffs + k * COEFFS_PER_STAGE;
+        // Evaluate H(z) at z = e^jw. The denominator is 
+        // 1 - a1 z^-1 - a2 z^-2 because of the CMSIS signs.
+        const double nr = c[0] + c[1] * cos(w) + c[2] * cos(2 * w);
+        const double ni = -(c[1] * sin(w) + c[2] * sin(2 * w));
+        const double dr = 1.0 - c[3] * cos(w) - c[4] * cos(2 * w);
+        const double di = c[3] * sin(w) + c[4] * sin(2 * w);
+        mag *= sqrt((nr * nr + ni * ni) / (dr * dr + di * di));
+    }
+    return mag;
+}
+
+}
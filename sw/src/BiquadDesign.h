@@ -0,0 +1,77 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+namespace kc1fsz {
+
+/**
+ * @brief Designs IIR filter sections on the device so that filters can 
+ * follow settings (i.e. tone frequencies) that are only known at run 
+ * time.
+ *
+ * The designs use the bilinear transform with the critical frequency 
+ * pre-warped, so the corner lands exactly where it is asked for.
+ *
+ * The coefficients are written in the order that 
+ * arm_biquad_cascade_df1_f32() expects: { b0, b1, b2, a1, a2 } for 
+ * each stage. NOTE: CMSIS adds the feedback terms, so a1/a2 have the 
+ * opposite sign from the usual (e.g. scipy) convention.
+ */
+class BiquadDesign {
+public:
+
+    static const unsigned COEFFS_PER_STAGE = 5;
+
+    /**
+     * @brief Butterworth low-pass.
+     *
+     * @param coeffs Must have room for (order / 2) stages.
+     * @param order Must be even.
+     */
+    static void butterworthLpf(float* coeffs, unsigned order, float fc, float fs);
+
+    /**
+     * @brief Butterworth high-pass.
+     *
+     * @param coeffs Must have room for (order / 2) stages.
+     * @param order Must be even.
+     */
+    static void butterworthHpf(float* coeffs, unsigned order, float fc, float fs);
+
+    /**
+     * @brief A single-stage notch. The -3dB bandwidth is f0 / q, so 
+     * a higher q is narrower (and slower to settle).
+     */
+    static void notch(float* coeffs, float f0, float fs, float q);
+
+    /**
+     * @returns The magnitude response of a cascade of stages at 
+     * frequency f.
+     */
+    static float magnitude(const float* coeffs, unsigned stages, float f, float fs);
+
+private:
+
+    static void _lpfStage(float* coeffs, float fc, float fs, float q);
+    static void _hpfStage(float* coeffs, float fc, float fs, float q);
+    static double _butterworthQ(unsigned k, unsigned order);
+};
+
+}
@@ -1,32 +1,84 @@
 #include "Config.h"
 
+#include <cstdio>
 #include <cstring>
-
-#include "pico/stdlib.h"
-#include "hardware/flash.h"
-#include "hardware/irq.h"
-#include "hardware/sync.h"
+#include <cassert>
 
 #include "kc1fsz-tools/Common.h"
 
+#include "ConfigFlash.h"
+#include "CtcssScanner.h"
+
 namespace kc1fsz {
 
+// Where the configuration is stored, see setFlash()
+static ConfigFlash* flash = 0;
+
+void Config::setFlash(ConfigFlash* f) {
+    flash = f;
+}
+
+// ===== Non-Blocking Save ===================================================
+//
+// NOTE: The main executable is built with the copy_to_ram binary type so 
+// nothing (in particular the audio ISR on core0 and the DSP on core1) 
+// executes from XIP flash. That means the erase/program operations can be 
+// performed without disabling interrupts or locking out the other core.
+//
+// The save is still broken into steps (one erase and then one 256-byte 
+// page program per call) to keep the main event loop responsive. The 
+// erase step can't be split up: 4096 bytes is the smallest erase that 
+// the flash supports and it takes ~45ms, during which the main loop
+// is blocked (the audio keeps running).
+
+// A private copy of the configuration is taken when the save is requested
+// so that further changes don't disturb a save in progress.
+static uint8_t saveBuffer[Config::CONFIG_SIZE] __attribute__((aligned(4)));
+// -1 means idle, 0 means the erase is pending, 1..N means that the 
+// page N-1 is the next to be programmed. Only used from the main loop.
+static int saveStep = -1;
+
+void Config::requestSave(const Config* cfg) {
+    memcpy(saveBuffer, (const void*)cfg, Config::CONFIG_SIZE);
+    saveStep = 0;
+}
+
+bool Config::isSavePending() {
+    return saveStep != -1;
+}
+
+bool Config::runSave() {
+    if (saveStep == -1) 
+        return false;
+    else if (saveStep == 0) {
+        // Must erase a full sector first (4096 bytes)
+        flash->erase();
+        saveStep = 1;
+        return false;
+    } 
+    else {
+        // IMPORTANT: Must be a multiple of 256!
+        const unsigned page = saveStep - 1;
+        flash->program(page * ConfigFlash::PAGE_SIZE, 
+            saveBuffer + page * ConfigFlash::PAGE_SIZE, ConfigFlash::PAGE_SIZE);
+        if ((page + 1) * ConfigFlash::PAGE_SIZE >= Config::CONFIG_SIZE) {
+            saveStep = -1;
+            return true;
+        } else {
+            saveStep = saveStep + 1;
+            return false;
+        }
+    }
+}
+
 void Config::saveConfig(const Config* cfg) {
-    uint32_t ints = save_and_disable_interrupts();
-    // Must erase a full sector first (4096 bytes)
-    flash_range_erase((PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE), FLASH_SECTOR_SIZE);
     // IMPORTANT: Must be a multiple of 256!
-    flash_range_program((PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE), (uint8_t*)cfg, 
-        Config::CONFIG_SIZE);
-    restore_interrupts(ints);
+    flash->write((const uint8_t*)cfg, Config::CONFIG_SIZE);
 }
 
 void Config::loadConfig(Config* cfg) {
     assert(sizeof(Config) == 512);
-    // The very last sector of flash is used. Compute the memory-mapped address, 
-    // remembering to include the offset for RAM
-    const uint8_t* addr = (uint8_t*)(XIP_BASE + (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE));
-    memcpy((void*)cfg, (const void*)addr, Config::CONFIG_SIZE);
+    flash->read((uint8_t*)cfg, Config::CONFIG_SIZE);
 }
 
 void Config::setFactoryDefaults(Config* cfg) {
@@ -40,6 +92,8 @@ void Config::setFactoryDefaults(Config* cfg) {
     cfg->general.diagFreq = 1000;
     cfg->general.diagLevel = -10;
     cfg->general.idRequiredInt = 10 * 60;
+    // PCM16
+    cfg->general.linkCodec = 0;
 
     // Receiver
     cfg->rx0.cosMode = 3;
@@ -61,6 +115,8 @@ void Config::setFactoryDefaults(Config* cfg) {
     cfg->rx0.agcLevel = -10;
     cfg->rx0.dtmfDetectLevel = -50;
     cfg->rx0.deemphMode = 0;
+    cfg->rx0.toneSet = 0;
+    cfg->rx0.hpfMode = 0;
     cfg->rx1 = cfg->rx0;
 
     cfg->rx0.cosMode = 0;
@@ -116,12 +172,20 @@ void Config::_showRx(const Config::ReceiveConfig* cfg,
     printf("%s rxtoneinactivetime: %d\n", pre, cfg->toneInactiveTime);
     printf("%s rxtonelevel: %.1f\n", pre, cfg->toneLevel);
     printf("%s rxtonefreq: %.1f\n", pre, cfg->toneFreq);
+    printf("%s rxtoneset: ", pre);
+    if (cfg->toneSet == 0)
+        printf("none");
+    for (unsigned k = 0; k < CtcssScanner::TONE_COUNT; k++)
+        if (cfg->toneSet & ((uint64_t)1 << k))
+            printf("%.1f ", CtcssScanner::TONES[k]);
+    printf("\n");
     printf("%s rxgain: %.1f\n", pre, cfg->gain);
     printf("%s delaytime: %d\n", pre, cfg->delayTime);
     printf("%s agcmode: %d\n", pre, cfg->agcMode);
     printf("%s agclevel: %.1f\n", pre, cfg->agcLevel);
     printf("%s dtmfdetectlevel: %.1f\n", pre, cfg->dtmfDetectLevel);
     printf("%s deemphmode: %d\n", pre, cfg->deemphMode);
+    printf("%s hpfmode: %d\n", pre, cfg->hpfMode);
 }
 
 void Config::_showTx(const Config::TransmitConfig* cfg,
@@ -158,6 +222,7 @@ void Config::show(const Config* cfg) {
     printf("   testtonefreq  : %.1f\n", cfg->general.diagFreq);
     printf("   testtonelevel : %.1f\n", cfg->general.diagLevel);
     printf("   idrequiredint : %u\n", cfg->general.idRequiredInt);
+    printf("   linkcodec     : %u\n", cfg->general.linkCodec);
     printf("\nRadio 0\n");
     _showRx(&cfg->rx0, "R0");
     _showTx(&cfg->tx0, "T0");
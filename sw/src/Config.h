@@ -25,12 +25,14 @@
 
 namespace kc1fsz {
 
+class ConfigFlash;
+
 /**
  * @brief The master application configuration structure.
  */
 struct Config {
 
-    const static int CONFIG_VERSION = 0xbabe + 17;
+    const static int CONFIG_VERSION = 0xbabe + 20;
     const static int CONFIG_SIZE = 512;
 
     const static int callSignMaxLen = 16;
@@ -46,6 +48,8 @@ struct Config {
         float diagLevel;
         float diagFreq;
         uint32_t idRequiredInt;
+        // Preferred encoding for the digital audio link (LinkCodecType)
+        uint32_t linkCodec;
     } general;
 
     struct ReceiveConfig {
@@ -64,6 +68,12 @@ struct Config {
         float agcLevel;
         float dtmfDetectLevel;
         uint32_t deemphMode;
+        // Standard CTCSS tones that are accepted (bit k is 
+        // CtcssScanner::TONES[k]). Zero means just use toneFreq.
+        uint64_t toneSet;
+        // CTCSS elimination filter: 0 is the FIR HPF, 1 is the IIR 
+        // notch+HPF (see AudioCore::setHpfMode)
+        uint32_t hpfMode;
     } rx0, rx1;
 
     struct TransmitConfig {
@@ -88,17 +98,56 @@ struct Config {
         bool rxEligible[maxReceivers];
     } txc0, txc1;
 
-    char pad[CONFIG_SIZE - 
+    char pad[CONFIG_SIZE - (
         4 + 
         sizeof(GeneralConfig) + 
         2 * sizeof(ReceiveConfig) +
         2 * sizeof(TransmitConfig) +
-        2 * sizeof(ControlConfig)
+        2 * sizeof(ControlConfig))
         ];
 
     bool isValid() { return magic == CONFIG_VERSION; }
+
+    /**
+     * @brief Sets the storage used by the load/save functions. Must 
+     * be called before any of them.
+     */
+    static void setFlash(ConfigFlash* flash);
     
+    /**
+     * @brief Writes the configuration to flash immediately. This blocks
+     * for the entire erase/program cycle so it should only be used
+     * before the audio system is started.
+     */
     static void saveConfig(const Config* cfg);
+
+    /**
+     * @brief Takes a copy of the configuration and schedules it to 
+     * be written to flash. The actual flash work is done in small 
+     * steps by runSave() so that the audio processing is never 
+     * stalled. A new request while a save is in progress will restart
+     * the save with the newer copy.
+     *
+     * NOTE: The main loop itself is blocked for the ~45ms sector erase
+     * (the first runSave() step).
+     */
+    static void requestSave(const Config* cfg);
+
+    /**
+     * @brief Performs the next step of a pending save, if any. Should 
+     * be called from the main event loop. The first step is the sector
+     * erase, which blocks for ~45ms. Each of the other steps programs 
+     * one 256-byte page (well under 1ms).
+     *
+     * @returns true when the last step of a save has just been completed.
+     */
+    static bool runSave();
+
+    /**
+     * @returns true if a save has been requested but not completed.
+     */
+    static bool isSavePending();
+
     static void loadConfig(Config* cfg);
     static void setFactoryDefaults(Config* cfg);
 
@@ -0,0 +1,60 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace kc1fsz {
+
+/**
+ * @brief The non-volatile storage behind the Config structure (one 
+ * flash sector). Offsets are relative to the start of the sector.
+ */
+class ConfigFlash {
+public:
+
+    static const unsigned SECTOR_SIZE = 4096;
+    // Programming must be done in whole pages
+    static const unsigned PAGE_SIZE = 256;
+
+    virtual void read(uint8_t* out, unsigned len) const = 0;
+
+    /**
+     * @brief Erases the whole sector.
+     */
+    virtual void erase() = 0;
+
+    /**
+     * @param offset Must be a multiple of PAGE_SIZE.
+     * @param len Must be a multiple of PAGE_SIZE.
+     */
+    virtual void program(unsigned offset, const uint8_t* data, unsigned len) = 0;
+
+    /**
+     * @brief Erases and programs in one go, locking out anything else 
+     * that might be running. 
+     */
+    virtual void write(const uint8_t* data, unsigned len) {
+        erase();
+        program(0, data, len);
+    }
+};
+
+}
@@ -0,0 +1,251 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include "Gpio.h"
+#include "Controller.h"
+
+namespace kc1fsz {
+
+static void transferConfigRx(const Config::ReceiveConfig& config, Rx& rx) {
+    rx.setCosMode((Rx::CosMode)config.cosMode);
+    rx.setCosActiveTime(config.cosActiveTime);
+    rx.setCosInactiveTime(config.cosInactiveTime);
+    rx.setCosLevel(config.cosLevel);
+    rx.setToneMode((Rx::ToneMode)config.toneMode);
+    rx.setToneActiveTime(config.toneActiveTime);
+    rx.setToneInactiveTime(config.toneInactiveTime);
+    rx.setToneLevel(config.toneLevel);
+    rx.setToneFreq(config.toneFreq);
+    rx.setToneSet(config.toneSet);
+    rx.setGainLinear(AudioCore::dbToLinear(config.gain));
+    rx.setDelayTime(config.delayTime);
+    rx.setDtmfDetectLevel(config.dtmfDetectLevel);
+    rx.setDeemphMode(config.deemphMode);
+    rx.setHpfMode(config.hpfMode);
+}
+
+static void transferConfigTx(const Config::TransmitConfig& config, Tx& tx) {
+    tx.setEnabled((bool)config.enabled);
+    tx.setPLToneMode((Tx::PLToneMode)config.toneMode);
+    tx.setPLToneLevel(config.toneLevel);
+    tx.setPLToneFreq(config.toneFreq);
+    tx.setCtMode((CourtesyToneGenerator::Type)config.ctMode);
+}
+
+static void transferControlConfig(const Config::ControlConfig& config, TxControl& txc,
+    AudioCoreOutputPortStd& acop) {
+    txc.setTimeoutTime(config.timeoutTime);
+    txc.setLockoutTime(config.lockoutTime);
+    txc.setHangTime(config.hangTime);
+    txc.setCtLevel(config.ctLevel);
+    txc.setIdMode(config.idMode);
+    txc.setIdLevel(config.idLevel);
+    for (unsigned i = 0; i < Config::maxReceivers; i++)
+        acop.setEligible(i, config.rxEligible[i]);
+}
+
+Controller::Controller(Clock& clock, Log& log, Gpio& gpio, Config& config, 
+    const Pins& pins)
+:   _clock(clock),
+    _log(log),
+    _config(config),
+    _core0(0, clock),
+    _core1(1, clock),
+    _core2(2, clock),
+    _mixBus(3),
+    _tx0(clock, log, 0, gpio, pins.r0Ptt, _core0,
+        // IMPORTANT SAFETY MECHANISM: Polled to control keying
+        [&config]() {
+            return config.tx0.enabled2;
+        }
+    ),
+    _tx1(clock, log, 1, gpio, pins.r1Ptt, _core1,
+        // IMPORTANT SAFETY MECHANISM: Polled to control keying
+        [&config]() {
+            return config.tx1.enabled2;
+        }
+    ),
+    _rx0(clock, log, 0, gpio, pins.r0Cos, pins.r0Ctcss, _core0),
+    _rx1(clock, log, 1, gpio, pins.r1Cos, pins.r1Ctcss, _core1),
+    _acop0(_core0, _rx0, _rx1, _core2),
+    _acop1(_core1, _rx0, _rx1, _core2),
+    _txCtl0(clock, log, _tx0, _acop0),
+    _txCtl1(clock, log, _tx1, _acop1),
+    _dtmfCmdProc(log, clock) {
+
+    // Never echo audio back on the network connection
+    _mixBus.setMixMinus(2, true);
+
+    // DTMF Command processing
+    _dtmfCmdProc.setAccessTrigger([this](bool enabled) {
+        if (enabled) {
+            _log.info("Access enabled");
+        } else {
+            _log.info("Access disabled");
+        }
+    });
+    _dtmfCmdProc.setDisableTrigger([this]() {
+        _log.info("Disable");
+        _config.tx0.enabled2 = false;
+        _config.tx1.enabled2 = false;
+        // Make sure these settings are non-volatile
+        Config::requestSave(&_config);
+    });
+    _dtmfCmdProc.setReenableTrigger([this]() {
+        _log.info("Reenable");
+        _config.tx0.enabled2 = true;
+        _config.tx1.enabled2 = true;
+        // Make sure these settings are non-volatile
+        Config::requestSave(&_config);
+    });
+    _dtmfCmdProc.setForceIdTrigger([this]() {
+        forceId();
+    });
+}
+
+// ****************************************************************************
+// NOTE: This function is called once per audio block so keep it short!
+// ****************************************************************************
+void Controller::audioCycle(const int32_t* r0_in, const int32_t* r1_in,
+    int32_t* r0_out, int32_t* r1_out) {
+    
+    float r0_cross[AudioCore::BLOCK_SIZE];
+    float r1_cross[AudioCore::BLOCK_SIZE];
+    float r2_cross[AudioCore::BLOCK_SIZE];
+    const float* cross_ins[3] = { r0_cross, r1_cross, r2_cross };
+
+    // RX-then-TX barrier: every port must complete its receive side 
+    // before any port starts its transmit side so that the cross-mix
+    // is built from sample-aligned blocks.
+    _core0.cycleRx(r0_in, r0_cross);
+    _core1.cycleRx(r1_in, r1_cross);
+    // There is no ADC input in this case:
+    _core2.cycleRx(r2_cross);
+
+    _mixBus.cycle(cross_ins);
+
+    float mix[AudioCore::BLOCK_SIZE];
+    _mixBus.getMix(0, mix);
+    _core0.cycleTx(mix, r0_out);
+    _mixBus.getMix(1, mix);
+    _core1.cycleTx(mix, r1_out);
+    // There is no DAC output in this case:
+    _mixBus.getMix(2, mix);
+    _core2.cycleTx(mix);
+}
+
+void Controller::run() {
+
+    // Check for commands
+    char d0 = _core0.getLastDtmfDetection();
+    if (d0 != 0) {
+        _log.info("DTMF [%c]", d0);
+        _dtmfCmdProc.processSymbol(d0);
+    }
+    char d1 = _core1.getLastDtmfDetection();
+    if (d1 != 0) {
+        _log.info("DTMF [%c]", d1);
+        _dtmfCmdProc.processSymbol(d1);
+    }
+
+    // Mute receivers when command processing is going on
+    _core0.setRxMute(_dtmfCmdProc.isAccess());
+    _core1.setRxMute(_dtmfCmdProc.isAccess());
+
+    // ----- Adjust Receiver Routing/Mixing -----------------------------------
+    //
+    // This is an ongoing process of adjusting the source gains on the 
+    // mix bus to make sure the audio from the correct receivers is 
+    // being mixed and passed through to the transmitters. 
+    // 
+    // This is a low-cost operation so, to simplify the logic, it is just
+    // done all the time.
+    unsigned activeCount = 0;
+    if (_rx0.isActive())
+        activeCount++;
+    if (_rx1.isActive())
+        activeCount++;
+    if (_core2.isActive())
+        activeCount++;
+
+    // Divide the gain evenly across the active receivers. The mix bus
+    // ramps the gains so there are no steps in the audio.
+    float gain = (activeCount != 0) ? 1.0 / (float)activeCount : 0;
+    _mixBus.setSourceGainLinear(0, _rx0.isActive() ? gain : 0.0);
+    _mixBus.setSourceGainLinear(1, _rx1.isActive() ? gain : 0.0);
+    _mixBus.setSourceGainLinear(2, _core2.isActive() ? gain : 0.0);
+
+    // Run all components
+    _tx0.run();
+    _tx1.run();
+    _rx0.run();
+    _rx1.run();
+    _txCtl0.run();
+    _txCtl1.run();
+    _dtmfCmdProc.run();
+}
+
+void Controller::transferConfig() {
+
+    // General configuration
+    _txCtl0.setCall(_config.general.callSign);
+    _txCtl0.setPass(_config.general.pass);
+    _txCtl0.setIdRequiredInt(_config.general.idRequiredInt);
+    _txCtl0.setDiagToneFreq(_config.general.diagFreq);
+    _txCtl0.setDiagToneLevel(_config.general.diagLevel);
+
+    _txCtl1.setCall(_config.general.callSign);
+    _txCtl1.setPass(_config.general.pass);
+    _txCtl1.setIdRequiredInt(_config.general.idRequiredInt);
+    _txCtl1.setDiagToneFreq(_config.general.diagFreq);
+    _txCtl1.setDiagToneLevel(_config.general.diagLevel);
+
+    // Receiver configuration
+    transferConfigRx(_config.rx0, _rx0);
+    transferConfigRx(_config.rx1, _rx1);
+
+    // Transmitter configuration
+    transferConfigTx(_config.tx0, _tx0);
+    transferConfigTx(_config.tx1, _tx1);
+
+    // Controller configuration
+    transferControlConfig(_config.txc0, _txCtl0, _acop0);
+    transferControlConfig(_config.txc1, _txCtl1, _acop1);
+}
+
+void Controller::forceId() {
+    _txCtl0.forceId();
+    _txCtl1.forceId();
+}
+
+void Controller::startTest(int r) {
+    if (r == 0)
+        _txCtl0.startTest();
+    else if (r == 1)
+        _txCtl1.startTest();
+}
+
+void Controller::stopTest(int r) {
+    if (r == 0)
+        _txCtl0.stopTest();
+    else if (r == 1)
+        _txCtl1.stopTest();
+}
+
+}
@@ -0,0 +1,132 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cstdint>
+
+#include "kc1fsz-tools/Log.h"
+#include "kc1fsz-tools/Clock.h"
+
+#include "Config.h"
+#include "AudioCore.h"
+#include "DigitalAudioPort.h"
+#include "MixBus.h"
+#include "StdRx.h"
+#include "StdTx.h"
+#include "TxControl.h"
+#include "AudioCoreOutputPortStd.h"
+#include "CommandProcessor.h"
+
+namespace kc1fsz {
+
+class Gpio;
+
+/**
+ * @brief The whole repeater controller: two radio ports, the network 
+ * audio port, the mix bus, the receivers/transmitters, the transmit 
+ * state machines and the DTMF command processor, wired together. 
+ *
+ * The hardware (pins, clock, flash behind the Config) is supplied from
+ * outside so that exactly the same wiring runs on the board (main.cpp)
+ * and in the host simulator.
+ *
+ * There are two entry points:
+ *
+ *  * audioCycle() is called once per audio block (on core1 in the 
+ *    firmware).
+ *  * run() is called from the main event loop.
+ */
+class Controller {
+public:
+
+    struct Pins {
+        unsigned r0Cos;
+        unsigned r0Ctcss;
+        unsigned r0Ptt;
+        unsigned r1Cos;
+        unsigned r1Ctcss;
+        unsigned r1Ptt;
+    };
+
+    Controller(Clock& clock, Log& log, Gpio& gpio, Config& config, const Pins& pins);
+
+    /**
+     * @brief Processes one block of CODEC audio for both radios. 
+     *
+     * @param r0_in, r1_in BLOCK_SIZE_ADC samples from the ADC.
+     * @param r0_out, r1_out BLOCK_SIZE_ADC samples for the DAC.
+     */
+    void audioCycle(const int32_t* r0_in, const int32_t* r1_in, 
+        int32_t* r0_out, int32_t* r1_out);
+
+    /**
+     * @brief One pass of the main event loop work (DTMF commands, 
+     * receiver routing, the transmit state machines).
+     */
+    void run();
+
+    /**
+     * @brief Transfers the parameters from the Config structure into 
+     * the controller objects. This needs to happen once at startup and
+     * then any time that the configuration is changed.
+     */
+    void transferConfig();
+
+    void forceId();
+    void startTest(int r);
+    void stopTest(int r);
+
+    AudioCore& getCore(unsigned r) { return r == 0 ? _core0 : _core1; }
+    DigitalAudioPort& getNetworkPort() { return _core2; }
+    MixBus& getMixBus() { return _mixBus; }
+    const StdRx& getRx(unsigned r) const { return r == 0 ? _rx0 : _rx1; }
+    const StdTx& getTx(unsigned r) const { return r == 0 ? _tx0 : _tx1; }
+    const TxControl& getTxControl(unsigned r) const { return r == 0 ? _txCtl0 : _txCtl1; }
+    const CommandProcessor& getCommandProcessor() const { return _dtmfCmdProc; }
+
+private:
+
+    Clock& _clock;
+    Log& _log;
+    Config& _config;
+
+    AudioCore _core0;
+    AudioCore _core1;
+    // This core is the digital audio input port
+    DigitalAudioPort _core2;
+    // Combines the receive audio from all ports
+    MixBus _mixBus;
+
+    StdTx _tx0;
+    StdTx _tx1;
+    StdRx _rx0;
+    StdRx _rx1;
+
+    // #### TODO: REVIEW THIS TEMPORARY BRIDGE CLASS
+    AudioCoreOutputPortStd _acop0;
+    AudioCoreOutputPortStd _acop1;
+
+    TxControl _txCtl0;
+    TxControl _txCtl1;
+
+    CommandProcessor _dtmfCmdProc;
+};
+
+}
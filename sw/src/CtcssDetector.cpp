@@ -0,0 +1,102 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include "CtcssDetector.h"
+
+#include <cmath>
+#include <cassert>
+
+namespace kc1fsz {
+
+CtcssDetector::CtcssDetector() {
+    reset();
+}
+
+void CtcssDetector::setFreq(float hz, float gain) {
+    _nco.setFreq(hz);
+    // The DFT magnitude is half of the window length times the amplitude
+    _scale = 1.0 / (gain * (float)WINDOW / 2.0);
+    reset();
+}
+
+void CtcssDetector::reset() {
+    for (unsigned i = 0; i < WINDOW; i++) {
+        _ringRe[i] = 0;
+        _ringIm[i] = 0;
+        _ringPower[i] = 0;
+    }
+    _ringPtr = 0;
+    _sumRe = 0;
+    _sumIm = 0;
+    _sumPower = 0;
+    _mag = 0;
+    _confidence = 0;
+}
+
+// The running sums pick up a little rounding error on each sample so 
+// they are re-computed from scratch once per trip around the ring.
+void CtcssDetector::_resum() {
+    _sumRe = 0;
+    _sumIm = 0;
+    _sumPower = 0;
+    for (unsigned i = 0; i < WINDOW; i++) {
+        _sumRe += _ringRe[i];
+        _sumIm += _ringIm[i];
+        _sumPower += _ringPower[i];
+    }
+}
+
+// ****************************************************************************
+// NOTE: This function is called once per audio block so keep it short!
+// ****************************************************************************
+void CtcssDetector::process(const float* in, unsigned n) {
+
+    assert(n <= MAX_BLOCK_SIZE);
+    float c[MAX_BLOCK_SIZE], s[MAX_BLOCK_SIZE];
+    _nco.generateQuadrature(c, s, n);
+
+    for (unsigned i = 0; i < n; i++) {
+        const float re = in[i] * c[i];
+        const float im = -in[i] * s[i];
+        const float p = in[i] * in[i];
+        _sumRe += re - _ringRe[_ringPtr];
+        _sumIm += im - _ringIm[_ringPtr];
+        _sumPower += p - _ringPower[_ringPtr];
+        _ringRe[_ringPtr] = re;
+        _ringIm[_ringPtr] = im;
+        _ringPower[_ringPtr] = p;
+        if (++_ringPtr == WINDOW) {
+            _ringPtr = 0;
+            _resum();
+        }
+    }
+
+    const float m2 = _sumRe * _sumRe + _sumIm * _sumIm;
+    _mag = sqrt(m2) * _scale;
+    // For a pure tone |X|^2 = (N/2) * sum(x^2). The small floor keeps
+    // silence from looking like anything.
+    if (_sumPower > 1e-9)
+        _confidence = m2 / ((float)WINDOW / 2.0 * _sumPower);
+    else 
+        _confidence = 0;
+    if (_confidence > 1.0)
+        _confidence = 1.0;
+}
+
+}
@@ -0,0 +1,104 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include "Nco.h"
+
+namespace kc1fsz {
+
+/**
+ * @brief Fast-locking detector for a single CTCSS tone.
+ *
+ * This is a sliding DFT: each sample is mixed down by the tone 
+ * frequency and the last WINDOW products are kept in a ring, so the 
+ * window sum is updated one sample at a time rather than once per 
+ * window. The result is always for the most recent 64 ms and can be 
+ * read after any block.
+ *
+ * It works on the 1 kHz sub-audible audio from the CtcssScanner, so 
+ * the cost is two multiply/adds per 8 input samples and most of the 
+ * voice has already been filtered out.
+ *
+ * Along with the level there is a confidence value. This is the 
+ * fraction of the sub-audible power in the window that is at the tone 
+ * frequency: close to 1 for a clean tone, about 0.2 for a tone 10 Hz
+ * away, under 0.1 beyond 12 Hz and close to 0 for noise. Tones closer
+ * than that (i.e. the adjacent standard tones) can't be separated in 
+ * 64 ms, that is left to the level threshold. A tone that has just 
+ * come on ramps up in both as it fills the window, so the confidence 
+ * crosses 0.5 in about half a window.
+ *
+ * The window isn't a whole number of cycles of the tone, so the level
+ * ripples by up to +/- 0.3 dB (worst at 67 Hz) as the phase moves.
+ */
+class CtcssDetector {
+public:
+
+    // Input sample rate
+    static const unsigned FS = 1000;
+    // Samples in the sliding window (64 ms)
+    static const unsigned WINDOW = 64;
+    // The largest block that can be passed to process()
+    static const unsigned MAX_BLOCK_SIZE = 16;
+
+    CtcssDetector();
+
+    /**
+     * @param gain The gain of whatever is in front of the detector 
+     * at this frequency, so it can be taken back out of the level.
+     */
+    void setFreq(float hz, float gain = 1.0);
+
+    void reset();
+
+    void process(const float* in, unsigned n);
+
+    /**
+     * @returns The peak amplitude of the tone over the window.
+     */
+    float getMag() const { return _mag; }
+
+    /**
+     * @returns 0.0 -> 1.0.
+     */
+    float getConfidence() const { return _confidence; }
+
+private:
+
+    void _resum();
+
+    Nco _nco { FS };
+    float _scale = 1.0;
+
+    float _ringRe[WINDOW];
+    float _ringIm[WINDOW];
+    float _ringPower[WINDOW];
+    unsigned _ringPtr = 0;
+
+    // Running window sums
+    float _sumRe = 0;
+    float _sumIm = 0;
+    float _sumPower = 0;
+
+    float _mag = 0;
+    float _confidence = 0;
+};
+
+}
@@ -0,0 +1,138 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include "CtcssScanner.h"
+
+#include <cmath>
+#include <cassert>
+
+#include "BiquadDesign.h"
+
+namespace kc1fsz {
+
+const float CtcssScanner::TONES[TONE_COUNT] = {
+     67.0,  69.3,  71.9,  74.4,  77.0,  79.7,  82.5,  85.4,  88.5,  91.5,
+     94.8,  97.4, 100.0, 103.5, 107.2, 110.9, 114.8, 118.8, 123.0, 127.3,
+    131.8, 136.5, 141.3, 146.2, 151.4, 156.7, 159.8, 162.2, 165.5, 167.9,
+    171.3, 173.8, 177.3, 179.9, 183.5, 186.2, 189.9, 192.8, 196.6, 199.5,
+    203.5, 206.5, 210.7, 218.1, 225.7, 229.1, 233.6, 241.8, 250.3, 254.1
+};
+
+// Puts the top tone at -0.8 dB while keeping the images that land on 
+// the tones (746 Hz and up) at least 49 dB down.
+static const float LPF_CORNER = 290;
+static const double PI_D = 3.14159265358979323846;
+
+CtcssScanner::CtcssScanner() {
+
+    BiquadDesign::butterworthLpf(_lpfCoeffs, LPF_STAGES * 2, LPF_CORNER, FS_IN);
+    arm_biquad_cascade_df1_init_f32(&_lpf, LPF_STAGES, _lpfCoeffs, _lpfState);
+
+    for (unsigned k = 0; k < TONE_COUNT; k++) {
+        _coeffs[k] = 2.0 * cos(2.0 * PI_D * TONES[k] / (double)FS_LOW);
+        // The Goertzel magnitude is half of the window length times 
+        // the amplitude
+        _scales[k] = 1.0 / (getLowRateGain(TONES[k]) * (float)WINDOW / 2.0);
+    }
+
+    reset();
+}
+
+void CtcssScanner::reset() {
+    for (unsigned i = 0; i < LPF_STAGES * 4; i++)
+        _lpfState[i] = 0;
+    for (unsigned k = 0; k < TONE_COUNT; k++) {
+        _z1[k] = 0;
+        _z2[k] = 0;
+        _powers[k] = 0;
+    }
+    _decimatePhase = 0;
+    _lowCount = 0;
+    _count = 0;
+    _strongest = -1;
+    _strongestMag = 0;
+}
+
+// ****************************************************************************
+// NOTE: This function is called once per audio block so keep it short!
+// ****************************************************************************
+void CtcssScanner::process(const float* in, unsigned n) {
+
+    assert(n <= MAX_BLOCK_SIZE);
+    float filtered[MAX_BLOCK_SIZE];
+    arm_biquad_cascade_df1_f32(&_lpf, in, filtered, n);
+
+    _lowCount = 0;
+    for (unsigned i = 0; i < n; i++) {
+        if (++_decimatePhase < DECIMATION)
+            continue;
+        _decimatePhase = 0;
+        const float x = filtered[i];
+        _low[_lowCount++] = x;
+        for (unsigned k = 0; k < TONE_COUNT; k++) {
+            const float z0 = x + _coeffs[k] * _z1[k] - _z2[k];
+            _z2[k] = _z1[k];
+            _z1[k] = z0;
+        }
+        if (++_count == WINDOW)
+            _finishWindow();
+    }
+}
+
+void CtcssScanner::_finishWindow() {
+    int best = -1;
+    float bestMag = 0;
+    for (unsigned k = 0; k < TONE_COUNT; k++) {
+        // Standard Goertzel power, with the scaling folded in so that 
+        // tones can be compared
+        const float p = _z1[k] * _z1[k] + _z2[k] * _z2[k] - 
+            _coeffs[k] * _z1[k] * _z2[k];
+        _powers[k] = p;
+        const float m2 = p * _scales[k] * _scales[k];
+        if (m2 > bestMag) {
+            bestMag = m2;
+            best = k;
+        }
+        _z1[k] = 0;
+        _z2[k] = 0;
+    }
+    _strongest = best;
+    _strongestMag = sqrt(bestMag);
+    _windowCount++;
+    _count = 0;
+}
+
+float CtcssScanner::getLowRateGain(float hz) const {
+    return BiquadDesign::magnitude(_lpfCoeffs, LPF_STAGES, hz, FS_IN);
+}
+
+float CtcssScanner::getMag(unsigned tone) const {
+    assert(tone < TONE_COUNT);
+    const float p = _powers[tone];
+    return (p > 0) ? sqrt(p) * _scales[tone] : 0;
+}
+
+int CtcssScanner::findTone(float hz) {
+    for (unsigned k = 0; k < TONE_COUNT; k++)
+        if (fabs(TONES[k] - hz) < 0.5)
+            return k;
+    return -1;
+}
+
+}
@@ -0,0 +1,142 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cstdint>
+
+#include <arm_math.h>
+
+namespace kc1fsz {
+
+/**
+ * @brief Measures all of the standard CTCSS tones at once so that the 
+ * tone being sent can be identified, or a receiver can accept any one
+ * of a set of tones.
+ *
+ * The tones are all below 255 Hz so the 8k audio is first passed 
+ * through a 6th order Butterworth LPF and decimated by 8 (to 1 kHz). 
+ * A Goertzel detector for each tone then runs at the low rate, which 
+ * makes the per-tone cost 1/8 of what it would be at 8k. The LPF droop
+ * at each tone is known so it is compensated in the results.
+ *
+ * The decimation can't go much further: at 667 Hz (/12) the voice 
+ * energy around 400-450 Hz folds right onto the upper tones.
+ *
+ * The detectors run over a fixed window of 384 decimated samples 
+ * (384 ms). This is long enough to separate the closest tones (67.0 and
+ * 69.3 Hz) by about 17 dB. At the end of each window the strongest 
+ * tone and its level are latched.
+ */
+class CtcssScanner {
+public:
+
+    // The EIA tones
+    static const unsigned TONE_COUNT = 50;
+    static const float TONES[TONE_COUNT];
+
+    static const unsigned FS_IN = 8000;
+    static const unsigned DECIMATION = 8;
+    static const unsigned FS_LOW = FS_IN / DECIMATION;
+    // Decimated samples in each detection window
+    static const unsigned WINDOW = 384;
+    // The largest block that can be passed to process()
+    static const unsigned MAX_BLOCK_SIZE = 64;
+
+    CtcssScanner();
+
+    void reset();
+
+    /**
+     * @param in n samples of 8k audio, n <= MAX_BLOCK_SIZE.
+     */
+    void process(const float* in, unsigned n);
+
+    /**
+     * @returns The index (into TONES) of the strongest tone in the 
+     * last complete window, or -1 if there was nothing at all (or no
+     * window has completed yet).
+     */
+    int getStrongestTone() const { return _strongest; }
+
+    /**
+     * @returns The peak amplitude of the strongest tone in the last 
+     * complete window.
+     */
+    float getStrongestMag() const { return _strongestMag; }
+
+    /**
+     * @returns The peak amplitude of a tone in the last complete window.
+     */
+    float getMag(unsigned tone) const;
+
+    /**
+     * @returns The low-rate (FS_LOW) samples that were produced by the
+     * last call to process(), so that other sub-audible detectors can 
+     * share the LPF/decimation. See getLowRateCount().
+     */
+    const float* getLowRate() const { return _low; }
+    unsigned getLowRateCount() const { return _lowCount; }
+
+    /**
+     * @returns The gain of the LPF in front of the decimation at the 
+     * given frequency.
+     */
+    float getLowRateGain(float hz) const;
+
+    /**
+     * @returns A count of the windows that have been completed. Can be 
+     * used to tell when new results are available.
+     */
+    uint32_t getWindowCount() const { return _windowCount; }
+
+    /**
+     * @returns The index of the standard tone within 0.5 Hz of hz, or 
+     * -1 if there isn't one.
+     */
+    static int findTone(float hz);
+
+private:
+
+    void _finishWindow();
+
+    static const unsigned LPF_STAGES = 3;
+    float _lpfCoeffs[LPF_STAGES * 5];
+    float _lpfState[LPF_STAGES * 4];
+    arm_biquad_casd_df1_inst_f32 _lpf;
+    unsigned _decimatePhase = 0;
+    float _low[MAX_BLOCK_SIZE / DECIMATION];
+    unsigned _lowCount = 0;
+
+    // Goertzel detectors
+    float _coeffs[TONE_COUNT];
+    // Corrects for the LPF response and the window length
+    float _scales[TONE_COUNT];
+    float _z1[TONE_COUNT];
+    float _z2[TONE_COUNT];
+    unsigned _count = 0;
+
+    // Results of the last window (squared, before scaling)
+    float _powers[TONE_COUNT];
+    int _strongest = -1;
+    float _strongestMag = 0;
+    uint32_t _windowCount = 0;
+};
+
+}
@@ -26,10 +26,12 @@
 
 namespace kc1fsz {
 
-DigitalAudioPort::DigitalAudioPort(unsigned id, unsigned crossCount, Clock& clock)
+template<unsigned BS>
+DigitalAudioPortT<BS>::DigitalAudioPortT(unsigned id, Clock& clock)
 :   _id(id),
-    _crossCount(crossCount),
-    _clock(clock) {
+    _clock(clock),
+    _jitter(BLOCK_SIZE),
+    _drift(BLOCK_SIZE) {
 }
 
 // ****************************************************************************
@@ -38,19 +40,16 @@ DigitalAudioPort::DigitalAudioPort(unsigned id, unsigned crossCount, Clock& cloc
 // ****************************************************************************
 //
 // This is called when a packet of audio is received from the network. The 
-// data is placed in the circular buffer so it is available for cycleRx() on
-// the next audio tick.
+// data is placed in the jitter buffer so it is available for cycleRx() on
+// the later audio ticks.
 //
-void DigitalAudioPort::loadNetworkAudio(const uint8_t* audio8KLE, unsigned len) {
+template<unsigned BS>
+void DigitalAudioPortT<BS>::loadNetworkAudio(uint8_t seq, const uint8_t* audio8KLE, 
+    unsigned len) {
     assert(len == NETWORK_FRAME_SIZE);
-    // Move new data into circular buffer
-    for (unsigned i = 0; i < len; i++) {
-        _extAudioIn[_extAudioInWr++] = audio8KLE[i];
-        if (_extAudioInWr == _extAudioInCapacity)
-            _extAudioInWr = 0;
-        _extAudioInLen++;
-    }
-    _lastInputUs = _clock.timeUs();
+    const uint32_t now = _clock.timeUs();
+    _lastInputUs.store(now, std::memory_order_relaxed);
+    _jitter.put(seq, audio8KLE, now);
 }
 
 // ****************************************************************************
@@ -60,38 +59,32 @@ void DigitalAudioPort::loadNetworkAudio(const uint8_t* audio8KLE, unsigned len)
 // 
 // This is called on each tick to extract a frame of audio for playback.
 //
-void DigitalAudioPort::cycleRx(float* crossOut) {    
-    // Check for the drain situation.
-    if (_extAudioInLen < BLOCK_SIZE * 2) {
-        for (unsigned i = 0; i < BLOCK_SIZE; i++)
-            crossOut[i] = 0;       
-        _extAudioInTriggered = false; 
+template<unsigned BS>
+void DigitalAudioPortT<BS>::cycleRx(float* crossOut) {    
+    // The resampler decides how much audio is needed to make a block
+    const bool wasPlaying = _jitter.isPlaying();
+    const unsigned need = _drift.inputNeeded(BLOCK_SIZE);
+    assert(need <= BLOCK_SIZE + 1);
+    _jitter.get(_driftIn, need);
+    _drift.process(_driftIn, need, crossOut, BLOCK_SIZE);
+    // Steer the resampler to keep the jitter buffer depth steady
+    if (_jitter.isPlaying()) {
+        if (!wasPlaying)
+            _drift.restart();
+        _drift.steer(_jitter.getDepth());
     }
-    else {
-        // Decide if we have enough of a backlog to start delivering the audio.
-        // This is a very simple jitter buffer mechanism to avoid problems with
-        // subtle timing differences between network arrival and the 
-        // audio tick rate. It's better to keep the playout slightly behind the 
-        // network arrival cadence. 
-        if (_extAudioInLen >= BLOCK_SIZE * 2) {
-            _extAudioInTriggered = true;
-        }
+    RxStatus st;
+    _jitter.getStats(&st.jitter);
+    st.driftPpm = _drift.getPpm();
+    _rxStatus.publish(st);
+}
 
-        if (_extAudioInTriggered) {
-            for (unsigned i = 0; i < BLOCK_SIZE; i++)  {
-                crossOut[i] = 
-                    (float)unpack_int16_le(_extAudioIn + _extAudioInRd) / 32767.0f;
-                // Increment and deal with wrap
-                _extAudioInRd += 2;
-                if (_extAudioInRd == _extAudioInCapacity)
-                    _extAudioInRd = 0;
-                _extAudioInLen -= 2;
-            }
-        } else {
-            for (unsigned i = 0; i < BLOCK_SIZE; i++)
-                crossOut[i] = 0;       
-        }
-    }
+template<unsigned BS>
+typename DigitalAudioPortT<BS>::RxStatus DigitalAudioPortT<BS>::_readRxStatus() const {
+    // The audio side publishes once per block so a retry is very rare
+    RxStatus st;
+    while (!_rxStatus.read(st));
+    return st;
 }
 
 // ****************************************************************************
@@ -102,13 +95,11 @@ void DigitalAudioPort::cycleRx(float* crossOut) {
 // This function is called on every audio tick. It delivers the output
 // audio that should be sent out on the network as soon as possible.
 //
-void DigitalAudioPort::cycleTx(const float** cross_ins) {
-    // Mix all of the audio sources and produce a single 8K PCM16 frame
+template<unsigned BS>
+void DigitalAudioPortT<BS>::cycleTx(const float* bus_in) {
+    // Convert the mix to 8K PCM16 
     for (unsigned i = 0; i < BLOCK_SIZE; i++)  {
-        float mix = 0;
-        for (unsigned j = 0; j < _crossCount; j++)
-            mix += _crossGains[j] * cross_ins[j][i];
-        int16_t pcm = mix * 32767.0f;
+        int16_t pcm = bus_in[i] * 32767.0f;
         pack_int16_le(pcm, _extAudioOut + _extAudioOutWr);
         // Increment and deal with wrap
         _extAudioOutWr += 2;
@@ -121,7 +112,8 @@ void DigitalAudioPort::cycleTx(const float** cross_ins) {
 // NOTE: This function is called from inside of the audio frame ISR so keep it 
 // short!
 // ****************************************************************************
-bool DigitalAudioPort::isNetworkAudioPending() const {
+template<unsigned BS>
+bool DigitalAudioPortT<BS>::isNetworkAudioPending() const {
 
     unsigned pending;
     if (_extAudioOutWr >= _extAudioOutRd)
@@ -136,7 +128,8 @@ bool DigitalAudioPort::isNetworkAudioPending() const {
 // NOTE: This function is called from inside of the audio frame ISR so keep it 
 // short!
 // ****************************************************************************
-void DigitalAudioPort::extractNetworkAudio(uint8_t* audio8KLE, unsigned len) {
+template<unsigned BS>
+void DigitalAudioPortT<BS>::extractNetworkAudio(uint8_t* audio8KLE, unsigned len) {
     assert(len == NETWORK_FRAME_SIZE);
     // Move new data out of circular buffer
     for (unsigned i = 0; i < len; i++) {
@@ -151,14 +144,19 @@ void DigitalAudioPort::extractNetworkAudio(uint8_t* audio8KLE, unsigned len) {
     }
 }
 
-void DigitalAudioPort::setCrossGainLinear(unsigned i, float gain) {  
-    assert(i < MAX_CROSS_COUNT);
-    _crossGains[i] = gain;
-}
-
-bool DigitalAudioPort::isActive() const {
+template<unsigned BS>
+bool DigitalAudioPortT<BS>::isActive() const {
     // If audio was received within the last 40ms then we are active
-    return (_clock.timeUs() - _lastInputUs < 40 * 1000);
+    const uint32_t now = _clock.timeUs();
+    return (now - _lastInputUs.load(std::memory_order_relaxed) < 40 * 1000);
 }
 
+#ifdef PICO_BUILD
+template class DigitalAudioPortT<AUDIO_BLOCK_SIZE_ADC>;
+#else
+template class DigitalAudioPortT<64>;
+template class DigitalAudioPortT<128>;
+template class DigitalAudioPortT<256>;
+#endif
+
 }
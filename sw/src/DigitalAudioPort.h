@@ -17,8 +17,13 @@
  */
 #pragma once
 #include <cstdint>
+#include <atomic>
 
 #include "Activatable.h"
+#include "AudioBlockSize.h"
+#include "JitterBuffer.h"
+#include "DriftResampler.h"
+#include "Snapshot.h"
 
 namespace kc1fsz {
 
@@ -29,26 +34,30 @@ class Clock;
  * audio core.
  *
  * Network audio frames are 160 PCM16 samples (every 20ms). The SDR
- * audio frames are 64 PCM16 samples (every 8ms).
+ * audio frames are BS/4 PCM16 samples (every 8ms for the default 
+ * block size of 256). Inbound frames go through a JitterBuffer and 
+ * then a DriftResampler that tracks the peer's clock.
+ *
+ * @tparam BS Number of 32k CODEC samples per block, must match the 
+ * AudioCore.
  */
-class DigitalAudioPort : public Activatable {
+template<unsigned BS> class DigitalAudioPortT : public Activatable {
 public:
 
     static const unsigned FS_ADC = 32000;
-    static const unsigned BLOCK_SIZE_ADC = 256;
+    static const unsigned BLOCK_SIZE_ADC = BS;
     static const unsigned FS = FS_ADC / 4;
     static const unsigned BLOCK_SIZE = BLOCK_SIZE_ADC / 4;
-    static const unsigned MAX_CROSS_COUNT = 8;
     // Size in bytes (16 bit PCM)
     static const unsigned NETWORK_FRAME_SIZE = 160 * 2;
 
-    DigitalAudioPort(unsigned id, unsigned crossCount, Clock& clock);
+    DigitalAudioPortT(unsigned id, Clock& clock);
 
     /**
      * @brief Called once per CODEC block. Expected to run quickly 
      * inside of the interrupt service routine.
      *
-     * @param cross_out One 8ms block of audio data at the 8k rate 
+     * @param cross_out One block of audio data at the 8k rate 
      * ready to be shared across the repeater.
      */
     void cycleRx(float* cross_out);
@@ -57,28 +66,34 @@ public:
      * @brief Called once per CODEC block. Expected to run quickly 
      * inside of the interrupt service routine.
      *
-     * @param cross_in 8ms of 8k data from all of the sources. See 
-     * setCrossGainLinear() for information about how they are mixed.
+     * @param bus_in One block of 8k audio from the MixBus that should be
+     * sent to the network.
      */
-    void cycleTx(const float** cross_ins);
+    void cycleTx(const float* bus_in);
 
     /**
-     * Controls how much of each cross input gets included in the output
-     * during calls to cycleTx.
+     * Used to stage 20ms of audio that will be pulled out by later calls 
+     * to cycleRx().
      * 
-     * @param i The contributor index, corresponds to the cross_ins array
-     * index in the cycleTx() function.
-     * @param gain 0->1 linear scale.
+     * @param seq The sequence number of the frame.
+     * @param len For sanity check, must be 160 * 2.
      */
-    void setCrossGainLinear(unsigned i, float gain);
+    void loadNetworkAudio(uint8_t seq, const uint8_t* audio8KLE, unsigned len);
 
     /**
-     * Used to stage 20ms of audio that will be pulled out in the next call to 
-     * cycleRx().
-     * 
-     * @param len For sanity check, must be 160 * 2.
+     * @brief Underrun/overrun/depth statistics for the receive side, as 
+     * of the last cycleRx(). Safe to call from the main loop.
+     */
+    void getJitterStats(JitterBuffer::Stats* stats) const { 
+        *stats = _readRxStatus().jitter;
+    }
+
+    /**
+     * @returns The current clock drift correction applied to the 
+     * received audio, as of the last cycleRx(). Safe to call from the 
+     * main loop.
      */
-    void loadNetworkAudio(const uint8_t* audio8KLE, unsigned len);
+    float getDriftPpm() const { return _readRxStatus().driftPpm; }
 
     /**
      * @returns true If there is enough network audio waiting to 
@@ -100,25 +115,29 @@ public:
 
 private:
 
+    /**
+     * Receive side readings that go back to the main loop.
+     */
+    struct RxStatus {
+        JitterBuffer::Stats jitter;
+        float driftPpm;
+    };
+
+    RxStatus _readRxStatus() const;
+
     const unsigned _id;
-    const unsigned _crossCount;
     Clock& _clock;
 
-    float _crossGains[MAX_CROSS_COUNT];
-
-    // Circular buffer for inbound data (from network)
-    uint8_t _extAudioIn[NETWORK_FRAME_SIZE * 2];
-    const unsigned _extAudioInCapacity = NETWORK_FRAME_SIZE * 2;
-    unsigned _extAudioInRd = 0;
-    unsigned _extAudioInWr = 0;
-    unsigned _extAudioInLen = 0;
-    // This is used to trigger the playout of audio received from 
-    // the network. There is a bit of hysteresis built into the system
-    // to avoid subtle timing issues.
-    bool _extAudioInTriggered = false;
-    // The last time audio was received off the network. Used to control
-    // the isActive() indicator.
-    uint64_t _lastInputUs = 0;
+    // Inbound data (from network)
+    JitterBuffer _jitter;
+    DriftResampler _drift;
+    // Resampler input, which can be one sample more than a block
+    float _driftIn[BLOCK_SIZE + 1];
+    // The last time audio was received off the network (low 32 bits). 
+    // Used to control the isActive() indicator, which is called from the
+    // main loop.
+    std::atomic<uint32_t> _lastInputUs = 0;
+    Snapshot<RxStatus> _rxStatus;
 
     // Circular buffer for outbound data (to network)
     uint8_t _extAudioOut[NETWORK_FRAME_SIZE * 2];
@@ -127,4 +146,9 @@ private:
     unsigned _extAudioOutWr = 0;
 };
 
-}
\ No newline at end of file
+/**
+ * The digital audio port for the block size that the firmware was built with.
+ */
+typedef DigitalAudioPortT<AUDIO_BLOCK_SIZE_ADC> DigitalAudioPort;
+
+}
@@ -21,11 +21,11 @@
 
 // 3rd party
 #include "cobs.h"
-#include "crc.h"
 
 // KC1FSZ stuff
 #include "kc1fsz-tools/Common.h"
 
+#include "LinkCrc.h"
 #include "DigitalAudioPortRxHandler.h"
 
 using namespace std;
@@ -39,48 +39,126 @@ DigitalAudioPortRxHandler::DigitalAudioPortRxHandler(uint8_t* rxBuf, unsigned rx
     _rxBufMask(sizeToBitMask(rxBufSize)) {
 }
 
-void DigitalAudioPortRxHandler::processRxBuf(unsigned nextWrPtr,
-    std::function<void(const uint8_t* msg, unsigned msgLen)> cb) {
+// ****************************************************************************
+// NOTE: This function is called from inside of an ISR so keep it short!
+// ****************************************************************************
+int DigitalAudioPortRxHandler::_nextMsg(unsigned nextWrPtr, uint8_t* payload,
+    uint8_t* flags) {
 
-    bool firedCb = false;
+    while (_nextRdPtr != nextWrPtr) {
 
-    while (!firedCb && _nextRdPtr != nextWrPtr) {
         assert(_nextRdPtr < _rxBufSize);
-        if (_rxBuf[_nextRdPtr] == HEADER_CODE) {
-            // When a header is found we reset the accumulation and 
-            // start again.
-            _completeMsg[0] = 0;
-            _completeMsgLen = 1;
-            _haveHeader = true;
-        } else if (_haveHeader) {
-            // Keep accumulating a potential message
-            _completeMsg[_completeMsgLen++] = _rxBuf[_nextRdPtr];
-            // Did we get a full message?
-            if (_completeMsgLen == NETWORK_MESSAGE_SIZE) {
-                _processEncodedMsg(_completeMsg, _completeMsgLen, cb);
-                firedCb = true;
+
+        if (!_haveHeader) {
+            if (_rxBuf[_nextRdPtr] == HEADER_CODE) {
+                _haveHeader = true;
+                _msgStart = _nextRdPtr;
+                _msgLen = 1;
+            }
+            _nextRdPtr = (_nextRdPtr + 1) & _rxBufMask;
+            continue;
+        }
+
+        // Look at the largest contiguous run of bytes that is available 
+        // and still needed to complete the message. The size of the 
+        // message isn't known until the flags byte has been seen.
+        unsigned avail = (nextWrPtr > _nextRdPtr) ? 
+            nextWrPtr - _nextRdPtr : _rxBufSize - _nextRdPtr;
+        unsigned need = ((_msgLen < 2) ? 2 : _msgSize) - _msgLen;
+        unsigned run = (avail < need) ? avail : need;
+
+        // A header byte in the middle of the message means that the 
+        // message was truncated. Reset the accumulation and start again 
+        // from the new header.
+        const uint8_t* hdr = (const uint8_t*)memchr(_rxBuf + _nextRdPtr, 
+            HEADER_CODE, run);
+        if (hdr) {
+            // A lapped message usually ends up this way
+            if (_msgStalled) {
+                _overrunCount++;
+                _msgStalled = false;
+            }
+            _msgStart = hdr - _rxBuf;
+            _msgLen = 1;
+            _nextRdPtr = (_msgStart + 1) & _rxBufMask;
+            continue;
+        }
+
+        _msgLen += run;
+        _nextRdPtr = (_nextRdPtr + run) & _rxBufMask;
+
+        if (_msgLen == 2) {
+            const uint8_t f = _at(_msgStart, 1);
+            if (!isValidFlags(f)) {
+                _dropMsg();
+                return -1;
+            }
+            _msgSize = msgSize(f);
+        }
+        // Did we get a full message?
+        else if (_msgLen == _msgSize) {
+            if (_decodeInPlace(_msgStart, payload) == 0) {
+                *flags = _at(_msgStart, 1);
                 _haveHeader = false;
+                _msgStalled = false;
+                _rxCount++;
+                return 1;
+            } else {
+                _dropMsg();
+                return -1;
             }
-        } 
-        _nextRdPtr = (_nextRdPtr + 1) & _rxBufMask;
+        }
     }
+    return 0;
 }
 
-void DigitalAudioPortRxHandler::_processEncodedMsg(
-    const uint8_t* encodedBuf, unsigned encodedBufLen,
-    std::function<void(const uint8_t* msg, unsigned msgLen)> cb) {
+int DigitalAudioPortRxHandler::_decodeInPlace(unsigned start, uint8_t* payload) const {
 
-    assert(encodedBufLen == NETWORK_MESSAGE_SIZE);
+    const uint8_t flags = _at(start, 1);
+    if (!isValidFlags(flags))
+        return -3;
+    const unsigned payloadLen = payloadSize(flags);
+    const unsigned crcSpan = 1 + FLAGS_LEN + payloadLen + COBS_OVERHEAD;
 
-    // Decode the payload.
-    uint8_t payload[PAYLOAD_SIZE];
-    int rc = decodeMsg(encodedBuf, encodedBufLen, payload, PAYLOAD_SIZE);
-    if (rc == 0) {
-        cb(payload, PAYLOAD_SIZE);
-        _rxCount++;
-    } else {
-        _badCount++;
+    // CRC is everything, including the header. This may be in two pieces
+    // if the message wraps.
+    unsigned firstPart = _rxBufSize - start;
+    if (firstPart > crcSpan)
+        firstPart = crcSpan;
+    uint16_t expectedCrc = linkCrcUpdate(LINK_CRC_INITIAL, _rxBuf + start, firstPart);
+    expectedCrc = linkCrcUpdate(expectedCrc, _rxBuf, crcSpan - firstPart);
+    const uint8_t crc3[3] = { _at(start, crcSpan), _at(start, crcSpan + 1), 
+        _at(start, crcSpan + 2) };
+    if (decodeCrc(crc3) != (int16_t)expectedCrc)
+        return -2;
+    unsigned cobsOverhead = _at(start, 2);
+    if (!(cobsOverhead == 1 || cobsOverhead == 2))
+        return -4;
+
+    // COBS decode straight out of the circular buffer
+    unsigned i = 3;
+    const unsigned end = 3 + payloadLen + cobsOverhead;
+    unsigned o = 0;
+    while (i < end) {
+        const unsigned code = _at(start, i++);
+        if (code == 0)
+            return -5;
+        for (unsigned j = 1; j < code; j++) {
+            if (i == end || o == payloadLen)
+                return -5;
+            payload[o++] = _at(start, i++);
+        }
+        // Each block other than a maximum-length block (or the last) 
+        // implies a zero.
+        if (code != 0xff && i != end) {
+            if (o == payloadLen)
+                return -5;
+            payload[o++] = 0;
+        }
     }
+    if (o != payloadLen)
+        return -6;
+    return 0;
 }
 
 void DigitalAudioPortRxHandler::encodeCrc(int16_t crc, uint8_t* crc3) {
@@ -106,62 +184,91 @@ int16_t DigitalAudioPortRxHandler::decodeCrc(const uint8_t* crc3) {
     return unpack_int16_le(temp);
 }
 
+bool DigitalAudioPortRxHandler::isValidFlags(uint8_t flags) {
+    if (!(flags & FLAGS_BASE))
+        return false;
+    // An announcement is only the capabilities
+    if (flags & FLAGS_ANNOUNCE)
+        return (flags & (FLAGS_CODEC_MASK | FLAGS_SEQ)) == 0 &&
+            getCaps(flags) != 0;
+    return getCodec(flags) < LINK_CODEC_COUNT;
+}
+
+unsigned DigitalAudioPortRxHandler::payloadSize(uint8_t flags) {
+    if (flags & FLAGS_ANNOUNCE)
+        return 0;
+    const unsigned seqLen = (flags & FLAGS_SEQ) ? SEQ_LEN : 0;
+    const unsigned codec = getCodec(flags);
+    if (codec == LINK_CODEC_ULAW)
+        return 160 + seqLen;
+    else if (codec == LINK_CODEC_GSM)
+        return 33 + seqLen;
+    else
+        return PAYLOAD_SIZE + seqLen;
+}
+
 void DigitalAudioPortRxHandler::encodeMsg(
     const uint8_t* payload, unsigned payloadLen,
-    uint8_t* msg, unsigned msgLen) {
+    uint8_t* msg, unsigned msgLen, uint8_t flags) {
 
-    assert(payloadLen == PAYLOAD_SIZE);
-    assert(msgLen == NETWORK_MESSAGE_SIZE);
+    assert(isValidFlags(flags));
+    assert(payloadLen == payloadSize(flags));
+    assert(msgLen == msgSize(flags));
 
     msg[0] = HEADER_CODE;
     // Flags
-    msg[1] = 0x01;
-    // Payload is encoded using COBS
-    cobs_encode_result re = cobs_encode(msg + 3, NETWORK_MESSAGE_SIZE - 3,
-        payload, PAYLOAD_SIZE);
+    msg[1] = flags;
+    // Payload is encoded using COBS. cobs_encode() rejects a null source 
+    // even when there is nothing to encode (i.e. an announcement).
+    static const uint8_t noPayload[1] = { 0 };
+    if (payloadLen == 0)
+        payload = noPayload;
+    cobs_encode_result re = cobs_encode(msg + 3, msgLen - 3,
+        payload, payloadLen);
     assert(re.status == COBS_ENCODE_OK);
     // This is the case where the COBS overhead is 1
-    if (re.out_len == PAYLOAD_SIZE + 1) {
+    if (re.out_len == payloadLen + 1) {
         // Flag the short COBS case
         msg[2] = 1;
         // Mark the overhead byte that wasn't used
-        msg[3 + PAYLOAD_SIZE + 1] = 0xff;
-    } else if (re.out_len == PAYLOAD_SIZE + 2) {
+        msg[3 + payloadLen + 1] = 0xff;
+    } else if (re.out_len == payloadLen + 2) {
         // Flag the long COBS case
         msg[2] = 2;
     } else {
         assert(false);
     }
     // CRC is everything, including the header
-    int16_t crc = crcSlow(msg, 1 + FLAGS_LEN + PAYLOAD_SIZE + COBS_OVERHEAD);
-    encodeCrc(crc, msg + NETWORK_MESSAGE_SIZE - 3);
+    int16_t crc = linkCrc(msg, 1 + FLAGS_LEN + payloadLen + COBS_OVERHEAD);
+    encodeCrc(crc, msg + msgLen - 3);
 }
 
 int DigitalAudioPortRxHandler::decodeMsg(
     const uint8_t* msg, unsigned msgLen,
     uint8_t* payload, unsigned payloadLen) {    
 
-    assert(msgLen == NETWORK_MESSAGE_SIZE);
-    assert(payloadLen == PAYLOAD_SIZE);
-
     // Header
-    if (msg[0] != HEADER_CODE)
+    if (msgLen < 2 || msg[0] != HEADER_CODE)
         return -1;
+    if (!isValidFlags(msg[1]))
+        return -3;
+    const unsigned size = payloadSize(msg[1]);
+    if (msgLen != msgSize(msg[1]))
+        return -1;
+    assert(payloadLen >= size);
     // CRC is everything, including the header
-    int16_t expectedCrc = crcSlow(msg, 1 + FLAGS_LEN + PAYLOAD_SIZE + COBS_OVERHEAD);
-    int16_t crc = decodeCrc(msg + NETWORK_MESSAGE_SIZE - 3);
+    int16_t expectedCrc = linkCrc(msg, 1 + FLAGS_LEN + size + COBS_OVERHEAD);
+    int16_t crc = decodeCrc(msg + msgLen - 3);
     if (crc != expectedCrc)
         return -2;
-    if (msg[1] != 0x01)
-        return -3;
     unsigned cobsOverhead = msg[2];
     if (!(cobsOverhead == 1 || cobsOverhead == 2))
         return -4;
-    cobs_decode_result rd = cobs_decode(payload, PAYLOAD_SIZE,
-        msg + 3, PAYLOAD_SIZE + cobsOverhead);
+    cobs_decode_result rd = cobs_decode(payload, size,
+        msg + 3, size + cobsOverhead);
     if (rd.status != COBS_DECODE_OK)
         return -5;
-    if (rd.out_len != PAYLOAD_SIZE)
+    if (rd.out_len != size)
         return -6;
     return 0;
 }
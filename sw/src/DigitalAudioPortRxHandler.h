@@ -18,18 +18,68 @@
 #pragma once
 
 #include <cstdint>
-#include <functional>
 
 #define HEADER_CODE (0)
+// Uncompressed PCM audio frame
 #define PAYLOAD_SIZE (160 * 2)
 #define FLAGS_LEN (2)
 #define COBS_OVERHEAD (2)
 // 16-bit CRC with extra to avoid zeros
 #define CRC_LEN (3)
+// The original (PCM16, no sequence number) message
 #define NETWORK_MESSAGE_SIZE (1 + FLAGS_LEN + PAYLOAD_SIZE + COBS_OVERHEAD + CRC_LEN)
+// Optional sequence number at the front of the payload
+#define SEQ_LEN (1)
+// The largest payload/message (PCM16 with a sequence number)
+#define MAX_PAYLOAD_SIZE (PAYLOAD_SIZE + SEQ_LEN)
+#define MAX_NETWORK_MESSAGE_SIZE (NETWORK_MESSAGE_SIZE + SEQ_LEN)
+// An announcement has no payload (COBS still adds a byte)
+#define ANNOUNCE_MESSAGE_SIZE (1 + FLAGS_LEN + COBS_OVERHEAD + CRC_LEN)
+
+// Layout of the flags byte:
+//
+// Bit 0    - Always set so that the byte is never zero. 
+// Bits 1-2 - The encoding of the payload in this message (LinkCodecType)
+// Bit 3    - The payload starts with a one-byte sequence number. This
+//            is only sent to peers that advertise their capabilities 
+//            (bits 4-6), older firmware doesn't understand it.
+// Bits 4-6 - One bit for each encoding that the sender is able to 
+//            receive. Older firmware sends 0x01 here (i.e. no bits), 
+//            which means PCM16 only.
+// Bit 7    - Announcement: a message with no payload that only carries 
+//            the capabilities (bits 4-6). The codec and sequence bits 
+//            are zero.
+//
+// Older firmware only accepts 0x01 in the flags byte, so nothing else is 
+// sent until the peer has advertised its capabilities. Until then each 
+// frame is preceded by an announcement. Older firmware never sees the 
+// announcement because it is much shorter than a full message and the 
+// header of the next message restarts the accumulation.
+//
+#define FLAGS_BASE (0x01)
+#define FLAGS_CODEC_SHIFT (1)
+#define FLAGS_CODEC_MASK (0x06)
+#define FLAGS_SEQ (0x08)
+#define FLAGS_CAPS_SHIFT (4)
+#define FLAGS_CAPS_MASK (0x70)
+#define FLAGS_ANNOUNCE (0x80)
 
 namespace kc1fsz {
 
+/**
+ * Audio encodings that can be carried in a link message. The value is 
+ * what goes in the codec field of the flags byte.
+ */
+enum LinkCodecType {
+    // 160 x 16-bit little-endian PCM (320 bytes), the original format
+    LINK_CODEC_PCM16 = 0,
+    // 160 x G.711 mu-law (160 bytes)
+    LINK_CODEC_ULAW = 1,
+    // One GSM 06.10 full-rate frame (33 bytes)
+    LINK_CODEC_GSM = 2,
+    LINK_CODEC_COUNT = 3
+};
+
 /**
  * Contains the read pointer for the circular receive buffer. The
  * write pointer is external because it is typically being maintained
@@ -47,13 +97,52 @@ public:
 
     /**
      * Processes data in the circular buffer and fires the callback for 
-     * each successfully received/decoded message.
+     * each successfully received/decoded message. All complete messages
+     * that are available are processed (i.e. this catches up after a 
+     * stall).
+     *
+     * The messages are checked and decoded directly out of the circular 
+     * buffer, including the case where a message wraps around the end.
+     *
+     * IMPORTANT: Nothing is copied out of the circular buffer until a 
+     * message is complete, so this needs to be called before the writer
+     * laps the read pointer. With a DMA ring that means once per ring 
+     * time (i.e. 512 bytes at 460,800 baud is about 11ms). The caller 
+     * is expected to know when it has stalled for longer than that 
+     * and pass stalled=true. If the message that was in progress at 
+     * the time of the stall turns out to be bad (or is cut short) it is 
+     * counted as an overrun instead of a bad message. Complete messages 
+     * that were overwritten without being seen at all aren't counted 
+     * here, they show up as gaps in the sequence numbers.
      *
      * @param nextWrPtr The external write pointer, which is typically
      * taken from a DMA controller or something.
+     * @param cb Anything callable as cb(const uint8_t* msg, unsigned msgLen,
+     * uint8_t flags). The msg pointer is only valid during the call. The
+     * payload is still in the encoding given by the flags, and it includes
+     * the sequence number if FLAGS_SEQ is set.
+     * @param stalled true if the writer may have lapped the read pointer
+     * since the last call.
+     * @returns The number of messages delivered to the callback.
      */
-    void processRxBuf(unsigned nextWrPtr,
-        std::function<void(const uint8_t* msg, unsigned msgLen)> cb);
+    template<typename CB> unsigned processRxBuf(unsigned nextWrPtr, CB cb,
+        bool stalled = false) {
+        unsigned count = 0;
+        uint8_t payload[MAX_PAYLOAD_SIZE];
+        int rc;
+        uint8_t flags;
+        // The start of a message that is being accumulated may have been
+        // overwritten
+        if (stalled && _haveHeader)
+            _msgStalled = true;
+        while ((rc = _nextMsg(nextWrPtr, payload, &flags)) != 0) {
+            if (rc > 0) {
+                cb(payload, payloadSize(flags), flags);
+                count++;
+            }
+        }
+        return count;
+    }
 
     /**
      * @returns The number of clean messages received.
@@ -66,6 +155,13 @@ public:
      */
     unsigned getBadCount() const { return _badCount; }
 
+    /**
+     * @returns The number of bad messages discarded after a stall, 
+     * most likely because they were overwritten in the circular buffer
+     * before they could be processed.
+     */
+    unsigned getOverrunCount() const { return _overrunCount; }
+
     /**
      * Turns a 16-bit CRC value into 3-bytes with no zeros.
      */
@@ -76,16 +172,73 @@ public:
      */
     static int16_t decodeCrc(const uint8_t* crc3);
 
+    /**
+     * @returns true if the flags byte is something that we understand.
+     */
+    static bool isValidFlags(uint8_t flags);
+
+    /**
+     * @returns The payload size implied by the codec in the flags byte,
+     * including the sequence number (if any). Announcements have no 
+     * payload.
+     */
+    static unsigned payloadSize(uint8_t flags);
+
+    /**
+     * @returns The complete message size implied by the codec in the 
+     * flags byte (including the header byte).
+     */
+    static unsigned msgSize(uint8_t flags) {
+        return 1 + FLAGS_LEN + payloadSize(flags) + COBS_OVERHEAD + CRC_LEN;
+    }
+
+    /**
+     * @returns The flags byte for a message.
+     * @param caps Bit mask of the encodings that we can receive 
+     * (1 << LinkCodecType).
+     * @param seq true if the payload starts with a sequence number.
+     */
+    static uint8_t makeFlags(unsigned codec, unsigned caps, bool seq = false) {
+        return FLAGS_BASE | ((codec << FLAGS_CODEC_SHIFT) & FLAGS_CODEC_MASK) |
+            ((caps << FLAGS_CAPS_SHIFT) & FLAGS_CAPS_MASK) |
+            (seq ? FLAGS_SEQ : 0);
+    }
+
+    /**
+     * @returns The flags byte for an announcement (no payload).
+     * @param caps Bit mask of the encodings that we can receive 
+     * (1 << LinkCodecType).
+     */
+    static uint8_t makeAnnounceFlags(unsigned caps) {
+        return FLAGS_BASE | FLAGS_ANNOUNCE | 
+            ((caps << FLAGS_CAPS_SHIFT) & FLAGS_CAPS_MASK);
+    }
+
+    static unsigned getCodec(uint8_t flags) { 
+        return (flags & FLAGS_CODEC_MASK) >> FLAGS_CODEC_SHIFT; 
+    }
+
+    static unsigned getCaps(uint8_t flags) { 
+        return (flags & FLAGS_CAPS_MASK) >> FLAGS_CAPS_SHIFT; 
+    }
+
     /**
      * Encodes a payload into a complete message, including the 
      * leading header byte.
+     *
+     * @param payload Can be null if there is no payload (announcement).
+     * @param payloadLen Must match the codec in the flags.
+     * @param msgLen Must be msgSize(flags).
      */
-    static void encodeMsg(const uint8_t* payload, unsigned playloadLen,
-        uint8_t* msg, unsigned msgLen);
+    static void encodeMsg(const uint8_t* payload, unsigned payloadLen,
+        uint8_t* msg, unsigned msgLen, uint8_t flags = FLAGS_BASE);
 
     /**
      * Decodes a message starting with (and including) the leading
      * header byte.
+     * 
+     * @param payloadLen The size of the payload buffer. The actual
+     * payload size is payloadSize(msg[1]).
      * @returns -1 If the message is invalid
      */
     static int decodeMsg(const uint8_t* msg, unsigned msgLen,
@@ -93,19 +246,57 @@ public:
 
 private:
 
-    void _processEncodedMsg(
-        const uint8_t* encodedBuf, unsigned encodedBufLen,
-        std::function<void(const uint8_t* msg, unsigned msgLen)> cb);
+    /**
+     * Advances through the circular buffer until the next complete 
+     * message is found (or the write pointer is reached).
+     *
+     * @param flags The flags byte of a good message is written here.
+     * @returns 1 if a good message was decoded into the payload, -1 if a
+     * bad message was discarded, 0 if there is nothing more to process.
+     */
+    int _nextMsg(unsigned nextWrPtr, uint8_t* payload, uint8_t* flags);
+
+    /**
+     * Drops the message being accumulated and counts it as bad (or as
+     * an overrun if it was in progress during a stall).
+     */
+    void _dropMsg() {
+        if (_msgStalled)
+            _overrunCount++;
+        else 
+            _badCount++;
+        _haveHeader = false;
+        _msgStalled = false;
+    }
+
+    /**
+     * Same as decodeMsg(), but works on a message that is sitting in the 
+     * circular buffer (possibly wrapped).
+     *
+     * @param start Location of the header byte.
+     */
+    int _decodeInPlace(unsigned start, uint8_t* payload) const;
+
+    uint8_t _at(unsigned start, unsigned i) const {
+        return _rxBuf[(start + i) & _rxBufMask];
+    }
 
     uint8_t* const _rxBuf;
     const unsigned _rxBufSize;
     unsigned _nextRdPtr;
     const unsigned _rxBufMask;
     bool _haveHeader = false;
-    uint8_t _completeMsg[NETWORK_MESSAGE_SIZE];
-    unsigned _completeMsgLen = 0;
+    // Location of the header byte of the message being accumulated
+    unsigned _msgStart = 0;
+    // How much of the message (including the header byte) has been seen
+    unsigned _msgLen = 0;
+    // The full size of the message, known once the flags are seen
+    unsigned _msgSize = 0;
+    // The message being accumulated was in progress during a stall
+    bool _msgStalled = false;
     unsigned _rxCount = 0;
     unsigned _badCount = 0;
+    unsigned _overrunCount = 0;
 };
 
 }
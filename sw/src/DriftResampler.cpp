@@ -0,0 +1,136 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include <cassert>
+#include <cmath>
+
+#include "DriftResampler.h"
+
+namespace kc1fsz {
+
+// Time constant of the fill smoothing. This needs to be long compared to
+// the 20ms network frames (the fill is a sawtooth at that rate).
+static const float FILL_TAU_S = 1.0;
+// How long to wait after a restart before the fill reference is taken
+static const float SETTLE_S = 2.0;
+// Loop gains. The buffer moves by FS * 1e-6 samples/second per ppm of 
+// error so these give a natural frequency of about 0.1 rad/s with 
+// damping of ~0.7. That's slow enough that the pitch change is 
+// inaudible and fast enough to pull in a few hundred ppm before the 
+// (small) jitter buffer margin is used up.
+static const float KP = 17.5;
+static const float KI = 1.25;
+
+DriftResampler::DriftResampler(unsigned blockSize)
+:   _blockSize(blockSize) {
+    reset();
+}
+
+void DriftResampler::reset() {
+    _phase = 0;
+    for (unsigned i = 0; i < 4; i++)
+        _h[i] = 0;
+    setPpm(0);
+    restart();
+}
+
+void DriftResampler::restart() {
+    // Drop the proportional part of the correction
+    _apply(_integral);
+    _fill = 0;
+    _ref = 0;
+    _blocks = 0;
+}
+
+void DriftResampler::setPpm(float ppm) {
+    _integral = ppm;
+    _apply(ppm);
+}
+
+void DriftResampler::_apply(float ppm) {
+    if (ppm > MAX_PPM)
+        ppm = MAX_PPM;
+    else if (ppm < -MAX_PPM)
+        ppm = -MAX_PPM;
+    _step = (uint32_t)lroundf((float)PHASE_ONE * (1.0f + ppm * 1e-6f));
+}
+
+// ****************************************************************************
+// NOTE: This function is called once per audio block so keep it short!
+// ****************************************************************************
+void DriftResampler::process(const float* in, unsigned inCount, float* out, 
+    unsigned outCount) {
+
+    const float phaseScale = 1.0f / (float)PHASE_ONE;
+    unsigned k = 0;
+
+    for (unsigned i = 0; i < outCount; i++) {
+        // Catmull-Rom between _h[1] (mu=0) and _h[2] (mu=1)
+        const float mu = (float)_phase * phaseScale;
+        const float a = -0.5f * _h[0] + 1.5f * _h[1] - 1.5f * _h[2] + 0.5f * _h[3];
+        const float b = _h[0] - 2.5f * _h[1] + 2.0f * _h[2] - 0.5f * _h[3];
+        const float c = -0.5f * _h[0] + 0.5f * _h[2];
+        out[i] = ((a * mu + b) * mu + c) * mu + _h[1];
+        // Advance and pull in however many input samples that takes
+        _phase += _step;
+        while (_phase >= PHASE_ONE) {
+            assert(k < inCount);
+            _h[0] = _h[1];
+            _h[1] = _h[2];
+            _h[2] = _h[3];
+            _h[3] = in[k++];
+            _phase -= PHASE_ONE;
+        }
+    }
+
+    assert(k == inCount);
+}
+
+// ****************************************************************************
+// NOTE: This function is called once per audio block so keep it short!
+// ****************************************************************************
+void DriftResampler::steer(unsigned fill) {
+
+    const float dt = (float)_blockSize / (float)FS;
+
+    if (_blocks == 0)
+        _fill = fill;
+    else 
+        _fill += ((float)fill - _fill) * (dt / FILL_TAU_S);
+
+    const unsigned settleBlocks = (unsigned)(SETTLE_S / dt);
+    if (_blocks < settleBlocks) {
+        _blocks++;
+        if (_blocks == settleBlocks)
+            _ref = _fill;
+        return;
+    }
+
+    const float e = _fill - _ref;
+    _integral += KI * e * dt;
+    // Keep the integrator from winding up past the point where the 
+    // output is clamped anyway.
+    if (_integral > MAX_PPM)
+        _integral = MAX_PPM;
+    else if (_integral < -MAX_PPM)
+        _integral = -MAX_PPM;
+    _apply(KP * e + _integral);
+}
+
+}
@@ -0,0 +1,130 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace kc1fsz {
+
+/**
+ * @brief Fractional resampler that absorbs the clock difference between
+ * the far end of the network link and the local I2S clock.
+ *
+ * The audio from the network was sampled on the peer's oscillator and 
+ * is played out on ours, so over a long transmission the receive buffer
+ * slowly fills or empties. The resampler consumes slightly more or 
+ * slightly less than one input sample per output sample and a PI loop
+ * steers the ratio to hold the buffer fill steady.
+ *
+ * The phase is kept in fixed point so that the number of input samples 
+ * needed for a block is known exactly before the block is processed.
+ * Interpolation is 4-point cubic (Catmull-Rom), which is plenty for 
+ * voice given that the ratio never gets far from 1.
+ *
+ * The ratio learned during one talk-spurt is kept for the next one 
+ * since the peer's clock doesn't change. Only the fill reference is
+ * re-learned.
+ *
+ * Only the receive side needs this. Transmit frames are paced by the 
+ * local clock and the peer's receive side takes care of that direction.
+ */
+class DriftResampler {
+public:
+
+    static const unsigned FS = 8000;
+    // Largest correction that will be applied. Crystals are normally 
+    // good to +/-50ppm or so.
+    static constexpr float MAX_PPM = 1000;
+
+    /**
+     * @param blockSize Number of output samples per block. This sets 
+     * the update rate of the control loop.
+     */
+    DriftResampler(unsigned blockSize);
+
+    void reset();
+
+    /**
+     * @returns The number of input samples that will be consumed by 
+     * the next call to process(). This is always within one of 
+     * outCount.
+     */
+    unsigned inputNeeded(unsigned outCount) const {
+        return (unsigned)(((uint64_t)_phase + (uint64_t)_step * outCount) >> PHASE_BITS);
+    }
+
+    /**
+     * @param inCount Must be the value returned by inputNeeded(outCount).
+     */
+    void process(const float* in, unsigned inCount, float* out, unsigned outCount);
+
+    /**
+     * @brief Runs one step of the control loop. Call once per block while
+     * audio is flowing.
+     *
+     * @param fill Current receive buffer fill in samples.
+     */
+    void steer(unsigned fill);
+
+    /**
+     * @brief Call when audio starts flowing again (i.e. a new talk-spurt).
+     * The fill reference is re-learned, the ratio is kept.
+     */
+    void restart();
+
+    /**
+     * @brief Forces the correction (used for testing).
+     * 
+     * @param ppm Positive means the input is running fast, so input 
+     * samples are consumed faster than output samples are produced.
+     */
+    void setPpm(float ppm);
+
+    /**
+     * @returns The current estimate of the peer's clock offset (i.e. the
+     * long-term part of the correction).
+     */
+    float getPpm() const { return _integral; }
+
+private:
+
+    void _apply(float ppm);
+
+    static const unsigned PHASE_BITS = 24;
+    static const uint32_t PHASE_ONE = 1 << PHASE_BITS;
+
+    const unsigned _blockSize;
+
+    // Fractional position between _h[1] and _h[2]
+    uint32_t _phase;
+    uint32_t _step;
+    // Last four input samples, oldest first
+    float _h[4];
+
+    float _integral;
+    // Smoothed buffer fill
+    float _fill;
+    // The fill being held, learned shortly after each restart
+    float _ref;
+    // Blocks since the restart
+    unsigned _blocks;
+};
+
+}
@@ -0,0 +1,51 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include "kc1fsz-tools/BinaryWrapper.h"
+
+#include "Gpio.h"
+
+namespace kc1fsz {
+
+/**
+ * @brief Wraps an input pin so that it can be debounced, etc. The 
+ * logic can be flipped to deal with active-low signals.
+ */
+class GpioInput : public BinaryWrapper {
+public:
+
+    GpioInput(Gpio& gpio, unsigned pin, bool activeLow = false)
+    :   _gpio(gpio),
+        _pin(pin),
+        _activeLow(activeLow) { }
+
+    bool get() const { return _gpio.get(_pin) != _activeLow; }
+
+    void setActiveLow(bool b) { _activeLow = b; }
+
+private:
+
+    Gpio& _gpio;
+    const unsigned _pin;
+    bool _activeLow;
+};
+
+}
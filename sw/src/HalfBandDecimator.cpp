@@ -0,0 +1,110 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include "HalfBandDecimator.h"
+
+#include <cstring>
+#include <cassert>
+
+namespace kc1fsz {
+
+void HalfBandDecimator::init(const float* coeffs, unsigned numTaps, float* state,
+    unsigned blockSize) {
+
+    assert(numTaps % 4 == 1);
+    assert(blockSize % 4 == 0);
+
+    _numTaps = numTaps;
+    _blockSize = blockSize;
+    _c = (numTaps - 1) / 2;
+    _center = coeffs[_c];
+
+    // Pull out the non-zero taps on one side of the center
+    _sideTapCount = 0;
+    for (unsigned k = 1; k <= _c; k += 2) {
+        assert(_sideTapCount < MAX_SIDE_TAPS);
+        // Sanity check on the half-band/symmetry assumptions
+        assert(coeffs[_c + k] == coeffs[_c - k]);
+        assert(coeffs[_c + k - 1] == 0 || k == 1);
+        _sideTaps[_sideTapCount++] = coeffs[_c + k];
+    }
+
+    _state1 = state;
+    _state2 = state + (numTaps - 1 + blockSize);
+    reset();
+}
+
+void HalfBandDecimator::reset() {
+    memset(_state1, 0, (_numTaps - 1) * sizeof(float));
+    memset(_state2, 0, (_numTaps - 1) * sizeof(float));
+}
+
+/**
+ * Computes one output of a half-band stage. The window points to the
+ * oldest of the numTaps samples that contribute.
+ *
+ * @param hp The complementary (high-band) output is written here.
+ */
+static inline float halfBand(const float* window, unsigned c, float center,
+    const float* sideTaps, unsigned sideTapCount, float* hp) {
+    const float* pc = window + c;
+    float a = center * pc[0];
+    for (unsigned i = 0, k = 1; i < sideTapCount; i++, k += 2)
+        a += sideTaps[i] * (pc[-(int)k] + pc[k]);
+    *hp = pc[0] - a;
+    return a;
+}
+
+void HalfBandDecimator::process(const float* in, float* out) {
+
+    const unsigned h = _numTaps - 1;
+    // New samples go on the right, after the history
+    memcpy(_state1 + h, in, _blockSize * sizeof(float));
+
+    // Energy in the high-band (removed) part of each stage
+    float e1 = 0, e2 = 0;
+    float hp;
+
+    for (unsigned m = 0; m < _blockSize / 4; m++) {
+        // Two outputs from the first stage (2:1) go into the second
+        // stage history. As with CMSIS, the newest input sample used
+        // for output j is in[2j + 1].
+        const unsigned j = 2 * m;
+        _state2[h + j] = halfBand(_state1 + 2 * j + 1, _c, _center,
+            _sideTaps, _sideTapCount, &hp);
+        e1 += hp * hp;
+        _state2[h + j + 1] = halfBand(_state1 + 2 * (j + 1) + 1, _c, _center,
+            _sideTaps, _sideTapCount, &hp);
+        e1 += hp * hp;
+        // Then one output from the second stage (2:1)
+        out[m] = halfBand(_state2 + 2 * m + 1, _c, _center,
+            _sideTaps, _sideTapCount, &hp);
+        e2 += hp * hp;
+    }
+
+    // The high-band outputs are decimated, but that doesn't change the
+    // average power.
+    _highBandPower = e1 / (float)(_blockSize / 2) + e2 / (float)(_blockSize / 4);
+
+    // Shift the most recent samples into the history area for next time
+    memmove(_state1, _state1 + _blockSize, h * sizeof(float));
+    memmove(_state2, _state2 + _blockSize / 2, h * sizeof(float));
+}
+
+}
@@ -0,0 +1,106 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace kc1fsz {
+
+/**
+ * @brief A 4:1 decimator built from two identical half-band LPF stages
+ * (32k->16k->8k) that are computed together in a single pass.
+ *
+ * A half-band filter has a center tap of 0.5 and every other tap is
+ * exactly zero. The remaining taps are symmetric around the center.
+ * So each output point of a stage is computed as:
+ *
+ *   y = h[c] * x[c] + sum( h[c+k] * (x[c-k] + x[c+k]) ) for k = 1, 3, 5, ...
+ *
+ * For the 41-tap filter this is 11 multiplies per output instead of 41,
+ * and (as with any decimator) only the outputs that survive are
+ * computed.
+ *
+ * The input/output alignment matches arm_fir_decimate_f32() so this
+ * can be dropped in as a replacement for two cascaded calls.
+ *
+ * The complement of a half-band LPF (delta - h) is a half-band HPF, and
+ * its output is just the center sample minus the LPF output. So the 
+ * energy in the part of the spectrum that is being removed by each stage
+ * comes almost for free. Added together, the two stages give the 
+ * energy between fs/8 and fs/2 (4k-16k when running at 32k), which is 
+ * what the noise squelch needs.
+ */
+class HalfBandDecimator {
+public:
+
+    /**
+     * @returns The number of floats needed for the state buffer.
+     */
+    static constexpr unsigned stateSize(unsigned numTaps, unsigned blockSize) {
+        return (numTaps - 1 + blockSize) + (numTaps - 1 + blockSize / 2);
+    }
+
+    /**
+     * @param coeffs The half-band prototype. Since the filter is symmetric
+     * it doesn't matter whether this is in normal or CMSIS (reversed) order.
+     * Must have (4 * n) + 1 taps.
+     * @param state Must have stateSize() floats.
+     * @param blockSize Number of input samples per call. Must be a
+     * multiple of 4.
+     */
+    void init(const float* coeffs, unsigned numTaps, float* state,
+        unsigned blockSize);
+
+    /**
+     * @param in blockSize samples at the high rate.
+     * @param out blockSize / 4 samples at the low rate.
+     */
+    void process(const float* in, float* out);
+
+    /**
+     * @returns The mean-square of the high-band (complement) signal 
+     * during the last call to process(). This is the sum of the 
+     * power removed by each of the two stages.
+     */
+    float getHighBandPower() const { return _highBandPower; }
+
+    void reset();
+
+private:
+
+    static const unsigned MAX_SIDE_TAPS = 16;
+
+    unsigned _numTaps = 0;
+    unsigned _blockSize = 0;
+    // Center tap (normally 0.5)
+    float _center = 0;
+    // Index of the center tap
+    unsigned _c = 0;
+    // The unique non-zero taps, starting with the one closest to the center
+    float _sideTaps[MAX_SIDE_TAPS];
+    unsigned _sideTapCount = 0;
+    float _highBandPower = 0;
+    // History + new samples for the first stage (32k)
+    float* _state1 = 0;
+    // History + new samples for the second stage (16k)
+    float* _state2 = 0;
+};
+
+}
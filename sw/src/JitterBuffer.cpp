@@ -0,0 +1,292 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include <cassert>
+#include <cstring>
+
+#include "kc1fsz-tools/Common.h"
+
+#include "JitterBuffer.h"
+
+namespace kc1fsz {
+
+static const int32_t FRAME_US = 20 * 1000;
+// Gaps larger than this are pauses between talk-spurts, not jitter
+static const int32_t MAX_JITTER_US = 200 * 1000;
+// How many "jitters" of margin are built into the target depth
+static const float JITTER_MARGIN = 3.0;
+// Leaves room in the slots for frames arriving ahead of time
+static const unsigned MAX_TARGET = (JitterBuffer::SLOT_COUNT / 2) * 
+    JitterBuffer::FRAME_SAMPLES;
+
+JitterBuffer::JitterBuffer(unsigned blockSize) 
+:   _blockSize(blockSize) {
+    reset();
+}
+
+void JitterBuffer::reset() {
+    for (unsigned i = 0; i < SLOT_COUNT; i++)
+        _slots[i].full = false;
+    _playSeq = 0;
+    _haveBase = false;
+    _playing = false;
+    _haveCur = false;
+    _pos = FRAME_SAMPLES;
+    _preroll = 0;
+    _gainStart = 1.0;
+    _gainStep = 0;
+    _concealRun = 0;
+    _stretchFrames = 0;
+    _haveLastArrival = false;
+    _jitterUs = 0;
+    _target = _computeTarget();
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+unsigned JitterBuffer::_countFrames() const {
+    unsigned count = 0;
+    for (unsigned k = 0; k < SLOT_COUNT; k++)
+        if (_isFull(_playSeq + k))
+            count++;
+    return count;
+}
+
+bool JitterBuffer::_rebase() {
+    for (unsigned k = 0; k < SLOT_COUNT; k++) {
+        if (_isFull(_playSeq + k)) {
+            _playSeq += k;
+            return true;
+        }
+    }
+    return false;
+}
+
+unsigned JitterBuffer::_computeTarget() const {
+    // One frame plus one block covers the mismatch between the 20ms 
+    // network frames and the audio blocks, then some margin for jitter.
+    float t = (float)(FRAME_SAMPLES + _blockSize) + 
+        JITTER_MARGIN * _jitterUs * (float)FS / 1000000.0f;
+    const float maxTarget = MAX_TARGET;
+    if (t > maxTarget)
+        t = maxTarget;
+    return (unsigned)t;
+}
+
+void JitterBuffer::_growTarget() {
+    // At least one frame more than what we have now, since that is how 
+    // late the frame was
+    unsigned t = _computeTarget();
+    if (t < _target + FRAME_SAMPLES)
+        t = _target + FRAME_SAMPLES;
+    if (t > MAX_TARGET)
+        t = MAX_TARGET;
+    if (t > _target) {
+        _stretchFrames += (t - _target + FRAME_SAMPLES - 1) / FRAME_SAMPLES;
+        _target = t;
+    }
+}
+
+void JitterBuffer::put(uint8_t seq, const uint8_t* pcm16le, uint32_t nowUs) {
+
+    // Running jitter estimate (same idea as RFC 3550) based on the 
+    // difference between the arrival spacing and the spacing implied 
+    // by the sequence numbers.
+    if (_haveLastArrival) {
+        const int seqDiff = (int8_t)(seq - _lastArrivalSeq);
+        const int32_t d = (int32_t)(nowUs - _lastArrivalUs) - seqDiff * FRAME_US;
+        const int32_t ad = (d < 0) ? -d : d;
+        if (ad < MAX_JITTER_US)
+            _jitterUs += ((float)ad - _jitterUs) / 16.0f;
+    }
+    _haveLastArrival = true;
+    _lastArrivalUs = nowUs;
+    _lastArrivalSeq = seq;
+
+    if (!_haveBase) {
+        _playSeq = seq;
+        _haveBase = true;
+    } else {
+        const int diff = (int8_t)(seq - _playSeq);
+        if (diff < 0 && _playing) {
+            _stats.late++;
+            _growTarget();
+            return;
+        }
+        else if (diff < 0 && -diff < (int)SLOT_COUNT) {
+            // Not started yet and an earlier frame showed up out of order
+            _playSeq = seq;
+        } 
+        else if (diff < 0 || diff >= (int)SLOT_COUNT) {
+            if (_playing) {
+                _stats.overruns++;
+                return;
+            }
+            // Nothing playing, so just start over from this frame. This 
+            // also covers the sequence numbers jumping backwards (i.e. 
+            // the peer restarted).
+            for (unsigned i = 0; i < SLOT_COUNT; i++)
+                _slots[i].full = false;
+            _playSeq = seq;
+        }
+    }
+
+    Slot& s = _slot(seq);
+    // Ignore duplicates
+    if (s.full && s.seq == seq)
+        return;
+    s.full = true;
+    s.seq = seq;
+    for (unsigned i = 0; i < FRAME_SAMPLES; i++)
+        s.pcm[i] = unpack_int16_le(pcm16le + i * 2);
+    _stats.frames++;
+
+    // If a burst has made the buffer too deep then drop frames to 
+    // pull the delay back in.
+    if (_playing) {
+        const unsigned limit = _target + 2 * FRAME_SAMPLES;
+        while (_countFrames() > 1 && 
+            (FRAME_SAMPLES - _pos) + _preroll + _countFrames() * FRAME_SAMPLES > limit) {
+            Slot& d = _slot(_playSeq);
+            if (d.full && d.seq == _playSeq) {
+                d.full = false;
+                _stats.overruns++;
+            }
+            _playSeq++;
+        }
+    }
+}
+
+void JitterBuffer::_loadNext() {
+
+    const float prevGainEnd = _gainStart + _gainStep * (float)FRAME_SAMPLES;
+    Slot& s = _slot(_playSeq);
+
+    if (_stretchFrames && _haveCur && _concealRun < MAX_CONCEAL_FRAMES) {
+        // Repeat the last frame to add delay, the frame that was due 
+        // stays where it is. 
+        _stretchFrames--;
+        _concealRun++;
+        _stats.concealed++;
+        _gainStart = prevGainEnd;
+        const float gainEnd = 1.0f - (float)_concealRun / (float)MAX_CONCEAL_FRAMES;
+        _gainStep = (gainEnd - _gainStart) / (float)FRAME_SAMPLES;
+        _pos = 0;
+        return;
+    }
+    else if (s.full && s.seq == _playSeq) {
+        memcpy(_cur, s.pcm, sizeof(_cur));
+        s.full = false;
+        _haveCur = true;
+        // Fade back in if coming out of concealment
+        _gainStart = (_concealRun > 0) ? prevGainEnd : 1.0f;
+        _gainStep = (1.0f - _gainStart) / (float)FRAME_SAMPLES;
+        _concealRun = 0;
+    }
+    else if (_haveCur && _concealRun < MAX_CONCEAL_FRAMES) {
+        // Repeat the last frame, fading out so that the last repeat 
+        // ends in silence.
+        _concealRun++;
+        _stats.concealed++;
+        _gainStart = prevGainEnd;
+        const float gainEnd = 1.0f - (float)_concealRun / (float)MAX_CONCEAL_FRAMES;
+        _gainStep = (gainEnd - _gainStart) / (float)FRAME_SAMPLES;
+    }
+    else {
+        // Nothing left to play. This is also how a talk-spurt ends 
+        // normally.
+        _stats.underruns++;
+        _playing = false;
+        _haveCur = false;
+        _concealRun = 0;
+        return;
+    }
+
+    _playSeq++;
+    _pos = 0;
+}
+
+// ****************************************************************************
+// NOTE: This function is called once per audio block so keep it short!
+// ****************************************************************************
+void JitterBuffer::get(float* out, unsigned count) {
+
+    unsigned i = 0;
+
+    if (!_playing) {
+        // Start a new talk-spurt as soon as there is something to play,
+        // with silence in front to bring the delay up to the target.
+        if (_haveBase && _rebase()) {
+            _playing = true;
+            _target = _computeTarget();
+            // If a backlog built up while stopped (i.e. a burst after a
+            // stall) then skip the oldest audio.
+            while (_countFrames() > 1 &&
+                _countFrames() * FRAME_SAMPLES > _target + FRAME_SAMPLES) {
+                _slot(_playSeq).full = false;
+                _stats.overruns++;
+                _rebase();
+            }
+            const unsigned have = _countFrames() * FRAME_SAMPLES;
+            _preroll = (_target > have) ? _target - have : 0;
+            _pos = FRAME_SAMPLES;
+            _haveCur = false;
+            _concealRun = 0;
+            _stretchFrames = 0;
+        } else {
+            for (; i < count; i++)
+                out[i] = 0;
+            return;
+        }
+    }
+
+    while (i < count) {
+        if (_preroll) {
+            out[i++] = 0;
+            _preroll--;
+            continue;
+        }
+        if (_pos == FRAME_SAMPLES) {
+            _loadNext();
+            if (!_playing) {
+                for (; i < count; i++)
+                    out[i] = 0;
+                return;
+            }
+        }
+        const float g = _gainStart + _gainStep * (float)_pos;
+        out[i++] = g * (float)_cur[_pos] / 32767.0f;
+        _pos++;
+    }
+}
+
+unsigned JitterBuffer::getDepth() const {
+    unsigned depth = _countFrames() * FRAME_SAMPLES;
+    if (_playing)
+        depth += (FRAME_SAMPLES - _pos) + _preroll;
+    return depth;
+}
+
+void JitterBuffer::getStats(Stats* stats) const {
+    *stats = _stats;
+    stats->depth = getDepth();
+    stats->target = _target;
+    stats->jitterUs = _jitterUs;
+}
+
+}
@@ -0,0 +1,172 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace kc1fsz {
+
+/**
+ * @brief Receive-side jitter buffer for the 20ms network audio frames.
+ *
+ * Frames are stored in slots according to their sequence number so 
+ * that re-ordered frames end up in the right place and missing frames 
+ * can be detected. The audio side pulls fixed-size blocks.
+ *
+ * The playout delay (target depth) is chosen at the start of each 
+ * talk-spurt from a running estimate of the arrival jitter. If a frame 
+ * arrives too late to be played the target is raised right away and the 
+ * extra delay is built up by inserting concealment frames. Shrinking the
+ * target waits for the next talk-spurt. If the buffer gets too deep 
+ * while playing (e.g. after a burst) a frame is dropped to pull the 
+ * delay back in. 
+ *
+ * Missing frames are concealed by repeating the last good frame with a 
+ * fade. After MAX_CONCEAL_FRAMES missing frames in a row the buffer 
+ * gives up (underrun) and waits for the next frame to arrive.
+ *
+ * put() and get() are not safe to call concurrently. In this application
+ * put() is called from core0 at a point where the audio processing on 
+ * core1 is known to be idle.
+ */
+class JitterBuffer {
+public:
+
+    static const unsigned FRAME_SAMPLES = 160;
+    static const unsigned SLOT_COUNT = 16;
+    static const unsigned MAX_CONCEAL_FRAMES = 3;
+    static const unsigned FS = 8000;
+
+    struct Stats {
+        // Frames accepted into the buffer
+        uint32_t frames;
+        // Times that playout stopped because there was nothing to play
+        uint32_t underruns;
+        // Frames thrown away because the buffer was too deep/full
+        uint32_t overruns;
+        // Frames that arrived after their time slot had been played
+        uint32_t late;
+        // Frames that were filled in by concealment (including the ones
+        // inserted to increase the delay)
+        uint32_t concealed;
+        // Current depth (samples waiting to be played, including the 
+        // remainder of the current frame)
+        uint32_t depth;
+        // The target depth (samples) for the current talk-spurt
+        uint32_t target;
+        // Arrival jitter estimate in microseconds
+        uint32_t jitterUs;
+    };
+
+    /**
+     * @param blockSize The number of samples pulled in each get() call.
+     */
+    JitterBuffer(unsigned blockSize);
+
+    void reset();
+
+    /**
+     * Stores a received frame.
+     *
+     * @param seq The sequence number of the frame (wraps).
+     * @param pcm16le 160 samples of 16-bit little-endian PCM.
+     * @param nowUs Arrival time, used for the jitter estimate.
+     */
+    void put(uint8_t seq, const uint8_t* pcm16le, uint32_t nowUs);
+
+    /**
+     * Pulls one block of audio (blockSize samples, scaled to +/-1.0). 
+     * Silence is produced when there is nothing to play.
+     */
+    void get(float* out) { get(out, _blockSize); }
+
+    /**
+     * Same as above but for an arbitrary number of samples. Used when 
+     * the audio goes through a resampler and the number of samples 
+     * needed changes slightly from block to block.
+     */
+    void get(float* out, unsigned count);
+
+    bool isPlaying() const { return _playing; }
+
+    /**
+     * @returns The number of samples waiting to be played (including
+     * the remainder of the current frame).
+     */
+    unsigned getDepth() const;
+
+    void getStats(Stats* stats) const;
+
+private:
+
+    struct Slot {
+        bool full = false;
+        uint8_t seq = 0;
+        int16_t pcm[FRAME_SAMPLES];
+    };
+
+    Slot& _slot(uint8_t seq) { return _slots[seq % SLOT_COUNT]; }
+    bool _isFull(uint8_t seq) const { 
+        const Slot& s = _slots[seq % SLOT_COUNT];
+        return s.full && s.seq == seq;
+    }
+    // Number of frames in the buffer that haven't been played
+    unsigned _countFrames() const;
+    // Moves the play position to the oldest frame in the buffer
+    bool _rebase();
+    // Sets up the next frame (real or concealed) for playout
+    void _loadNext();
+    unsigned _computeTarget() const;
+    // Raises the target in the middle of a talk-spurt
+    void _growTarget();
+
+    const unsigned _blockSize;
+    Slot _slots[SLOT_COUNT];
+
+    // The sequence number of the next frame to be played
+    uint8_t _playSeq = 0;
+    bool _haveBase = false;
+    bool _playing = false;
+
+    // The frame being played and the position in it
+    int16_t _cur[FRAME_SAMPLES];
+    bool _haveCur = false;
+    unsigned _pos = FRAME_SAMPLES;
+    // Silence inserted at the start of a talk-spurt to reach the target 
+    unsigned _preroll = 0;
+    // Gain ramp across the current frame (used for concealment)
+    float _gainStart = 1.0;
+    float _gainStep = 0;
+    unsigned _concealRun = 0;
+    // Concealment frames still to be inserted to reach a raised target
+    unsigned _stretchFrames = 0;
+
+    // Jitter estimation
+    bool _haveLastArrival = false;
+    uint32_t _lastArrivalUs = 0;
+    uint8_t _lastArrivalSeq = 0;
+    float _jitterUs = 0;
+
+    unsigned _target;
+
+    Stats _stats;
+};
+
+}
@@ -0,0 +1,121 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include <cassert>
+#include <cstring>
+
+#include "kc1fsz-tools/Common.h"
+
+#include "gsm-0610-codec/Parameters.h"
+
+#include "LinkCodec.h"
+
+namespace kc1fsz {
+
+static const unsigned GSM_FRAME_SIZE = 33;
+static_assert(PAYLOAD_SIZE == LinkCodec::FRAME_SAMPLES * 2);
+
+// G.711 mu-law constants
+static const int ULAW_BIAS = 0x84;
+static const int ULAW_CLIP = 32635;
+
+struct UlawTable {
+    int16_t v[256];
+    constexpr UlawTable() : v() {
+        for (unsigned i = 0; i < 256; i++) {
+            const unsigned u = ~i & 0xff;
+            const int exponent = (u >> 4) & 0x07;
+            const int mantissa = u & 0x0f;
+            const int mag = (((mantissa << 3) + ULAW_BIAS) << exponent) - ULAW_BIAS;
+            v[i] = (u & 0x80) ? -mag : mag;
+        }
+    }
+};
+
+// The decode side is a straight lookup
+static constexpr UlawTable ULAW_TABLE;
+
+uint8_t LinkCodec::linearToUlaw(int16_t pcm) {
+    int s = pcm;
+    uint8_t sign = 0;
+    if (s < 0) {
+        s = -s;
+        sign = 0x80;
+    }
+    if (s > ULAW_CLIP)
+        s = ULAW_CLIP;
+    s += ULAW_BIAS;
+    // Find the segment (position of the leading one above bit 7)
+    int exponent = 7;
+    for (int mask = 0x4000; (s & mask) == 0 && exponent > 0; mask >>= 1)
+        exponent--;
+    const int mantissa = (s >> (exponent + 3)) & 0x0f;
+    return ~(sign | (exponent << 4) | mantissa) & 0xff;
+}
+
+int16_t LinkCodec::ulawToLinear(uint8_t u) {
+    return ULAW_TABLE.v[u];
+}
+
+unsigned LinkCodec::encode(unsigned codec, const uint8_t* pcm16le, uint8_t* out) {
+    if (codec == LINK_CODEC_ULAW) {
+        for (unsigned i = 0; i < FRAME_SAMPLES; i++)
+            out[i] = linearToUlaw(unpack_int16_le(pcm16le + i * 2));
+        return FRAME_SAMPLES;
+    }
+    else if (codec == LINK_CODEC_GSM) {
+        int16_t pcm[FRAME_SAMPLES];
+        for (unsigned i = 0; i < FRAME_SAMPLES; i++)
+            pcm[i] = unpack_int16_le(pcm16le + i * 2);
+        Parameters params;
+        _gsmEncoder.encode(pcm, &params);
+        params.pack(out);
+        return GSM_FRAME_SIZE;
+    }
+    else {
+        memcpy(out, pcm16le, FRAME_SAMPLES * 2);
+        return FRAME_SAMPLES * 2;
+    }
+}
+
+bool LinkCodec::decode(unsigned codec, const uint8_t* in, unsigned inLen, 
+    uint8_t* pcm16le) {
+    if (codec >= LINK_CODEC_COUNT || 
+        inLen != DigitalAudioPortRxHandler::payloadSize(
+            DigitalAudioPortRxHandler::makeFlags(codec, 0)))
+        return false;
+    if (codec == LINK_CODEC_ULAW) {
+        for (unsigned i = 0; i < FRAME_SAMPLES; i++)
+            pack_int16_le(ULAW_TABLE.v[in[i]], pcm16le + i * 2);
+    }
+    else if (codec == LINK_CODEC_GSM) {
+        Parameters params;
+        params.unpack(in);
+        int16_t pcm[FRAME_SAMPLES];
+        _gsmDecoder.decode(&params, pcm);
+        for (unsigned i = 0; i < FRAME_SAMPLES; i++)
+            pack_int16_le(pcm[i], pcm16le + i * 2);
+    }
+    else {
+        memcpy(pcm16le, in, FRAME_SAMPLES * 2);
+    }
+    return true;
+}
+
+}
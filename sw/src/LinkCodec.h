@@ -0,0 +1,77 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cstdint>
+
+#include "gsm-0610-codec/Encoder.h"
+#include "gsm-0610-codec/Decoder.h"
+
+#include "DigitalAudioPortRxHandler.h"
+
+namespace kc1fsz {
+
+/**
+ * Converts between the 20ms PCM frames that are exchanged with the 
+ * DigitalAudioPort and the encoded payload that goes on the link. 
+ *
+ * GSM is stateful so there should be one of these for each direction 
+ * of each link.
+ */
+class LinkCodec {
+public:
+
+    static const unsigned FRAME_SAMPLES = 160;
+
+    /**
+     * @param codec One of the LinkCodecType values.
+     * @param pcm16le 160 samples of 8k PCM, 16-bit little-endian.
+     * @param out Must have room for PAYLOAD_SIZE bytes.
+     * @returns The number of bytes written.
+     */
+    unsigned encode(unsigned codec, const uint8_t* pcm16le, uint8_t* out);
+
+    /**
+     * @param codec One of the LinkCodecType values.
+     * @param pcm16le 160 samples of 8k PCM are written here, 16-bit 
+     * little-endian.
+     * @returns false if the payload is not valid for the codec.
+     */
+    bool decode(unsigned codec, const uint8_t* in, unsigned inLen, 
+        uint8_t* pcm16le);
+
+    /**
+     * @returns A bit mask of the codecs that can be decoded
+     * (1 << LinkCodecType), as advertised in the flags byte.
+     */
+    static unsigned getCaps() { 
+        return (1 << LINK_CODEC_PCM16) | (1 << LINK_CODEC_ULAW) | (1 << LINK_CODEC_GSM);
+    }
+
+    static uint8_t linearToUlaw(int16_t pcm);
+    static int16_t ulawToLinear(uint8_t u);
+
+private:
+
+    Encoder _gsmEncoder;
+    Decoder _gsmDecoder;
+};
+
+}
@@ -0,0 +1,61 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include <cassert>
+#include "LinkCrc.h"
+
+namespace kc1fsz {
+
+static constexpr uint16_t POLYNOMIAL = 0x1021;
+
+struct CrcTable {
+    uint16_t v[256];
+    constexpr CrcTable() : v() {
+        for (unsigned d = 0; d < 256; d++) {
+            uint16_t r = d << 8;
+            for (unsigned b = 0; b < 8; b++) 
+                r = (r & 0x8000) ? (r << 1) ^ POLYNOMIAL : (r << 1);
+            v[d] = r;
+        }
+    }
+};
+
+// Built at compile time. 512 bytes, ends up in RAM on the Pico 
+// build (copy_to_ram) so there are no flash cache misses.
+static constexpr CrcTable TABLE;
+
+static constexpr uint16_t tableCrc(uint16_t r, const uint8_t* data, unsigned len) {
+    for (unsigned i = 0; i < len; i++)
+        r = (r << 8) ^ TABLE.v[(r >> 8) ^ data[i]];
+    return r;
+}
+
+// Standard CRC-CCITT check value
+static constexpr uint8_t CHECK_DATA[9] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+static_assert(tableCrc(LINK_CRC_INITIAL, CHECK_DATA, 9) == 0x29b1);
+
+uint16_t linkCrc(const uint8_t* data, unsigned len) {
+    return tableCrc(LINK_CRC_INITIAL, data, len);
+}
+
+uint16_t linkCrcUpdate(uint16_t crc, const uint8_t* data, unsigned len) {
+    return tableCrc(crc, data, len);
+}
+
+}
@@ -0,0 +1,51 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace kc1fsz {
+
+/**
+ * @brief Table-driven CRC used on the digital audio link.
+ *
+ * This produces exactly the same result as crcSlow() (CRC-CCITT: 
+ * polynomial 0x1021, initial remainder 0xffff, no reflection, no 
+ * final XOR) so the wire format is unchanged. One table lookup per 
+ * byte instead of eight shift/test steps.
+ *
+ * See crc-bench-1 for the host comparison against crcSlow().
+ */
+uint16_t linkCrc(const uint8_t* data, unsigned len);
+
+/**
+ * The starting value for linkCrcUpdate().
+ */
+static const uint16_t LINK_CRC_INITIAL = 0xffff;
+
+/**
+ * Continues a CRC across a discontinuous buffer (i.e. a message that 
+ * wraps around the end of a circular buffer). Start with 
+ * LINK_CRC_INITIAL, the final result is the same as linkCrc() over
+ * all of the pieces.
+ */
+uint16_t linkCrcUpdate(uint16_t crc, const uint8_t* data, unsigned len);
+
+}
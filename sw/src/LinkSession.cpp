@@ -0,0 +1,90 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include <cassert>
+#include <cstring>
+
+#include "LinkSession.h"
+
+namespace kc1fsz {
+
+LinkSession::LinkSession(uint8_t* rxBuf, unsigned rxBufSize)
+:   _rxBufHandler(rxBuf, rxBufSize) {
+}
+
+void LinkSession::processRx(unsigned rxWrPtr, bool stalled) {
+    _rxBufHandler.processRxBuf(
+        rxWrPtr,
+        // This callback is fired for each **complete** message pulled from the 
+        // circular buffer. The header byte/CRC are NOT included.
+        [this](const uint8_t* decodedBuf, unsigned decodedLen, uint8_t flags) {
+            const unsigned caps = DigitalAudioPortRxHandler::getCaps(flags);
+            if (flags & FLAGS_ANNOUNCE) {
+                _peerIsLegacy = false;
+                _peerCaps = caps | (1 << LINK_CODEC_PCM16);
+                _peerAnnounced = true;
+                return;
+            }
+            // Older firmware doesn't advertise anything. Frames without 
+            // capabilities that follow an announcement are from a peer 
+            // that hasn't heard from us yet.
+            if (caps != 0 || !_peerAnnounced) {
+                _peerIsLegacy = (caps == 0);
+                _peerCaps = caps | (1 << LINK_CODEC_PCM16);
+            }
+            _peerAnnounced = false;
+            Frame f;
+            if (flags & FLAGS_SEQ) {
+                f.seq = decodedBuf[0];
+                decodedBuf += SEQ_LEN;
+                decodedLen -= SEQ_LEN;
+            } else {
+                // Assume that nothing was lost or re-ordered
+                f.seq = _rxLegacySeq++;
+            }
+            if (!_rxCodec.decode(DigitalAudioPortRxHandler::getCodec(flags), 
+                decodedBuf, decodedLen, f.pcm)) {
+                _rxCodecErrors++;
+                return;
+            }
+            if (!_rxFrames.push(f))
+                _rxFrameOverflow++;
+        },
+        stalled
+    );
+}
+
+// ****************************************************************************
+// NOTE: This function is called from inside of the audio frame ISR so keep it 
+// short!
+// ****************************************************************************
+void LinkSession::send(const uint8_t* pcm16le, unsigned len) {
+    assert(len == PAYLOAD_SIZE);
+    Frame f;
+    memcpy(f.pcm, pcm16le, PAYLOAD_SIZE);
+    if (!_txFrames.push(f))
+        _txFrameOverflow++;
+}
+
+void LinkSession::setCodec(unsigned codec) {
+    if (codec < LINK_CODEC_COUNT)
+        _preferredCodec = codec;
+}
+
+}
@@ -0,0 +1,194 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cstdint>
+
+#include "DigitalAudioPortRxHandler.h"
+#include "LinkCodec.h"
+#include "SpscRing.h"
+
+namespace kc1fsz {
+
+/**
+ * @brief The hardware-independent part of the network link: codec 
+ * negotiation, sequence numbers, and the queues of decoded audio frames 
+ * that are passed between the link processing and the audio interrupt.
+ *
+ * The UART backend owns the circular receive buffer and the transmit 
+ * side of the UART. From the link processing context (the low priority
+ * link interrupt on the Pico) it calls processRx() with the current 
+ * receive write pointer and then processTx() to get the messages that 
+ * need to be sent. The audio interrupt only calls receive() and send().
+ */
+class LinkSession {
+public:
+
+    struct Frame {
+        uint8_t seq;
+        uint8_t pcm[PAYLOAD_SIZE];
+    };
+
+    /**
+     * @param rxBuf Circular receive buffer, typically filled by DMA.
+     * @param rxBufSize Must be a power of two.
+     */
+    LinkSession(uint8_t* rxBuf, unsigned rxBufSize);
+
+    // ----- Link Processing Side ----------------------------------------------
+
+    /**
+     * @brief Decodes all of the complete messages in the receive buffer 
+     * and queues the audio for the audio interrupt.
+     *
+     * @param rxWrPtr Where the next received byte will be written.
+     * @param stalled true if it has been long enough since the last call
+     * that the receive buffer may have been lapped (see 
+     * DigitalAudioPortRxHandler::processRxBuf()).
+     */
+    void processRx(unsigned rxWrPtr, bool stalled = false);
+
+    /**
+     * @brief Encodes everything that the audio interrupt has queued 
+     * for transmission. 
+     *
+     * @param queue Anything callable as int queue(const uint8_t* msg, 
+     * unsigned msgLen), returning 0 if the complete message was accepted.
+     */
+    template<typename Q> void processTx(Q queue) {
+        // Until the peer has advertised its capabilities it gets exactly
+        // what older firmware sends (0x01), along with an announcement.
+        const unsigned codec = _peerIsLegacy ? LINK_CODEC_PCM16 : _txCodecInUse();
+        const bool useSeq = !_peerIsLegacy;
+        const uint8_t flags = _peerIsLegacy ? FLAGS_BASE : 
+            DigitalAudioPortRxHandler::makeFlags(codec, LinkCodec::getCaps(), 
+                useSeq);
+        const unsigned msgSize = DigitalAudioPortRxHandler::msgSize(flags);
+        uint8_t ann[ANNOUNCE_MESSAGE_SIZE];
+        if (_peerIsLegacy)
+            DigitalAudioPortRxHandler::encodeMsg(0, 0, ann, ANNOUNCE_MESSAGE_SIZE,
+                DigitalAudioPortRxHandler::makeAnnounceFlags(LinkCodec::getCaps()));
+        const Frame* f;
+        while ((f = _txFrames.front()) != 0) {
+            if (_peerIsLegacy && queue(ann, ANNOUNCE_MESSAGE_SIZE) != 0)
+                _txMsgOverflow++;
+            uint8_t payload[MAX_PAYLOAD_SIZE];
+            unsigned payloadLen = 0;
+            if (useSeq)
+                payload[payloadLen++] = _txSeq;
+            _txSeq++;
+            // Compress (if needed)
+            payloadLen += _txCodec.encode(codec, f->pcm, payload + payloadLen);
+            _txFrames.pop();
+            // Encode the message in COBS format
+            uint8_t msg[MAX_NETWORK_MESSAGE_SIZE];
+            DigitalAudioPortRxHandler::encodeMsg(payload, payloadLen,
+                msg, msgSize, flags);
+            // Ship out
+            if (queue(msg, msgSize) != 0)
+                _txMsgOverflow++;
+        }
+    }
+
+    // ----- Audio Interrupt Side ----------------------------------------------
+
+    /**
+     * @brief Hands over all of the decoded frames.
+     *
+     * @param cb Anything callable as cb(uint8_t seq, const uint8_t* pcm16le,
+     * unsigned len).
+     */
+    template<typename CB> void receive(CB cb) {
+        const Frame* f;
+        while ((f = _rxFrames.front()) != 0) {
+            cb(f->seq, f->pcm, PAYLOAD_SIZE);
+            _rxFrames.pop();
+        }
+    }
+
+    /**
+     * @brief Queues a frame for transmission. The encoding happens later
+     * in processTx().
+     *
+     * @param len Must be PAYLOAD_SIZE.
+     */
+    void send(const uint8_t* pcm16le, unsigned len);
+
+    // ----- Settings/Diagnostics ----------------------------------------------
+
+    /**
+     * @brief Sets the preferred encoding for the audio that is sent (see 
+     * LinkCodecType). It is only used once the peer has advertised that 
+     * it can receive it.
+     */
+    void setCodec(unsigned codec);
+
+    unsigned getRxFrameOverflow() const { return _rxFrameOverflow; }
+    unsigned getTxFrameOverflow() const { return _txFrameOverflow; }
+    unsigned getTxMsgOverflow() const { return _txMsgOverflow; }
+    unsigned getRxCodecErrors() const { return _rxCodecErrors; }
+    unsigned getRxOverruns() const { return _rxBufHandler.getOverrunCount(); }
+
+private:
+
+    unsigned _txCodecInUse() const {
+        return (_peerCaps & (1 << _preferredCodec)) ? 
+            _preferredCodec : LINK_CODEC_PCM16;
+    }
+
+    DigitalAudioPortRxHandler _rxBufHandler;
+
+    // Decoded frames from the network, waiting for the audio interrupt
+    // (link processing -> audio ISR)
+    SpscRing<Frame, 4> _rxFrames;
+    // Frames from the audio interrupt, waiting to be encoded and sent
+    // (audio ISR -> link processing)
+    SpscRing<Frame, 4> _txFrames;
+
+    // Frames are sent using the preferred codec only if the peer has 
+    // advertised (in the flags of the frames that it sends us) that it 
+    // can receive it. Otherwise we fall back to PCM16, which everyone 
+    // understands. Received frames are decoded according to their own 
+    // flags.
+    LinkCodec _rxCodec;
+    LinkCodec _txCodec;
+    volatile unsigned _preferredCodec = LINK_CODEC_PCM16;
+    // Bit mask of what the peer can receive, PCM16 until we hear otherwise
+    unsigned _peerCaps = (1 << LINK_CODEC_PCM16);
+    // Older firmware doesn't advertise capabilities and can't deal with 
+    // sequence numbers
+    bool _peerIsLegacy = true;
+    // The last thing received was an announcement. A peer that hasn't 
+    // heard from us yet sends an announcement before each of its 
+    // (legacy format) frames.
+    bool _peerAnnounced = false;
+
+    // Sequence numbers for outbound frames, and stand-in sequence numbers
+    // for inbound frames from legacy peers (which don't send them)
+    uint8_t _txSeq = 0;
+    uint8_t _rxLegacySeq = 0;
+
+    unsigned _rxFrameOverflow = 0;
+    unsigned _txFrameOverflow = 0;
+    unsigned _txMsgOverflow = 0;
+    unsigned _rxCodecErrors = 0;
+};
+
+}
@@ -0,0 +1,122 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include <cassert>
+
+#include "MixBus.h"
+
+namespace kc1fsz {
+
+template<unsigned BS>
+MixBusT<BS>::MixBusT(unsigned portCount)
+:   _portCount(portCount) {
+    assert(portCount <= MAX_PORTS);
+    for (unsigned k = 0; k < MAX_PORTS; k++) {
+        _gains[k] = 0;
+        _startGains[k] = 0;
+        _gainSteps[k] = 0;
+    }
+    for (unsigned i = 0; i < BLOCK_SIZE; i++)
+        _total[i] = 0;
+}
+
+template<unsigned BS>
+void MixBusT<BS>::setSourceGainLinear(unsigned port, float gain) {
+    assert(port < MAX_PORTS);
+    _next.gains[port] = gain;
+    _params.publish(_next);
+}
+
+template<unsigned BS>
+void MixBusT<BS>::setMixMinus(unsigned port, bool b) {
+    assert(port < MAX_PORTS);
+    _next.mixMinus[port] = b;
+    _params.publish(_next);
+}
+
+// ****************************************************************************
+// NOTE: This function is called once per audio block so keep it short!
+// ****************************************************************************
+template<unsigned BS>
+void MixBusT<BS>::cycle(const float** ins) {
+
+    _ins = ins;
+
+    // Pick up any changes from the main loop. A torn copy (very unlikely)
+    // is just ignored until the next block.
+    if (_params.getSeq() != _pSeq) {
+        Params n;
+        if (_params.read(n, &_pSeq))
+            _p = n;
+    }
+
+    for (unsigned i = 0; i < BLOCK_SIZE; i++)
+        _total[i] = 0;
+
+    for (unsigned k = 0; k < _portCount; k++) {
+        // Ramp from the previous gain to the new gain across the block
+        const float target = _p.gains[k];
+        const float g0 = _gains[k];
+        const float step = (target - g0) / (float)BLOCK_SIZE;
+        _startGains[k] = g0;
+        _gainSteps[k] = step;
+        _gains[k] = target;
+        // Skip the work for sources that are (and remain) silent
+        if (g0 == 0 && target == 0)
+            continue;
+        const float* in = ins[k];
+        float g = g0;
+        for (unsigned i = 0; i < BLOCK_SIZE; i++) {
+            g += step;
+            _total[i] += g * in[i];
+        }
+    }
+}
+
+// ****************************************************************************
+// NOTE: This function is called once per audio block so keep it short!
+// ****************************************************************************
+template<unsigned BS>
+void MixBusT<BS>::getMix(unsigned port, float* out) const {
+    assert(port < _portCount);
+    if (!_p.mixMinus[port]) {
+        for (unsigned i = 0; i < BLOCK_SIZE; i++)
+            out[i] = _total[i];
+    } else {
+        // Take this port's contribution back out of the total, using
+        // exactly the same ramp that was used to put it in.
+        const float* in = _ins[port];
+        const float step = _gainSteps[port];
+        float g = _startGains[port];
+        for (unsigned i = 0; i < BLOCK_SIZE; i++) {
+            g += step;
+            out[i] = _total[i] - g * in[i];
+        }
+    }
+}
+
+#ifdef PICO_BUILD
+template class MixBusT<AUDIO_BLOCK_SIZE_ADC>;
+#else
+template class MixBusT<64>;
+template class MixBusT<128>;
+template class MixBusT<256>;
+#endif
+
+}
@@ -0,0 +1,119 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cstdint>
+
+#include "AudioBlockSize.h"
+#include "Snapshot.h"
+
+namespace kc1fsz {
+
+/**
+ * @brief The central mixer that combines the 8k receive audio from all
+ * of the ports and provides the transmit audio for each port.
+ *
+ * Each port is both a source (its receive audio) and a destination
+ * (its transmit audio). Port numbers are the same on both sides.
+ *
+ * A weighted total of all sources is computed once per block. A port
+ * that is in "mix-minus" mode gets the total with its own contribution
+ * subtracted back out (i.e. no echo), so the cost of adding a port is
+ * linear rather than quadratic.
+ *
+ * Source gains are ramped linearly across the block to avoid clicks
+ * when sources come and go.
+ *
+ * The settings are changed from the main loop and published as a 
+ * Snapshot that cycle() picks up at the start of each block.
+ *
+ * @tparam BS Number of 32k CODEC samples per block, must match the
+ * AudioCore. The mixing happens at 8k so the mix blocks are BS/4.
+ */
+template<unsigned BS> class MixBusT {
+public:
+
+    static const unsigned BLOCK_SIZE = BS / 4;
+    static const unsigned MAX_PORTS = 8;
+
+    MixBusT(unsigned portCount);
+
+    /**
+     * @brief Sets the gain that will be applied to the receive audio
+     * of a port. The change is ramped in over the next block.
+     *
+     * @param gain 0->1 linear scale.
+     */
+    void setSourceGainLinear(unsigned port, float gain);
+
+    /**
+     * @brief Controls whether the port's own receive audio is removed
+     * from its transmit audio.
+     */
+    void setMixMinus(unsigned port, bool b);
+
+    /**
+     * @brief Called once per block after all ports have produced their
+     * receive audio and before any port asks for its transmit audio.
+     *
+     * @param ins One block of 8k audio for each port. The pointers
+     * need to remain valid until the getMix() calls are finished.
+     */
+    void cycle(const float** ins);
+
+    /**
+     * @brief Produces the transmit audio for a port.
+     *
+     * @param out One block of 8k audio is written here.
+     */
+    void getMix(unsigned port, float* out) const;
+
+private:
+
+    struct Params {
+        // Requested gains
+        float gains[MAX_PORTS] = { };
+        bool mixMinus[MAX_PORTS] = { };
+    };
+
+    const unsigned _portCount;
+    // Settings being built up by the main loop. This is value-initialized
+    // so that the padding is zero (see Snapshot::publish()).
+    Params _next = Params();
+    Snapshot<Params> _params;
+    // Settings in use by cycle()/getMix() and the version number
+    Params _p;
+    uint32_t _pSeq = 0;
+    // Gain at the end of the last block
+    float _gains[MAX_PORTS];
+    // Gain at the start of the current block and the per-sample change.
+    // These are needed to take a port's contribution back out.
+    float _startGains[MAX_PORTS];
+    float _gainSteps[MAX_PORTS];
+    const float** _ins = 0;
+    float _total[BLOCK_SIZE];
+};
+
+/**
+ * The mix bus for the block size that the firmware was built with.
+ */
+typedef MixBusT<AUDIO_BLOCK_SIZE_ADC> MixBus;
+
+}
@@ -0,0 +1,106 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include "Nco.h"
+
+#include <cmath>
+
+namespace kc1fsz {
+
+// Quarter-wave table size as a power of two. 
+static const unsigned TABLE_BITS = 8;
+static const unsigned TABLE_SIZE = 1 << TABLE_BITS;
+// Phase bits below the table index, used for the interpolation
+static const unsigned FRAC_BITS = 30 - TABLE_BITS;
+static const uint32_t FRAC_MASK = (1 << FRAC_BITS) - 1;
+static const float FRAC_SCALE = 1.0f / (float)(1 << FRAC_BITS);
+static const uint32_t QUARTER = 0x40000000;
+static const double PI_D = 3.14159265358979323846;
+
+// sin() from 0 to pi/2 inclusive (the extra point at the end saves a 
+// test in the interpolation).
+static float SINE_TABLE[TABLE_SIZE + 1];
+
+// Fills in the table before main() runs
+static struct SineTableInit {
+    SineTableInit() {
+        for (unsigned i = 0; i <= TABLE_SIZE; i++)
+            SINE_TABLE[i] = std::sin((double)i * PI_D / (2.0 * TABLE_SIZE));
+    }
+} sineTableInit;
+
+Nco::Nco(float fs) 
+:   _fs(fs) {
+}
+
+void Nco::setFreq(float hz) {
+    // Negative frequencies wrap to the equivalent positive increment
+    _inc = (uint32_t)(int64_t)std::llround((double)hz / (double)_fs * 4294967296.0);
+}
+
+float Nco::_cosAt(uint32_t phase) {
+    // cos(x) = sin(x + pi/2)
+    phase += QUARTER;
+    uint32_t x = phase & (QUARTER - 1);
+    // The second and fourth quadrants run backwards through the table
+    if (phase & QUARTER)
+        x = QUARTER - x;
+    const uint32_t i = x >> FRAC_BITS;
+    // x == QUARTER lands on the extra table point
+    const float f = (float)(x & FRAC_MASK) * FRAC_SCALE;
+    const float a = SINE_TABLE[i];
+    const float v = a + f * (SINE_TABLE[i + (i < TABLE_SIZE)] - a);
+    // The second half of the cycle is negative
+    return (phase & 0x80000000) ? -v : v;
+}
+
+// ****************************************************************************
+// NOTE: This function is called once per audio block so keep it short!
+// ****************************************************************************
+void Nco::generate(float* out, unsigned n, float amp) {
+    uint32_t p = _phase;
+    for (unsigned i = 0; i < n; i++, p += _inc)
+        out[i] = amp * _cosAt(p);
+    _phase = p;
+}
+
+// ****************************************************************************
+// NOTE: This function is called once per audio block so keep it short!
+// ****************************************************************************
+void Nco::accumulate(float* out, unsigned n, float amp) {
+    uint32_t p = _phase;
+    for (unsigned i = 0; i < n; i++, p += _inc)
+        out[i] += amp * _cosAt(p);
+    _phase = p;
+}
+
+// ****************************************************************************
+// NOTE: This function is called once per audio block so keep it short!
+// ****************************************************************************
+void Nco::generateQuadrature(float* cosOut, float* sinOut, unsigned n) {
+    uint32_t p = _phase;
+    for (unsigned i = 0; i < n; i++, p += _inc) {
+        cosOut[i] = _cosAt(p);
+        // sin(x) = cos(x - pi/2)
+        sinOut[i] = _cosAt(p - QUARTER);
+    }
+    _phase = p;
+}
+
+}
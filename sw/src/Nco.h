@@ -0,0 +1,85 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace kc1fsz {
+
+/**
+ * @brief A numerically controlled oscillator that produces a cosine 
+ * wave a block at a time.
+ *
+ * The phase is a 32-bit fixed-point accumulator where 2^32 is one full
+ * cycle, so it wraps around for free (no fmod) and never loses 
+ * precision no matter how long it runs. The top two bits select the 
+ * quadrant and the rest are used to look up (with linear interpolation) 
+ * a 256-entry quarter-wave sine table. The worst-case error is about 
+ * 5e-6 of full scale (-106 dB), which is well below anything the 
+ * CODEC can reproduce.
+ *
+ * Changing the frequency only changes the phase increment, so the 
+ * output is continuous across frequency changes.
+ */
+class Nco {
+public:
+
+    /**
+     * @param fs The sample rate that the oscillator runs at.
+     */
+    Nco(float fs);
+
+    /**
+     * @brief Changes the frequency starting with the next sample.
+     */
+    void setFreq(float hz);
+
+    /**
+     * @brief Puts the phase back to zero (i.e. the next sample is the 
+     * positive peak).
+     */
+    void reset() { _phase = 0; }
+
+    /**
+     * @brief Writes the next n samples of amp * cos(phase).
+     */
+    void generate(float* out, unsigned n, float amp);
+
+    /**
+     * @brief Same as generate() but adds to what is already in out.
+     */
+    void accumulate(float* out, unsigned n, float amp);
+
+    /**
+     * @brief Writes the next n samples of cos(phase) and sin(phase),
+     * for use as a quadrature mixer.
+     */
+    void generateQuadrature(float* cosOut, float* sinOut, unsigned n);
+
+private:
+
+    static float _cosAt(uint32_t phase);
+
+    const float _fs;
+    uint32_t _phase = 0;
+    uint32_t _inc = 0;
+};
+
+}
@@ -0,0 +1,58 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include <cstring>
+
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+
+#include "PicoConfigFlash.h"
+
+namespace kc1fsz {
+
+// The very last sector of flash is used for the configuration
+static const uint32_t CONFIG_FLASH_OFFSET = PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE;
+
+static_assert(ConfigFlash::SECTOR_SIZE == FLASH_SECTOR_SIZE);
+static_assert(ConfigFlash::PAGE_SIZE == FLASH_PAGE_SIZE);
+
+void PicoConfigFlash::read(uint8_t* out, unsigned len) const {
+    // Compute the memory-mapped address, remembering to include the 
+    // offset for RAM
+    const uint8_t* addr = (const uint8_t*)(XIP_BASE + CONFIG_FLASH_OFFSET);
+    memcpy(out, addr, len);
+}
+
+void PicoConfigFlash::erase() {
+    flash_range_erase(CONFIG_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+}
+
+void PicoConfigFlash::program(unsigned offset, const uint8_t* data, unsigned len) {
+    flash_range_program(CONFIG_FLASH_OFFSET + offset, data, len);
+}
+
+void PicoConfigFlash::write(const uint8_t* data, unsigned len) {
+    uint32_t ints = save_and_disable_interrupts();
+    erase();
+    program(0, data, len);
+    restore_interrupts(ints);
+}
+
+}
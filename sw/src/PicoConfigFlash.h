@@ -0,0 +1,38 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include "ConfigFlash.h"
+
+namespace kc1fsz {
+
+/**
+ * @brief Uses the very last sector of the RP2350 flash.
+ */
+class PicoConfigFlash : public ConfigFlash {
+public:
+
+    virtual void read(uint8_t* out, unsigned len) const;
+    virtual void erase();
+    virtual void program(unsigned offset, const uint8_t* data, unsigned len);
+    virtual void write(const uint8_t* data, unsigned len);
+};
+
+}
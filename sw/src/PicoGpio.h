@@ -0,0 +1,44 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include "hardware/gpio.h"
+
+#include "Gpio.h"
+
+namespace kc1fsz {
+
+/**
+ * @brief The RP2350 GPIO pins.
+ */
+class PicoGpio : public Gpio {
+public:
+
+    virtual void init(unsigned pin, bool isOutput) { 
+        gpio_init(pin);
+        gpio_set_dir(pin, isOutput ? GPIO_OUT : GPIO_IN);
+        if (isOutput)
+            gpio_put(pin, 0);
+    }
+    virtual void put(unsigned pin, bool value) { gpio_put(pin, value); }
+    virtual bool get(unsigned pin) const { return gpio_get(pin); }
+};
+
+}
@@ -113,6 +113,15 @@ public:
 
     virtual void setToneFreq(float hz) = 0;
 
+    /**
+     * @brief Allows any of a set of standard CTCSS tones to be 
+     * accepted in place of the single tone set by setToneFreq().
+     *
+     * @param set Bit k is CtcssScanner::TONES[k]. Zero means that only
+     * the tone set by setToneFreq() is accepted.
+     */
+    virtual void setToneSet(uint64_t set) = 0;
+
     /**
      * @brief Sets the receiver soft gain. Received
      * audio is multiplied by this value.
@@ -128,6 +137,8 @@ public:
     virtual void setDtmfDetectLevel(float dbfs) = 0;
 
     virtual void setDeemphMode(uint32_t mode) = 0;
+
+    virtual void setHpfMode(uint32_t mode) = 0;
 };
 
 }
@@ -18,10 +18,12 @@
  * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
  */
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 
 #include "kc1fsz-tools/Common.h"
 #include "Config.h"
+#include "CtcssScanner.h"
 #include "ShellCommand.h"
 
 namespace kc1fsz {
@@ -32,6 +34,34 @@ static bool eq(const char* a, const char* b) {
     return strcmp(a, b) == 0;
 }
 
+/**
+ * Parses a comma-separated list of standard CTCSS tones (ex: 
+ * 88.5,100.0). "none" clears the set and "all" accepts any of the
+ * standard tones. The set is left alone if the list isn't valid.
+ */
+static void parseToneSet(const char* s, uint64_t* set) {
+    if (eq(s, "none")) {
+        *set = 0;
+        return;
+    }
+    if (eq(s, "all")) {
+        *set = ((uint64_t)1 << CtcssScanner::TONE_COUNT) - 1;
+        return;
+    }
+    uint64_t result = 0;
+    while (*s) {
+        char* end;
+        int k = CtcssScanner::findTone(strtof(s, &end));
+        if (end == s || k < 0 || (*end != ',' && *end != 0)) {
+            printf(INVALID_COMMAND);
+            return;
+        }
+        result |= (uint64_t)1 << k;
+        s = (*end == ',') ? end + 1 : end;
+    }
+    *set = result;
+}
+
 void ShellCommand::process(const char* cmd) {
     // Tokenize
     const unsigned int maxTokenCount = 4;
@@ -64,11 +94,12 @@ void ShellCommand::process(const char* cmd) {
         }
         else if (eq(tokens[0], "factoryreset")) {
             Config::setFactoryDefaults(&_config);
-            Config::saveConfig(&_config);
+            Config::requestSave(&_config);
             configChanged = true;
         }
         else if (eq(tokens[0], "save")) {
-            Config::saveConfig(&_config);
+            // The flash write happens in the background
+            Config::requestSave(&_config);
         }
         else if (eq(tokens[0], "ping")) {
             printf("pong\n");
@@ -85,6 +116,9 @@ void ShellCommand::process(const char* cmd) {
         else if (eq(tokens[0], "id")) {
             _idTrigger();
         }
+        else if (eq(tokens[0], "prof")) {
+            _profileTrigger(false);
+        }
         else
             printf(INVALID_COMMAND);
     }
@@ -95,6 +129,9 @@ void ShellCommand::process(const char* cmd) {
         else if (eq(tokens[0], "teststop")) {
             _testStopTrigger(atoi(tokens[1]));
         }
+        else if (eq(tokens[0], "prof") && eq(tokens[1], "reset")) {
+            _profileTrigger(true);
+        }
         else 
             printf(INVALID_COMMAND);
     }
@@ -113,6 +150,8 @@ void ShellCommand::process(const char* cmd) {
                 _config.general.diagLevel = atof(tokens[2]);
             } else if (eq(tokens[1], "idrequiredint")) {
                 _config.general.idRequiredInt = atoi(tokens[2]);
+            } else if (eq(tokens[1], "linkcodec")) {
+                _config.general.linkCodec = atoi(tokens[2]);
             } else {
                 printf(INVALID_COMMAND);
             }
@@ -187,6 +226,13 @@ void ShellCommand::process(const char* cmd) {
                     _config.rx1.toneFreq = atof(tokens[3]);
                 else 
                     printf(INVALID_COMMAND);                
+            else if (eq(tokens[1], "rxtoneset"))
+                if (eq(tokens[2], "0"))
+                    parseToneSet(tokens[3], &_config.rx0.toneSet);
+                else if (eq(tokens[2], "1"))
+                    parseToneSet(tokens[3], &_config.rx1.toneSet);
+                else 
+                    printf(INVALID_COMMAND);                
             else if (eq(tokens[1], "rxgain"))
                 if (eq(tokens[2], "0"))
                     _config.rx0.gain = atof(tokens[3]);
@@ -229,6 +275,13 @@ void ShellCommand::process(const char* cmd) {
                     _config.rx1.deemphMode = atoi(tokens[3]);
                 else 
                     printf(INVALID_COMMAND);                
+            else if (eq(tokens[1], "hpfmode"))
+                if (eq(tokens[2], "0"))
+                    _config.rx0.hpfMode = atoi(tokens[3]);
+                else if (eq(tokens[2], "1"))
+                    _config.rx1.hpfMode = atoi(tokens[3]);
+                else 
+                    printf(INVALID_COMMAND);                
             else if (eq(tokens[1], "txenable"))
                 if (eq(tokens[2], "0"))
                     _config.tx0.enabled = atoi(tokens[3]) == 1;
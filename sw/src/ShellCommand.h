@@ -36,14 +36,16 @@ public:
         std::function<void()> configChangedTrigger,
         std::function<void()> idTrigger,
         std::function<void(int)> testStartTrigger,
-        std::function<void(int)> testStopTrigger) 
+        std::function<void(int)> testStopTrigger,
+        std::function<void(bool)> profileTrigger) 
     :   _config(config),
         _logTrigger(logTrigger), 
         _statusTrigger(statusTrigger),
         _configChangedTrigger(configChangedTrigger),
         _idTrigger(idTrigger),
         _testStartTrigger(testStartTrigger),
-        _testStopTrigger(testStopTrigger) { }
+        _testStopTrigger(testStopTrigger),
+        _profileTrigger(profileTrigger) { }
 
     void process(const char* cmd);
 
@@ -56,6 +58,8 @@ private:
     std::function<void()> _idTrigger;
     std::function<void(int)> _testStartTrigger;
     std::function<void(int)> _testStopTrigger;
+    // Called with true to clear the audio profile, false to show it
+    std::function<void(bool)> _profileTrigger;
 };
 
 }
@@ -0,0 +1,111 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace kc1fsz {
+
+/**
+ * @brief A lock-free way to pass the latest version of a small struct 
+ * (e.g. a block of settings) from one context to another.
+ *
+ * One context calls publish() and one other context calls read(). 
+ * Neither side ever waits for the other, so this is safe between an 
+ * interrupt and the main loop or between cores.
+ *
+ * There are two copies of the struct. Each publish() goes into the copy
+ * that was not published last time and is stamped with a sequence 
+ * number. The reader copies out the most recent version and then checks
+ * that the stamp didn't change while it was copying. A torn copy is only
+ * possible if the writer publishes twice during one read, in which case
+ * read() fails and the caller can try again (or wait for the next 
+ * block).
+ *
+ * @tparam T Must be trivially copyable.
+ */
+template<typename T> class Snapshot {
+public:
+
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+    /**
+     * Writer side. Publishing something that is the same as the last 
+     * version is skipped so that callers don't need to track changes.
+     *
+     * The comparison is bytewise, padding included, so the caller should
+     * keep the struct that it publishes in a value-initialized object 
+     * (i.e. T v = T()) that is only changed one member at a time. 
+     * Otherwise an unchanged version may be published again, which is 
+     * harmless.
+     */
+    void publish(const T& v) {
+        const uint32_t seq = _seq.load(std::memory_order_relaxed);
+        if (memcmp(&_slots[seq & 1], &v, sizeof(T)) == 0)
+            return;
+        const uint32_t next = seq + 1;
+        const unsigned k = next & 1;
+        // Mark the slot as being written before touching it
+        _stamps[k].store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        // Bytewise so that the padding comes along for the comparison
+        memcpy(&_slots[k], &v, sizeof(T));
+        _stamps[k].store(next, std::memory_order_release);
+        _seq.store(next, std::memory_order_release);
+    }
+
+    /**
+     * Reader side.
+     *
+     * @param seq If not null, the sequence number of the version that was
+     * read is written here.
+     * @returns false if the copy was torn (v is undefined).
+     */
+    bool read(T& v, uint32_t* seq = 0) const {
+        const uint32_t s = _seq.load(std::memory_order_acquire);
+        const unsigned k = s & 1;
+        if (_stamps[k].load(std::memory_order_acquire) != s)
+            return false;
+        v = _slots[k];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_stamps[k].load(std::memory_order_relaxed) != s)
+            return false;
+        if (seq)
+            *seq = s;
+        return true;
+    }
+
+    /**
+     * @returns The sequence number of the latest version. This is a cheap
+     * way for the reader to see if there is anything new.
+     */
+    uint32_t getSeq() const { return _seq.load(std::memory_order_acquire); }
+
+private:
+
+    T _slots[2] = { };
+    std::atomic<uint32_t> _stamps[2] = { 0, 0 };
+    std::atomic<uint32_t> _seq = 0;
+};
+
+}
@@ -0,0 +1,115 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <atomic>
+
+namespace kc1fsz {
+
+/**
+ * @brief A lock-free single-producer/single-consumer ring of fixed-size 
+ * items.
+ *
+ * One context (e.g. an interrupt handler) may call push() and one other
+ * context may call front()/pop(). Nothing else is required for safety,
+ * so this can be used between interrupt priorities on the same core or
+ * between cores.
+ *
+ * The consumer can look at the item in place (front()) and only release
+ * the slot (pop()) when it is finished with it. This avoids an extra 
+ * copy of large items.
+ *
+ * @tparam T The item type. Copied in by value.
+ * @tparam N Number of slots, must be a power of two. One slot is never
+ * used to distinguish between full and empty.
+ */
+template<typename T, unsigned N> class SpscRing {
+public:
+
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be a power of two");
+
+    /**
+     * Producer side.
+     * @returns false if the ring is full (the item is discarded).
+     */
+    bool push(const T& item) {
+        const unsigned wr = _wr.load(std::memory_order_relaxed);
+        const unsigned next = (wr + 1) & MASK;
+        if (next == _rd.load(std::memory_order_acquire))
+            return false;
+        _items[wr] = item;
+        _wr.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Consumer side.
+     * @returns The oldest item, or null if the ring is empty. The 
+     * item stays valid until pop() is called.
+     */
+    const T* front() const {
+        const unsigned rd = _rd.load(std::memory_order_relaxed);
+        if (rd == _wr.load(std::memory_order_acquire))
+            return 0;
+        return &_items[rd];
+    }
+
+    /**
+     * Consumer side. Releases the item returned by front().
+     */
+    void pop() {
+        const unsigned rd = _rd.load(std::memory_order_relaxed);
+        _rd.store((rd + 1) & MASK, std::memory_order_release);
+    }
+
+    /**
+     * Consumer side. Copies out and releases the oldest item.
+     * @returns false if the ring is empty.
+     */
+    bool pop(T& item) {
+        const T* f = front();
+        if (!f)
+            return false;
+        item = *f;
+        pop();
+        return true;
+    }
+
+    /**
+     * @returns The number of items waiting. This is only a snapshot
+     * if the other side is active.
+     */
+    unsigned size() const {
+        return (_wr.load(std::memory_order_acquire) - 
+            _rd.load(std::memory_order_acquire)) & MASK;
+    }
+
+    bool empty() const { return size() == 0; }
+
+private:
+
+    static const unsigned MASK = N - 1;
+
+    T _items[N];
+    std::atomic<unsigned> _wr = 0;
+    std::atomic<unsigned> _rd = 0;
+};
+
+}
@@ -24,19 +24,20 @@
 
 namespace kc1fsz {
 
-StdRx::StdRx(Clock& clock, Log& log, int id, int cosPin, int tonePin, AudioCore& core) 
+StdRx::StdRx(Clock& clock, Log& log, int id, Gpio& gpio, int cosPin, int tonePin, 
+    AudioCore& core) 
 :   _clock(clock),
     _log(log),
     _id(id),
     // Flip logic because of the inverter in the hardware design
-    _cosPin(cosPin, true),
-    _tonePin(tonePin, true),
-    _cosDebouncer(clock, _cosValue),
-    _toneDebouncer(clock, _toneValue),
+    _cosPin(gpio, cosPin, true),
+    _tonePin(gpio, tonePin, true),
     _core(core),
-    _startTime(_clock.time()),
     _cosValue(_cosPin, core),
-    _toneValue(_tonePin, core) {
+    _toneValue(_tonePin, core),
+    _cosDebouncer(clock, _cosValue),
+    _toneDebouncer(clock, _toneValue),
+    _startTime(_clock.time()) {
 }
 
 void StdRx::run() {
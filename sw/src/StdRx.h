@@ -24,11 +24,11 @@
 #include "kc1fsz-tools/Log.h"
 #include "kc1fsz-tools/Clock.h"
 #include "kc1fsz-tools/BinaryWrapper.h"
-#include "kc1fsz-tools/rp2040/GpioValue.h"
 #include "kc1fsz-tools/TimeDebouncer.h"
 
 #include "Rx.h"
 #include "AudioCore.h"
+#include "GpioInput.h"
 
 namespace kc1fsz {
 
@@ -90,12 +90,26 @@ public:
                 snr = std::numeric_limits<float>::max();
             else
                 snr = AudioCore::db(_core.getSignalRms() / noiseRms);
-            return snr > _thresholdSnr && _core.getCtcssDecodeRms() > _thresholdRms;
+            if (snr <= _thresholdSnr)
+                return false;
+            // With a tone set the scanner decides. The strongest tone 
+            // has to be one of ours.
+            if (_toneSet) {
+                int tone = _core.getCtcssScanTone();
+                return tone >= 0 && 
+                    (_toneSet & ((uint64_t)1 << tone)) != 0 &&
+                    _core.getCtcssScanRms() > _thresholdRms;
+            }
+            // The confidence keeps a strong tone on another frequency (which 
+            // leaks into the decoder) from being taken for ours.
+            return _core.getCtcssDecodeRms() > _thresholdRms &&
+                _core.getCtcssDecodeConfidence() > _thresholdConfidence;
         }
     }
 
     void setUseHw(bool b) { _useHw = b; }
     void setThresholdRms(float rms) { _thresholdRms = rms; }
+    void setToneSet(uint64_t set) { _toneSet = set; }
 
 private:
 
@@ -104,12 +118,15 @@ private:
     bool _useHw = true;
     float _thresholdRms = 0.1;
     float _thresholdSnr = 10;
+    float _thresholdConfidence = 0.3;
+    uint64_t _toneSet = 0;
 };
 
 class StdRx : public Rx {
 public:
 
-    StdRx(Clock& clock, Log& log, int id, int cosPin, int tonePin, AudioCore& core);
+    StdRx(Clock& clock, Log& log, int id, Gpio& gpio, int cosPin, int tonePin, 
+        AudioCore& core);
 
     virtual int getId() const { return _id; }
     virtual void run();
@@ -151,6 +168,8 @@ public:
 
     void setToneFreq(float hz) { _core.setCtcssDecodeFreq(hz); }
 
+    virtual void setToneSet(uint64_t set) { _toneValue.setToneSet(set); }
+
     void setGainLinear(float lvl) { _core.setRxGainLinear(lvl); }
 
     void setDelayTime(unsigned ms) { _core.setRxDelayMs(ms); }
@@ -163,13 +182,15 @@ public:
 
     virtual void setDeemphMode(uint32_t mode) { _core.setDeemphMode(mode); }
 
+    virtual void setHpfMode(uint32_t mode) { _core.setHpfMode(mode); }
+
 private:
 
     Clock& _clock;
     Log& _log;
     const int _id;
-    GpioValue _cosPin;
-    GpioValue _tonePin;
+    GpioInput _cosPin;
+    GpioInput _tonePin;
     AudioCore& _core;
 
     // This combines the _cosPin and _core information to create 
@@ -17,8 +17,7 @@
  *
  * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
  */
-#include <hardware/gpio.h>
-
+#include "Gpio.h"
 #include "StdTx.h"
 
 namespace kc1fsz {
@@ -27,11 +26,12 @@ namespace kc1fsz {
  * VERY IMPORTANT: This should be the only place in the code that touches
  * the GPIO pins used for PTT!
  */
-StdTx::StdTx(Clock& clock, Log& log, int id, int pttPin, AudioCore& core,
+StdTx::StdTx(Clock& clock, Log& log, int id, Gpio& gpio, int pttPin, AudioCore& core,
     std::function<bool()> positiveEnableCheck)
 :   _clock(clock),
     _log(log),
     _id(id),
+    _gpio(gpio),
     _pttPin(pttPin),
     _core(core),
     _positiveEnableCheck(positiveEnableCheck) {
@@ -42,7 +42,7 @@ void StdTx::setEnabled(bool en) {
     // Do an immediate shut off if needed
     if (!_enabled) {
         _keyed = false;
-        gpio_put(_pttPin, 0);
+        _gpio.put(_pttPin, 0);
     }
     if (_enabled)
         _log.info("Transmitter enabled [%d]", _id);
@@ -67,14 +67,15 @@ void StdTx::setPtt(bool ptt) {
         enabled = enabled && _positiveEnableCheck();
 
     if (enabled) {
-        if (ptt != _keyed)
+        if (ptt != _keyed) {
             if (ptt) {
-                gpio_put(_pttPin, 1);
+                _gpio.put(_pttPin, 1);
                 _log.info("Transmitter keyed [%d]", _id);
             } else {
-                gpio_put(_pttPin, 0);
+                _gpio.put(_pttPin, 0);
                 _log.info("Transmitter unkeyed [%d]", _id);
             }
+        }
         _keyed = ptt;
     }
 }
@@ -89,7 +90,7 @@ void StdTx::run() {
     if (_positiveEnableCheck) {
         if (_positiveEnableCheck() == false) {
             _keyed = false;
-            gpio_put(_pttPin, 0);
+            _gpio.put(_pttPin, 0);
         }
     }
 }
@@ -27,12 +27,12 @@
 
 namespace kc1fsz {
 
-class AudioCore;
+class Gpio;
 
 class StdTx : public Tx {
 public:
 
-    StdTx(Clock& clock, Log& log, int id, int pttPin, AudioCore& core,
+    StdTx(Clock& clock, Log& log, int id, Gpio& gpio, int pttPin, AudioCore& core,
         std::function<bool()> positiveEnableCheck);
 
     virtual void run();
@@ -71,6 +71,7 @@ private:
     Clock& _clock;
     Log& _log;
     const int _id;
+    Gpio& _gpio;
     const int _pttPin;
     AudioCore& _core;
     std::function<bool()> _positiveEnableCheck;
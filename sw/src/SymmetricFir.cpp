@@ -0,0 +1,185 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include "SymmetricFir.h"
+
+#include <cstring>
+#include <cassert>
+
+namespace kc1fsz {
+
+// Outputs are computed LANES at a time so that each coefficient load 
+// is shared. On the Cortex-M33 there is no floating point SIMD, so two
+// at a time keeps all of the accumulators and the working samples in 
+// FPU registers. On the host the inner loop over the lanes becomes SIMD
+// instructions (same idea as in the CMSIS-DSP mock).
+#ifdef PICO_BUILD
+static const unsigned LANES = 2;
+#else
+static const unsigned LANES = 8;
+#endif
+
+/**
+ * Computes W outputs of a symmetric FIR. Output l is for the numTaps
+ * samples starting at x[l].
+ */
+template<unsigned W> static inline void symDot(const float32_t* x,
+    const float32_t* coeffs, unsigned numTaps, float32_t* out) {
+    float32_t acc[W] = { };
+    const float32_t* lo = x;
+    const float32_t* hi = x + numTaps - 1;
+    for (unsigned i = 0; i < numTaps / 2; i++, lo++, hi--) {
+        const float32_t c = coeffs[i];
+        for (unsigned l = 0; l < W; l++)
+            acc[l] += c * (lo[l] + hi[l]);
+    }
+    // Center tap (odd lengths)
+    if (numTaps & 1) {
+        const float32_t c = coeffs[numTaps / 2];
+        for (unsigned l = 0; l < W; l++)
+            acc[l] += c * lo[l];
+    }
+    for (unsigned l = 0; l < W; l++)
+        out[l] = acc[l];
+}
+
+void fir_sym_init_f32(fir_sym_instance_f32* s, uint16_t numTaps, 
+    const float32_t* pCoeffs, float32_t* pState, uint32_t blockSize) {
+    // Sanity check on the symmetry assumption
+    for (unsigned i = 0; i < numTaps / 2; i++)
+        assert(pCoeffs[i] == pCoeffs[numTaps - 1 - i]);
+    s->numTaps = numTaps;
+    s->pState = pState;
+    s->pCoeffs = pCoeffs;
+    s->blockSize = blockSize;
+    memset(pState, 0, (numTaps + blockSize - 1) * sizeof(float32_t));
+}
+
+// ****************************************************************************
+// NOTE: This function is called once per audio block so keep it short!
+// ****************************************************************************
+void fir_sym_f32(const fir_sym_instance_f32* s, const float32_t* pSrc, 
+    float32_t* pDst, uint32_t blockSize) {
+    assert(blockSize == s->blockSize);
+    const unsigned h = s->numTaps - 1;
+    // Same state layout as CMSIS: the history followed by the new block
+    memcpy(s->pState + h, pSrc, blockSize * sizeof(float32_t));
+    unsigned k = 0;
+    for (; k + LANES <= blockSize; k += LANES)
+        symDot<LANES>(s->pState + k, s->pCoeffs, s->numTaps, pDst + k);
+    for (; k < blockSize; k++)
+        symDot<1>(s->pState + k, s->pCoeffs, s->numTaps, pDst + k);
+    memmove(s->pState, s->pState + blockSize, h * sizeof(float32_t));
+}
+
+// The folded interpolator coefficients are laid out one pair of phases 
+// at a time. Phase j uses a[i] = h[L - 1 - j + L * i] (same as CMSIS) and
+// phase L-1-j uses a[P - 1 - i]. For the samples x[i] and x[P - 1 - i]:
+//
+//   y(j)       = p * (x[i] + x[P-1-i]) + q * (x[i] - x[P-1-i])
+//   y(L-1-j)   = p * (x[i] + x[P-1-i]) - q * (x[i] - x[P-1-i])
+//
+// where p = (a[i] + a[P-1-i]) / 2 and q = (a[i] - a[P-1-i]) / 2. So the 
+// folded coefficients are { p, q } for each i < P/2, then the center 
+// a[P/2] if P is odd. That is P floats per pair of phases.
+
+void fir_sym_interpolate_init_f32(fir_sym_interpolate_instance_f32* s, 
+    uint8_t L, uint16_t numTaps, const float32_t* pCoeffs, 
+    float32_t* pFolded, float32_t* pState, uint32_t blockSize) {
+    assert(L % 2 == 0);
+    assert(numTaps % L == 0);
+    for (unsigned i = 0; i < numTaps / 2; i++)
+        assert(pCoeffs[i] == pCoeffs[numTaps - 1 - i]);
+    const unsigned P = numTaps / L;
+    float32_t* f = pFolded;
+    for (unsigned j = 0; j < L / 2u; j++) {
+        const float32_t* a = pCoeffs + (L - 1 - j);
+        for (unsigned i = 0; i < P / 2; i++) {
+            *(f++) = (a[L * i] + a[L * (P - 1 - i)]) / 2.0f;
+            *(f++) = (a[L * i] - a[L * (P - 1 - i)]) / 2.0f;
+        }
+        if (P & 1)
+            *(f++) = a[L * (P / 2)];
+    }
+    assert(f == pFolded + fir_sym_interpolate_folded_size(numTaps));
+    s->L = L;
+    s->phaseLength = P;
+    s->pState = pState;
+    s->pFolded = pFolded;
+    s->blockSize = blockSize;
+    memset(pState, 0, (P + blockSize - 1) * sizeof(float32_t));
+}
+
+/**
+ * Computes W inputs' worth of outputs for one pair of phases. Input l 
+ * uses the P samples starting at x[l] and its outputs go to 
+ * outJ[l * L] and outK[l * L].
+ */
+template<unsigned W> static inline void symPhasePair(const float32_t* x,
+    const float32_t* folded, unsigned P, unsigned L, float32_t* outJ, 
+    float32_t* outK) {
+    float32_t accP[W] = { };
+    float32_t accQ[W] = { };
+    const float32_t* lo = x;
+    const float32_t* hi = x + P - 1;
+    for (unsigned i = 0; i < P / 2; i++, lo++, hi--, folded += 2) {
+        const float32_t p = folded[0];
+        const float32_t q = folded[1];
+        for (unsigned l = 0; l < W; l++) {
+            accP[l] += p * (lo[l] + hi[l]);
+            accQ[l] += q * (lo[l] - hi[l]);
+        }
+    }
+    if (P & 1) {
+        const float32_t c = folded[0];
+        for (unsigned l = 0; l < W; l++)
+            accP[l] += c * lo[l];
+    }
+    for (unsigned l = 0; l < W; l++) {
+        outJ[l * L] = accP[l] + accQ[l];
+        outK[l * L] = accP[l] - accQ[l];
+    }
+}
+
+// ****************************************************************************
+// NOTE: This function is called once per audio block so keep it short!
+// ****************************************************************************
+void fir_sym_interpolate_f32(const fir_sym_interpolate_instance_f32* s, 
+    const float32_t* pSrc, float32_t* pDst, uint32_t blockSize) {
+    assert(blockSize == s->blockSize);
+    const unsigned L = s->L;
+    const unsigned P = s->phaseLength;
+    const unsigned h = P - 1;
+    memcpy(s->pState + h, pSrc, blockSize * sizeof(float32_t));
+    for (unsigned j = 0; j < L / 2; j++) {
+        const float32_t* folded = s->pFolded + j * P;
+        float32_t* outJ = pDst + j;
+        float32_t* outK = pDst + (L - 1 - j);
+        unsigned n = 0;
+        for (; n + LANES <= blockSize; n += LANES)
+            symPhasePair<LANES>(s->pState + n, folded, P, L, 
+                outJ + n * L, outK + n * L);
+        for (; n < blockSize; n++)
+            symPhasePair<1>(s->pState + n, folded, P, L, 
+                outJ + n * L, outK + n * L);
+    }
+    memmove(s->pState, s->pState + blockSize, h * sizeof(float32_t));
+}
+
+}
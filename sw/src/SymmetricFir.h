@@ -0,0 +1,97 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cstdint>
+
+#include <arm_math.h>
+
+namespace kc1fsz {
+
+/**
+ * Folded versions of arm_fir_f32() and arm_fir_interpolate_f32() for 
+ * linear-phase (symmetric) filters.
+ *
+ * Since h[i] == h[N - 1 - i], the two samples that share a coefficient
+ * are added first and then multiplied once:
+ *
+ *   y = sum( h[i] * (x[i] + x[N - 1 - i]) ) for i < N / 2 (+ the center)
+ *
+ * For the interpolator, phase j of the polyphase split is phase L-1-j 
+ * run backwards, so each pair of phases is computed together from the 
+ * sum and the difference of the mirrored samples (see 
+ * fir_sym_interpolate_init_f32()). Either way it is about half the 
+ * multiplies.
+ *
+ * The instances, the state buffers (size and layout) and the 
+ * input/output alignment are the same as the CMSIS versions, so a filter
+ * can be switched over by just changing the calls. The coefficients are
+ * in CMSIS (reversed) order, which for these filters is the same thing.
+ *
+ * The results are not bit-exact with the CMSIS versions since the 
+ * additions happen in a different order.
+ */
+struct fir_sym_instance_f32 {
+    uint16_t numTaps;
+    float32_t* pState;
+    const float32_t* pCoeffs;
+    uint32_t blockSize;
+};
+
+/**
+ * @param pState numTaps + blockSize - 1 floats, same as arm_fir_init_f32().
+ */
+void fir_sym_init_f32(fir_sym_instance_f32* s, uint16_t numTaps, 
+    const float32_t* pCoeffs, float32_t* pState, uint32_t blockSize);
+
+void fir_sym_f32(const fir_sym_instance_f32* s, const float32_t* pSrc, 
+    float32_t* pDst, uint32_t blockSize);
+
+struct fir_sym_interpolate_instance_f32 {
+    uint8_t L;
+    uint16_t phaseLength;
+    float32_t* pState;
+    // The folded coefficients, made by the init
+    float32_t* pFolded;
+    uint32_t blockSize;
+};
+
+/**
+ * @returns The number of floats needed for the folded coefficients.
+ */
+constexpr unsigned fir_sym_interpolate_folded_size(unsigned numTaps) {
+    return numTaps / 2;
+}
+
+/**
+ * @param L Must be even.
+ * @param pState numTaps / L + blockSize - 1 floats, same as 
+ * arm_fir_interpolate_init_f32().
+ * @param pFolded fir_sym_interpolate_folded_size() floats. The original
+ * coefficients aren't needed after this.
+ */
+void fir_sym_interpolate_init_f32(fir_sym_interpolate_instance_f32* s, 
+    uint8_t L, uint16_t numTaps, const float32_t* pCoeffs, 
+    float32_t* pFolded, float32_t* pState, uint32_t blockSize);
+
+void fir_sym_interpolate_f32(const fir_sym_interpolate_instance_f32* s, 
+    const float32_t* pSrc, float32_t* pDst, uint32_t blockSize);
+
+}
@@ -50,6 +50,9 @@ public:
      */
     void setMute(bool mute);
 
+    enum State { INIT, IDLE, ACTIVE, PRE_ID, ID, POST_ID, 
+        ID_URGENT, PRE_COURTESY, COURTESY, HANG, LOCKOUT, TEST, TEMPORARY_MUTE };
+
     int getState() const { return (int)_state; }
    
     void setCall(const char* callSign) { _idToneGenerator.setCall(callSign); }
@@ -68,9 +71,6 @@ public:
 
 private:
 
-    enum State { INIT, IDLE, ACTIVE, PRE_ID, ID, POST_ID, 
-        ID_URGENT, PRE_COURTESY, COURTESY, HANG, LOCKOUT, TEST, TEMPORARY_MUTE };
-
     void _setState(State state, uint32_t timeoutWindowMs = 0);
     bool _isStateTimedOut() const;
 
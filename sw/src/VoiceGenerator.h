@@ -5,11 +5,10 @@
 #include "kc1fsz-tools/Clock.h"
 
 #include "ToneGenerator.h"
+#include "AudioCore.h"
 
 namespace kc1fsz {
 
-class AudioCore;
-
 class VoiceGenerator : public ToneGenerator {
 public:
 
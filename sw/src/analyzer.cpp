@@ -113,7 +113,7 @@ static void audio_proc(const int32_t* r0_samples, const int32_t* r1_samples,
 
     // Accumulate DFT buffer. This is a sliding window.
     memmove(dftBuffer, dftBuffer + ADC_SAMPLE_COUNT, (DFT_N - ADC_SAMPLE_COUNT) * 4);
-    memmove(dftBuffer + 3 * ADC_SAMPLE_COUNT, adc_in, ADC_SAMPLE_COUNT * 4);
+    memmove(dftBuffer + DFT_N - ADC_SAMPLE_COUNT, adc_in, ADC_SAMPLE_COUNT * 4);
 
     // Make tone
     for (unsigned i = 0; i < ADC_SAMPLE_COUNT; 
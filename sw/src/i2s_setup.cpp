@@ -27,11 +27,14 @@
 #include "hardware/clocks.h"
 #include "hardware/i2c.h"
 #include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "pico/multicore.h"
 #include "kc1fsz-tools/rp2040/PicoPerfTimer.h"
 
 #include "i2s.pio.h"
 
 #include "i2s_setup.h"
+#include "AudioProfiler.h"
 
 // ===========================================================================
 // CONFIGURATION PARAMETERS
@@ -73,9 +76,18 @@
 // close attention if moving things around.
 #define dac_dout_pin (9)
 
-// Number of ADC samples in a block
+// Size of one block (L+R, 32-bit words) in bytes, as a power of 2. 
+// The DAC DMA channels use this to wrap around the ring.
+#if ADC_SAMPLE_COUNT == 64
+#define ADC_SAMPLE_BYTES_LOG2 (9)
+#define DAC_SAMPLE_BYTES_LOG2 (9)
+#elif ADC_SAMPLE_COUNT == 128
+#define ADC_SAMPLE_BYTES_LOG2 (10)
+#define DAC_SAMPLE_BYTES_LOG2 (10)
+#else
 #define ADC_SAMPLE_BYTES_LOG2 (11)
 #define DAC_SAMPLE_BYTES_LOG2 (11)
+#endif
 
 using namespace kc1fsz;
 
@@ -88,6 +100,18 @@ static uint32_t dma_out_count = 0;
 uint32_t longestIsr = 0;
 static uint32_t longestLoop = 0;
 static PicoPerfTimer perfTimerIsr;
+static PicoPerfTimer perfTimerCore1;
+
+// Per-core load tracking. The core0 values are only written by the 
+// DMA interrupt and the core1 values are only written by core1.
+static volatile uint32_t block_count = 0;
+static volatile uint32_t late_count = 0;
+static volatile uint32_t core0_last_us = 0;
+static volatile uint32_t core0_max_us = 0;
+static volatile uint32_t core0_total_us = 0;
+static volatile uint32_t core1_last_us = 0;
+static volatile uint32_t core1_max_us = 0;
+static volatile uint32_t core1_total_us = 0;
 
 // ===========================================================================
 // DMA REALTED 
@@ -97,11 +121,13 @@ static PicoPerfTimer perfTimerIsr;
 #define DAC_BUFFER_SIZE (ADC_SAMPLE_COUNT * 2)
 // 4* for 32-bit integers
 #define DAC_BUFFER_ALIGN (DAC_BUFFER_SIZE * 4)
-// 4096-byte alignment is needed because we are using a DMA channel in ring mode
+// Alignment is needed because we are using a DMA channel in ring mode
 // and all buffers must be aligned to a power of two boundary.
 // 256 samples * 2 words per sample * 4 bytes per word = 2048 bytes
+// (512 bytes for 64 samples, 1024 bytes for 128 samples)
 static __attribute__((aligned(DAC_BUFFER_ALIGN))) uint32_t dac_buffer_ping[DAC_BUFFER_SIZE];
 static __attribute__((aligned(DAC_BUFFER_ALIGN))) uint32_t dac_buffer_pong[DAC_BUFFER_SIZE];
+static_assert(DAC_BUFFER_ALIGN == (1 << DAC_SAMPLE_BYTES_LOG2), "DAC ring size mismatch");
 
 // Buffer used to drive the ADC via DMA.
 // When running at 48kHz, each buffer of 384 samples represents 8ms of activity
@@ -127,8 +153,18 @@ static uint dma_ch_out_data1 = 0;
 // was just written and is waiting to be sent.
 static volatile bool dac_buffer_ping_open = false;
 
+// Set by core0 when a block is handed over, cleared by core1 when the 
+// processing of the block is complete.
+static volatile bool core1_busy = false;
+
+// These bits are packed into the word that is passed through the SIO 
+// FIFO to tell core1 which buffers to work on.
+#define BLOCK_ADC_HALF_1 (0x01)
+#define BLOCK_DAC_PING (0x02)
+
 static void process_in_frame();
 static audio_block_processor processor_cb = 0;
+static audio_block_sync sync_cb = 0;
 
 // This will be called once every AUDIO_BUFFER_SIZE/2 samples.
 // VERY IMPORTANT: This interrupt handler needs to be fast enough 
@@ -178,36 +214,74 @@ static void dma_irq_handler() {
     uint32_t t = perfTimerIsr.elapsedUs();
     if (t > longestIsr)
         longestIsr = t;
+    core0_last_us = t;
+    if (t > core0_max_us)
+        core0_max_us = t;
+    core0_total_us = core0_total_us + t;
 }
 
 // -----------------------------------------------------------------------------
 // IMPORTANT FUNCTION: 
 //
-// This should be called when a complete frame of audio 
-// data has been converted. The audio output is generated
-// in this function.
+// This should be called when a complete frame of audio data has been 
+// converted. Nothing is processed here, the block is just handed over 
+// to core1.
 //
 static void process_in_frame() {
 
     dma_in_count++;
+    block_count = block_count + 1;
 
     // Counter used to alternate between double-buffer sides
     static uint32_t dma_count_0 = 0;
 
     // Figure out which part of the double-buffer we just finished
-    // loading into.  Notice: the pointer is signed.
-    int32_t* adc_data;
-    if (dma_count_0 % 2 == 0) {
-        adc_data = (int32_t*)adc_buffer;
-    } else {
-        adc_data = (int32_t*)&(adc_buffer[ADC_BUFFER_SIZE]);
-    }
+    // loading into.  
+    uint32_t block = (dma_count_0 % 2 == 0) ? 0 : BLOCK_ADC_HALF_1;
     dma_count_0++;
 
     // Choose the appropriate DAC buffer based on our current tracking of which 
     // is available for use.
-    int32_t* dac_buffer;
     if (dac_buffer_ping_open) 
+        block |= BLOCK_DAC_PING;
+
+    // If core1 hasn't finished the previous block then this one is 
+    // dropped. The DAC will replay whatever was last in the buffer.
+    if (core1_busy) {
+        late_count = late_count + 1;
+        return;
+    }
+
+    // Core1 is idle at this point so the client can safely exchange 
+    // data with the audio processing objects.
+    if (sync_cb)
+        sync_cb();
+
+    core1_busy = true;
+    __dmb();
+
+    // The FIFO is known to be empty since core1 already consumed the 
+    // previous block, so this will not block.
+    multicore_fifo_push_blocking(block);
+}
+
+// -----------------------------------------------------------------------------
+// IMPORTANT FUNCTION: 
+//
+// Processes one audio block on core1. The audio output is generated
+// in this function.
+//
+static void process_block(uint32_t block) {
+
+    // Notice: the pointer is signed.
+    int32_t* adc_data;
+    if (block & BLOCK_ADC_HALF_1) 
+        adc_data = (int32_t*)&(adc_buffer[ADC_BUFFER_SIZE]);
+    else 
+        adc_data = (int32_t*)adc_buffer;
+
+    int32_t* dac_buffer;
+    if (block & BLOCK_DAC_PING) 
         dac_buffer = (int32_t*)dac_buffer_ping;
     else
         dac_buffer = (int32_t*)dac_buffer_pong;
@@ -238,9 +312,44 @@ static void process_in_frame() {
     }
 }
 
-void audio_setup(audio_block_processor cb) {
+// This is the core1 entry point. Core1 is dedicated to the audio 
+// processing and just waits for blocks to arrive from core0.
+static void core1_main() {
+#ifdef AUDIO_PROFILE
+    // The cycle counter is per-core so it has to be turned on from here
+    AudioProfiler::enableCounter();
+#endif
+    while (true) {
+        uint32_t block = multicore_fifo_pop_blocking();
+        perfTimerCore1.reset();
+        process_block(block);
+        uint32_t t = perfTimerCore1.elapsedUs();
+        core1_last_us = t;
+        if (t > core1_max_us)
+            core1_max_us = t;
+        core1_total_us = core1_total_us + t;
+        // Make sure all of the buffer writes are visible before 
+        // core0 is told that we are finished.
+        __dmb();
+        core1_busy = false;
+    }
+}
+
+void audio_get_load(audio_load* load) {
+    load->blockCount = block_count;
+    load->lateCount = late_count;
+    load->core0LastUs = core0_last_us;
+    load->core0MaxUs = core0_max_us;
+    load->core0TotalUs = core0_total_us;
+    load->core1LastUs = core1_last_us;
+    load->core1MaxUs = core1_max_us;
+    load->core1TotalUs = core1_total_us;
+}
+
+void audio_setup(audio_block_processor cb, audio_block_sync scb) {
 
     processor_cb = cb;
+    sync_cb = scb;
 
     gpio_init(adc_rst_pin);
     gpio_set_dir(adc_rst_pin, GPIO_OUT);
@@ -635,6 +744,10 @@ void audio_setup(audio_block_processor cb) {
 
     // ----- Final Enables ----------------------------------------------------
 
+    // Start the audio processing on core1. It will sit idle until the
+    // first block arrives.
+    multicore_launch_core1(core1_main);
+
     // Bind to the interrupt handler 
     irq_set_exclusive_handler(DMA_IRQ_0, dma_irq_handler);
     // Enable DMA interrupts
@@ -20,12 +20,57 @@
 #ifndef _i2s_setup_h
 #define _i2s_setup_h
 
+#include <cstdint>
+
+#include "AudioBlockSize.h"
+
 // Number of ADC samples in a block
-#define ADC_SAMPLE_COUNT (256)
+#define ADC_SAMPLE_COUNT (AUDIO_BLOCK_SIZE_ADC)
 
+/**
+ * Called once per audio block on core1. This is where all of the 
+ * radio DSP happens.
+ */
 typedef void (*audio_block_processor)(const int32_t* in_0, const int32_t* in_1, 
     int32_t* out_0, int32_t* out_1);
 
-void audio_setup(audio_block_processor cb);
+/**
+ * Called once per audio block on core0 (inside of the DMA interrupt)
+ * just before the block is handed to core1. Core1 is guaranteed to be
+ * idle at this point, so this is a safe place to exchange data with 
+ * the audio processing objects.
+ */
+typedef void (*audio_block_sync)();
+
+/**
+ * Starts the CODEC, the DMA and the audio processing on core1.
+ */
+void audio_setup(audio_block_processor cb, audio_block_sync sync_cb = 0);
+
+/**
+ * Per-core audio load counters. All times are in microseconds.
+ */
+struct audio_load {
+    // Number of blocks delivered by the ADC
+    uint32_t blockCount;
+    // Number of blocks that arrived while core1 was still busy with
+    // the previous block. These blocks are dropped.
+    uint32_t lateCount;
+    // Time spent inside of the DMA interrupt on core0
+    uint32_t core0LastUs;
+    uint32_t core0MaxUs;
+    // Running total, wraps. Use the difference between two readings.
+    uint32_t core0TotalUs;
+    // Time spent processing the block on core1
+    uint32_t core1LastUs;
+    uint32_t core1MaxUs;
+    // Running total, wraps. Use the difference between two readings.
+    uint32_t core1TotalUs;
+};
+
+/**
+ * Takes a snapshot of the audio load counters.
+ */
+void audio_get_load(audio_load* load);
 
 #endif
@@ -0,0 +1,53 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+
+#include "kc1fsz-tools/Clock.h"
+
+namespace kc1fsz {
+
+/**
+ * @brief Millisecond clock for the Linux build, the counterpart of 
+ * PicoClock. Uses the monotonic clock so it isn't affected by changes
+ * to the time of day.
+ */
+class LinuxClock : public Clock {
+public:
+
+    LinuxClock() { reset(); }
+
+    void reset() { _start = std::chrono::steady_clock::now(); }
+
+    virtual uint32_t time() const { return (uint32_t)(timeUs() / 1000); }
+
+    virtual uint64_t timeUs() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - _start).count();
+    }
+
+private:
+
+    std::chrono::steady_clock::time_point _start;
+};
+
+}
@@ -0,0 +1,70 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+
+#include "LinuxConfigFlash.h"
+
+namespace kc1fsz {
+
+LinuxConfigFlash::LinuxConfigFlash() {
+    const char* fn = getenv("SDRC_FLASH");
+    _fn = fn ? fn : "sdrc-flash.bin";
+    memset(_sector, 0xff, SECTOR_SIZE);
+    FILE* f = fopen(_fn.c_str(), "rb");
+    if (f) {
+        // A short file just leaves the rest erased
+        if (fread(_sector, 1, SECTOR_SIZE, f) != SECTOR_SIZE)
+            printf("Short flash file %s\n", _fn.c_str());
+        fclose(f);
+    }
+}
+
+void LinuxConfigFlash::read(uint8_t* data, unsigned len) const {
+    assert(len <= SECTOR_SIZE);
+    memcpy(data, _sector, len);
+}
+
+void LinuxConfigFlash::erase() {
+    memset(_sector, 0xff, SECTOR_SIZE);
+    _save();
+}
+
+void LinuxConfigFlash::program(unsigned offset, const uint8_t* data, unsigned len) {
+    assert(offset % PAGE_SIZE == 0 && len % PAGE_SIZE == 0);
+    assert(offset + len <= SECTOR_SIZE);
+    for (unsigned i = 0; i < len; i++)
+        _sector[offset + i] &= data[i];
+    _save();
+}
+
+void LinuxConfigFlash::_save() {
+    FILE* f = fopen(_fn.c_str(), "wb");
+    if (f == 0) {
+        printf("Unable to write flash file %s\n", _fn.c_str());
+        return;
+    }
+    fwrite(_sector, 1, SECTOR_SIZE, f);
+    fclose(f);
+}
+
+}
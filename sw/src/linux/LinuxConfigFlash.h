@@ -0,0 +1,56 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "ConfigFlash.h"
+
+namespace kc1fsz {
+
+/**
+ * @brief The configuration flash sector for the Linux build, kept in a 
+ * file. The file is taken from SDRC_FLASH, or sdrc-flash.bin in the 
+ * current directory if that isn't set. A missing file reads as an
+ * erased sector, so the first run starts with the factory defaults.
+ *
+ * Erase and program behave like the real flash (erase sets all bits, 
+ * program can only clear bits) so that mistakes in the save logic show 
+ * up here too.
+ */
+class LinuxConfigFlash : public ConfigFlash {
+public:
+
+    LinuxConfigFlash();
+
+    virtual void read(uint8_t* data, unsigned len) const;
+    virtual void erase();
+    virtual void program(unsigned offset, const uint8_t* data, unsigned len);
+
+private:
+
+    void _save();
+
+    std::string _fn;
+    uint8_t _sector[SECTOR_SIZE];
+};
+
+}
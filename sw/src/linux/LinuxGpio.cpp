@@ -0,0 +1,98 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <chrono>
+
+#include "LinuxGpio.h"
+
+namespace kc1fsz {
+
+static uint64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+LinuxGpio::LinuxGpio() {
+    const char* dir = getenv("SDRC_GPIO_DIR");
+    _dir = dir ? dir : "sdrc-gpio";
+}
+
+std::string LinuxGpio::_path(unsigned pin) const {
+    return _dir + "/gpio" + std::to_string(pin);
+}
+
+void LinuxGpio::_write(unsigned pin, bool value) const {
+    FILE* f = fopen(_path(pin).c_str(), "w");
+    if (f == 0)
+        return;
+    fprintf(f, "%d\n", value ? 1 : 0);
+    fclose(f);
+}
+
+void LinuxGpio::init(unsigned pin, bool isOutput) {
+    assert(pin < MAX_PINS);
+    _pins[pin].output = isOutput;
+    _pins[pin].value = false;
+    _pins[pin].haveRead = false;
+    if (isOutput) {
+        _write(pin, false);
+    } else {
+        // Leave an existing input alone, the script may already have 
+        // set it up.
+        FILE* f = fopen(_path(pin).c_str(), "r");
+        if (f)
+            fclose(f);
+        else 
+            _write(pin, false);
+    }
+}
+
+void LinuxGpio::put(unsigned pin, bool value) {
+    assert(pin < MAX_PINS);
+    Pin& p = _pins[pin];
+    if (p.output && p.value == value)
+        return;
+    p.value = value;
+    _write(pin, value);
+}
+
+bool LinuxGpio::get(unsigned pin) const {
+    assert(pin < MAX_PINS);
+    Pin& p = _pins[pin];
+    if (p.output)
+        return p.value;
+    const uint64_t now = nowUs();
+    if (!p.haveRead || now - p.readUs >= POLL_MS * 1000) {
+        p.haveRead = true;
+        p.readUs = now;
+        FILE* f = fopen(_path(pin).c_str(), "r");
+        if (f) {
+            int c = fgetc(f);
+            // Anything other than a leading 1 is low
+            p.value = (c == '1');
+            fclose(f);
+        }
+    }
+    return p.value;
+}
+
+}
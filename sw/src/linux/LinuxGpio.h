@@ -0,0 +1,73 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Gpio.h"
+
+namespace kc1fsz {
+
+/**
+ * @brief GPIO for the Linux build. Each pin is a small text file 
+ * (gpioNN) in a directory, containing 0 or 1, in the spirit of the old 
+ * sysfs GPIO interface. A script (or a person with echo) drives the 
+ * inputs and can watch the outputs:
+ *
+ *   echo 1 > sdrc-gpio/gpio14
+ *   cat sdrc-gpio/gpio12
+ *
+ * The directory is taken from SDRC_GPIO_DIR, or sdrc-gpio in the 
+ * current directory if that isn't set. It needs to exist.
+ *
+ * Inputs are re-read at most every POLL_MS since the main loop asks 
+ * for them constantly.
+ */
+class LinuxGpio : public Gpio {
+public:
+
+    static const unsigned MAX_PINS = 48;
+    static const unsigned POLL_MS = 10;
+
+    LinuxGpio();
+
+    virtual void init(unsigned pin, bool isOutput);
+    virtual void put(unsigned pin, bool value);
+    virtual bool get(unsigned pin) const;
+
+private:
+
+    std::string _path(unsigned pin) const;
+    void _write(unsigned pin, bool value) const;
+
+    std::string _dir;
+
+    struct Pin {
+        bool output = false;
+        bool value = false;
+        uint64_t readUs = 0;
+        bool haveRead = false;
+    };
+
+    mutable Pin _pins[MAX_PINS];
+};
+
+}
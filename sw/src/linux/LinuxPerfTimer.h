@@ -0,0 +1,48 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+
+namespace kc1fsz {
+
+/**
+ * @brief Elapsed time measurement for the Linux build, the counterpart 
+ * of PicoPerfTimer.
+ */
+class LinuxPerfTimer {
+public:
+
+    LinuxPerfTimer() { reset(); }
+
+    void reset() { _start = std::chrono::steady_clock::now(); }
+
+    uint32_t elapsedUs() const {
+        return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - _start).count();
+    }
+
+private:
+
+    std::chrono::steady_clock::time_point _start;
+};
+
+}
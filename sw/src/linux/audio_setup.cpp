@@ -0,0 +1,227 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <thread>
+#include <chrono>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "AudioCore.h"
+#include "i2s_setup.h"
+#include "linux/LinuxPerfTimer.h"
+
+// Linux implementation of i2s_setup.h. 
+//
+// The CODEC is replaced by a pair of files in the same format as the 
+// CODEC DMA buffers: signed 32-bit little-endian, two channels 
+// interleaved (left is radio 1, right is radio 0), 32k samples/second.
+// This is what "arecord/aplay -f S32_LE -c 2 -r 32000" use.
+//
+//   SDRC_AUDIO_IN   Receive audio. A FIFO or a device sets the pace
+//                   of the audio processing, the same way that the 
+//                   CODEC does on the board. Otherwise (a plain file, 
+//                   or nothing) a timer is used and silence is sent 
+//                   once the file runs out.
+//   SDRC_AUDIO_OUT  Transmit audio. Blocks are dropped if the reader 
+//                   can't keep up.
+//
+// The Pico splits the work between the DMA interrupt on core0 (the 
+// sync callback) and core1 (the processing callback). Here both run 
+// on one audio thread, which gives the same guarantee that the sync 
+// callback never overlaps with the processing.
+
+using namespace kc1fsz;
+
+uint32_t longestIsr = 0;
+
+static audio_block_processor processor_cb = 0;
+static audio_block_sync sync_cb = 0;
+
+static int in_fd = -1;
+static int out_fd = -1;
+static bool paced_by_input = false;
+
+// Same meaning as the Pico counters. The "core0" numbers are the sync 
+// callback and the "core1" numbers are the processing callback.
+static volatile uint32_t block_count = 0;
+static volatile uint32_t late_count = 0;
+static volatile uint32_t core0_last_us = 0;
+static volatile uint32_t core0_max_us = 0;
+static volatile uint32_t core0_total_us = 0;
+static volatile uint32_t core1_last_us = 0;
+static volatile uint32_t core1_max_us = 0;
+static volatile uint32_t core1_total_us = 0;
+static uint32_t out_dropped = 0;
+
+/**
+ * Reads one complete block, or returns false if there isn't one.
+ */
+static bool read_block(int32_t* buf, unsigned len) {
+    if (in_fd < 0)
+        return false;
+    uint8_t* p = (uint8_t*)buf;
+    unsigned got = 0;
+    while (got < len) {
+        ssize_t rc = read(in_fd, p + got, len - got);
+        if (rc > 0)
+            got += rc;
+        else if (rc < 0 && errno == EINTR)
+            continue;
+        else {
+            // End of file (or the writer went away)
+            close(in_fd);
+            in_fd = -1;
+            return false;
+        }
+    }
+    return true;
+}
+
+static void process_block(const int32_t* adc_data, int32_t* dac_data) {
+
+    int32_t r0_samples[ADC_SAMPLE_COUNT];
+    int32_t r1_samples[ADC_SAMPLE_COUNT];
+    int32_t r0_out[ADC_SAMPLE_COUNT];
+    int32_t r1_out[ADC_SAMPLE_COUNT];
+
+    // This separates the radio 0/1 streams.
+    unsigned j = 0;
+    for (unsigned int i = 0; i < ADC_SAMPLE_COUNT; i++) {
+        r1_samples[i] = adc_data[j++];
+        r0_samples[i] = adc_data[j++];
+    }
+
+    processor_cb(r0_samples, r1_samples, r0_out, r1_out);
+
+    j = 0;
+    for (unsigned int i = 0; i < ADC_SAMPLE_COUNT; i++) {
+        dac_data[j++] = r1_out[i];
+        dac_data[j++] = r0_out[i];
+    }
+}
+
+static void audio_thread() {
+
+    const std::chrono::nanoseconds period((uint64_t)ADC_SAMPLE_COUNT * 
+        1000000000ULL / AudioCore::FS_ADC);
+    auto next = std::chrono::steady_clock::now();
+
+    int32_t adc_data[ADC_SAMPLE_COUNT * 2];
+    int32_t dac_data[ADC_SAMPLE_COUNT * 2];
+    memset(dac_data, 0, sizeof(dac_data));
+    LinuxPerfTimer timer;
+
+    while (true) {
+
+        if (paced_by_input && in_fd >= 0) {
+            // Wait for the "CODEC"
+            if (!read_block(adc_data, sizeof(adc_data)))
+                memset(adc_data, 0, sizeof(adc_data));
+            next = std::chrono::steady_clock::now();
+        } else {
+            next += period;
+            std::this_thread::sleep_until(next);
+            if (!read_block(adc_data, sizeof(adc_data)))
+                memset(adc_data, 0, sizeof(adc_data));
+        }
+        block_count = block_count + 1;
+
+        // If the previous block ran past the start of this one then 
+        // this one is dropped, the same as the board does when core1 
+        // is busy. 
+        if (!paced_by_input && std::chrono::steady_clock::now() - next > period) {
+            late_count = late_count + 1;
+            continue;
+        }
+
+        timer.reset();
+        if (sync_cb)
+            sync_cb();
+        uint32_t t = timer.elapsedUs();
+        if (t > longestIsr)
+            longestIsr = t;
+        core0_last_us = t;
+        if (t > core0_max_us)
+            core0_max_us = t;
+        core0_total_us = core0_total_us + t;
+
+        timer.reset();
+        process_block(adc_data, dac_data);
+        t = timer.elapsedUs();
+        core1_last_us = t;
+        if (t > core1_max_us)
+            core1_max_us = t;
+        core1_total_us = core1_total_us + t;
+
+        if (out_fd >= 0) {
+            ssize_t rc = write(out_fd, dac_data, sizeof(dac_data));
+            if (rc != (ssize_t)sizeof(dac_data))
+                out_dropped++;
+        }
+    }
+}
+
+void audio_get_load(audio_load* load) {
+    load->blockCount = block_count;
+    load->lateCount = late_count;
+    load->core0LastUs = core0_last_us;
+    load->core0MaxUs = core0_max_us;
+    load->core0TotalUs = core0_total_us;
+    load->core1LastUs = core1_last_us;
+    load->core1MaxUs = core1_max_us;
+    load->core1TotalUs = core1_total_us;
+}
+
+void audio_setup(audio_block_processor cb, audio_block_sync scb) {
+
+    processor_cb = cb;
+    sync_cb = scb;
+
+    const char* inFn = getenv("SDRC_AUDIO_IN");
+    if (inFn) {
+        in_fd = open(inFn, O_RDONLY);
+        if (in_fd < 0) {
+            printf("Unable to open audio input %s\n", inFn);
+        } else {
+            struct stat st;
+            fstat(in_fd, &st);
+            paced_by_input = !S_ISREG(st.st_mode);
+        }
+    }
+
+    const char* outFn = getenv("SDRC_AUDIO_OUT");
+    if (outFn) {
+        struct stat st;
+        // Don't wait around for a FIFO reader
+        if (stat(outFn, &st) == 0 && S_ISFIFO(st.st_mode))
+            out_fd = open(outFn, O_RDWR | O_NONBLOCK);
+        else
+            out_fd = open(outFn, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out_fd < 0)
+            printf("Unable to open audio output %s\n", outFn);
+    }
+
+    std::thread(audio_thread).detach();
+}
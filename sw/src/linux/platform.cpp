@@ -0,0 +1,128 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <chrono>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <sys/time.h>
+
+#include "platform.h"
+
+// Linux implementation of platform.h. The console is the terminal that
+// the program is started from, put into raw mode so that single key 
+// presses work like they do on the serial console. The watchdog is an
+// interval timer that aborts the process if the main loop stalls, which
+// leaves a core dump (and a sanitizer report) behind.
+
+namespace kc1fsz {
+
+static bool consoleIsTty = false;
+static struct termios savedTermios;
+static unsigned watchdogMs = 0;
+static std::chrono::steady_clock::time_point watchdogArmed;
+
+static void restoreConsole() {
+    if (consoleIsTty)
+        tcsetattr(STDIN_FILENO, TCSANOW, &savedTermios);
+    // Show cursor, the status page turns it off
+    printf("\033[?25h");
+    fflush(stdout);
+}
+
+static void exitSignal(int) {
+    // Exits through the atexit() handler
+    exit(0);
+}
+
+static void watchdogSignal(int) {
+    // Not much is safe in a signal handler
+    const char msg[] = "\nWatchdog timeout\n";
+    if (write(STDERR_FILENO, msg, sizeof(msg) - 1) < 0) { }
+    if (consoleIsTty)
+        tcsetattr(STDIN_FILENO, TCSANOW, &savedTermios);
+    abort();
+}
+
+void platform_setup() {
+
+    if (isatty(STDIN_FILENO)) {
+        tcgetattr(STDIN_FILENO, &savedTermios);
+        consoleIsTty = true;
+        struct termios t = savedTermios;
+        // No line editing or echo, but Ctrl-C still works
+        t.c_lflag &= ~(ICANON | ECHO);
+        t.c_cc[VMIN] = 0;
+        t.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &t);
+    }
+    fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+    atexit(restoreConsole);
+    signal(SIGINT, exitSignal);
+    signal(SIGTERM, exitSignal);
+
+    // The log and the status page are written a line at a time
+    setvbuf(stdout, 0, _IOLBF, 0);
+}
+
+void platform_sleep_ms(unsigned ms) {
+    usleep(ms * 1000);
+}
+
+int console_getc() {
+    unsigned char c;
+    if (read(STDIN_FILENO, &c, 1) == 1)
+        return c;
+    return -1;
+}
+
+bool platform_watchdog_caused_reboot() {
+    return false;
+}
+
+static void armWatchdog() {
+    watchdogArmed = std::chrono::steady_clock::now();
+    struct itimerval it = { };
+    it.it_value.tv_sec = watchdogMs / 1000;
+    it.it_value.tv_usec = (watchdogMs % 1000) * 1000;
+    setitimer(ITIMER_REAL, &it, 0);
+}
+
+void platform_watchdog_enable(unsigned intervalMs) {
+    // Turn it off with SDRC_NO_WATCHDOG=1 when using a debugger
+    if (getenv("SDRC_NO_WATCHDOG"))
+        return;
+    watchdogMs = intervalMs;
+    signal(SIGALRM, watchdogSignal);
+    armWatchdog();
+}
+
+void platform_watchdog_update() {
+    // This is called on every pass through the main loop, so only go 
+    // to the kernel once in a while.
+    if (watchdogMs && std::chrono::steady_clock::now() - watchdogArmed > 
+        std::chrono::milliseconds(watchdogMs / 4))
+        armWatchdog();
+}
+
+}
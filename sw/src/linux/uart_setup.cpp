@@ -0,0 +1,184 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+
+#include "LinkSession.h"
+#include "uart_setup.h"
+
+// Linux implementation of uart_setup.h. 
+//
+// The link runs over a pseudo-terminal. By default a new one is created
+// and the name of the other end is printed at startup. Another instance
+// can be pointed at it with SDRC_LINK=/dev/pts/N, and SDRC_LINK can also
+// be a real serial port (e.g. a USB adapter wired to a board).
+//
+// The link processing (the low priority link interrupt on the Pico) 
+// runs on its own thread, which is woken up by the audio thread once 
+// per block.
+
+namespace kc1fsz {
+
+#define UART_RX_BUF_SIZE 512
+#define UART_TX_BUF_SIZE 4096
+#define RX_CHUNK_SIZE (UART_RX_BUF_SIZE - MAX_NETWORK_MESSAGE_SIZE)
+// How long the link thread waits if it isn't woken up by the audio
+#define LINK_IDLE_MS (20)
+
+static bool enabled = false;
+static int link_fd = -1;
+
+static uint8_t rx_buf[UART_RX_BUF_SIZE];
+static unsigned rx_wr_ptr = 0;
+
+static uint8_t tx_buf[UART_TX_BUF_SIZE];
+static unsigned tx_len = 0;
+
+static LinkSession session(rx_buf, UART_RX_BUF_SIZE);
+
+static std::mutex link_mutex;
+static std::condition_variable link_cv;
+static bool link_pending = false;
+
+static void link_set_pending() {
+    {
+        std::lock_guard<std::mutex> lock(link_mutex);
+        link_pending = true;
+    }
+    link_cv.notify_one();
+}
+
+/** 
+ * @returns 0 If the entire message was accepted
+ */
+static int queueForTx(const uint8_t* data, unsigned len) {
+    if (len > UART_TX_BUF_SIZE - tx_len)
+        return -1;
+    memcpy(tx_buf + tx_len, data, len);
+    tx_len += len;
+    return 0;
+}
+
+static void link_process() {
+
+    // Pull in whatever has arrived. The receive buffer is circular, like 
+    // the DMA ring on the board. It is read in small pieces that are 
+    // processed as they come in so that a burst can't lap the reader, 
+    // which may be holding on to a partial message.
+    while (true) {
+        unsigned space = UART_RX_BUF_SIZE - rx_wr_ptr;
+        if (space > RX_CHUNK_SIZE)
+            space = RX_CHUNK_SIZE;
+        ssize_t rc = read(link_fd, rx_buf + rx_wr_ptr, space);
+        if (rc <= 0)
+            break;
+        rx_wr_ptr = (rx_wr_ptr + rc) & (UART_RX_BUF_SIZE - 1);
+        session.processRx(rx_wr_ptr);
+    }
+
+    session.processTx(queueForTx);
+
+    // Send as much as the terminal will take
+    if (tx_len) {
+        ssize_t rc = write(link_fd, tx_buf, tx_len);
+        if (rc > 0) {
+            memmove(tx_buf, tx_buf + rc, tx_len - rc);
+            tx_len -= rc;
+        }
+    }
+}
+
+static void link_thread() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(link_mutex);
+            link_cv.wait_for(lock, std::chrono::milliseconds(LINK_IDLE_MS), 
+                []() { return link_pending; });
+            link_pending = false;
+        }
+        link_process();
+    }
+}
+
+void streaming_uart_setup() {
+
+    const char* fn = getenv("SDRC_LINK");
+    if (fn) {
+        link_fd = open(fn, O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (link_fd < 0) {
+            printf("Unable to open link %s\n", fn);
+            return;
+        }
+        printf("Link on %s\n", fn);
+    } else {
+        link_fd = posix_openpt(O_RDWR | O_NOCTTY);
+        if (link_fd < 0 || grantpt(link_fd) != 0 || unlockpt(link_fd) != 0) {
+            printf("Unable to create link pty\n");
+            return;
+        }
+        fcntl(link_fd, F_SETFL, fcntl(link_fd, F_GETFL) | O_NONBLOCK);
+        printf("Link on %s\n", ptsname(link_fd));
+    }
+
+    // Binary data, no line discipline
+    struct termios t;
+    if (tcgetattr(link_fd, &t) == 0) {
+        cfmakeraw(&t);
+        tcsetattr(link_fd, TCSANOW, &t);
+    }
+
+    std::thread(link_thread).detach();
+    enabled = true;
+}
+
+// ****************************************************************************
+// NOTE: This function is called from the audio thread so keep it short!
+// ****************************************************************************
+void networkAudioReceiveIfAvailable(receive_processor cb) {
+    if (!enabled) 
+        return;
+    session.receive(cb);
+    link_set_pending();
+}
+
+void networkAudioSetCodec(unsigned codec) {
+    session.setCodec(codec);
+}
+
+// ****************************************************************************
+// NOTE: This function is called from the audio thread so keep it short!
+// ****************************************************************************
+void networkAudioSend(const uint8_t* frame, unsigned len) { 
+    if (enabled) {
+        session.send(frame, len);
+        link_set_pending();
+    }
+}
+
+}
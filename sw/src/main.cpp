@@ -27,34 +27,31 @@ When targeting RP2350 (Pico 2), command used to load code onto the board:
 #include <cstring>
 #include <cmath>
 
-#include "pico/stdlib.h"
-#include "pico/time.h"
-#include "hardware/clocks.h"
-#include "hardware/watchdog.h"
-#include <pico/platform.h>
-
-#include "hardware/dma.h"
-#include "hardware/uart.h"
-
 #include "kc1fsz-tools/Log.h"
 #include "kc1fsz-tools/StdPollTimer.h"
 #include "kc1fsz-tools/CommandShell.h"
 #include "kc1fsz-tools/OutStream.h"
 #include "kc1fsz-tools/WindowAverage.h"
 #include "kc1fsz-tools/DTMFDetector2.h"
-#include "kc1fsz-tools/rp2040/PicoPerfTimer.h"
-#include "kc1fsz-tools/rp2040/PicoClock.h"
 
-#include "StdTx.h"
-#include "StdRx.h"
 #include "Config.h"
-#include "TxControl.h"
 #include "ShellCommand.h"
-#include "AudioCore.h"
-#include "AudioCoreOutputPortStd.h"
-#include "CommandProcessor.h"
-#include "DigitalAudioPort.h"
+#include "Controller.h"
 
+// The hardware backend
+#ifdef PICO_BUILD
+#include "kc1fsz-tools/rp2040/PicoPerfTimer.h"
+#include "kc1fsz-tools/rp2040/PicoClock.h"
+#include "PicoGpio.h"
+#include "PicoConfigFlash.h"
+#else
+#include "linux/LinuxPerfTimer.h"
+#include "linux/LinuxClock.h"
+#include "linux/LinuxGpio.h"
+#include "linux/LinuxConfigFlash.h"
+#endif
+
+#include "platform.h"
 #include "i2s_setup.h"
 #include "uart_setup.h"
 
@@ -77,8 +74,6 @@ static const char* VERSION = "V1.2 2026-01-31";
 #define R1_CTCSS_PIN (16)
 #define R1_PTT_PIN (15)
 #define LED2_PIN (18)
-#define CONSOLE_TX_PIN (0)
-#define CONSOLE_RX_PIN (1)
 */
 
 // THIS IS THE SETUP FOR DIGITAL-3 (2026-01) 
@@ -92,13 +87,8 @@ static const char* VERSION = "V1.2 2026-01-31";
 #define R1_PTT_PIN (15)
 #define LED2_PIN (19)
 #define LED3_PIN (18)
-#define CONSOLE_TX_PIN (16)
-#define CONSOLE_RX_PIN (17)
 
-// System clock rate
-#define SYS_KHZ (153600)
 #define WATCHDOG_INTERVAL_MS (2000)
-#define UART0_BAUD (460800)
 
 // ===========================================================================
 // DIAGNOSTIC COUNTERS/FLAGS
@@ -114,13 +104,23 @@ extern uint32_t longestIsr;
 // The global configuration parameters
 static Config config;
 
-static PicoClock clock;
+// The board. The clock isn't called "clock" because that clashes with 
+// clock() from the C library on Linux.
+#ifdef PICO_BUILD
+static PicoConfigFlash configFlash;
+static PicoClock sysClock;
 static PicoPerfTimer perfTimerLoop;
-
-static AudioCore core0(0, 3, clock);
-static AudioCore core1(1, 3, clock);
-// This core is the digital audio input port
-static DigitalAudioPort core2(2, 3, clock);
+static PicoGpio gpio;
+#else
+static LinuxConfigFlash configFlash;
+static LinuxClock sysClock;
+static LinuxPerfTimer perfTimerLoop;
+static LinuxGpio gpio;
+#endif
+
+// Everything that makes up the repeater. This is created in main() 
+// but is also needed by the audio callbacks.
+static Controller* controller = 0;
 
 // The console can work in one of three modes:
 // 
@@ -141,12 +141,14 @@ public:
     bool isWritable() const { return true; }
 };
 
-static void __not_in_flash_func(network_audio_proc)(const uint8_t* buf, unsigned bufLen) {
-    core2.loadNetworkAudio(buf, bufLen);
+static void __not_in_flash_func(network_audio_proc)(uint8_t seq, const uint8_t* buf, 
+    unsigned bufLen) {
+    controller->getNetworkPort().loadNetworkAudio(seq, buf, bufLen);
 }
 
 // ****************************************************************************
-// NOTE: This function is called from inside of the audio frame ISR so keep it 
+// NOTE: This function is called on core1 once per audio block. Nothing
+// else runs on core1 so we have the full block period, but keep it 
 // short!
 // ****************************************************************************
 //
@@ -154,23 +156,25 @@ static void __not_in_flash_func(network_audio_proc)(const uint8_t* buf, unsigned
 //
 static void audio_proc(const int32_t* r0_samples, const int32_t* r1_samples,
     int32_t* r0_out, int32_t* r1_out) {
-    
-    // Try to pull an audio frame from the network and load it into core2.
-    networkAudioReceiveIfAvailable(network_audio_proc);
+    controller->audioCycle(r0_samples, r1_samples, r0_out, r1_out);
+}
 
-    float r0_cross[ADC_SAMPLE_COUNT / 4];
-    float r1_cross[ADC_SAMPLE_COUNT / 4];
-    float r2_cross[ADC_SAMPLE_COUNT / 4];
-    const float* cross_ins[3] = { r0_cross, r1_cross, r2_cross };
+// ****************************************************************************
+// NOTE: This function is called from inside of the audio frame ISR on core0
+// so keep it short!
+// ****************************************************************************
+//
+// This is called once per audio tick at a point where core1 is known to be 
+// idle. The network link exchanges audio with core2 here. Only decoded 
+// PCM frames are moved here, the framing/CRC/UART work happens in the
+// (lower priority) link interrupt.
+//
+static void audio_sync() {
 
-    core0.cycleRx(r0_samples, r0_cross);
-    core1.cycleRx(r1_samples, r1_cross);
-    // There is no ADC input in this case:
-    core2.cycleRx(r2_cross);
-    core0.cycleTx(cross_ins, r0_out);
-    core1.cycleTx(cross_ins, r1_out);
-    // There is no DAC output in this case:
-    core2.cycleTx(cross_ins);
+    DigitalAudioPort& core2 = controller->getNetworkPort();
+
+    // Try to pull an audio frame from the network and load it into core2.
+    networkAudioReceiveIfAvailable(network_audio_proc);
 
     if (core2.isNetworkAudioPending()) {
 
@@ -224,8 +228,56 @@ static void print_bar(float vrms, float vpeak) {
     printf("\033[0m");
 }
 
-static void render_status(const Rx& rx0, const Rx& rx1, const Tx& tx0, const Tx& tx1,
-    const TxControl& txc0, const TxControl& txc1) {
+static void print_tone_scan(const AudioCore& core) {
+    int tone = core.getCtcssScanTone();
+    if (tone < 0)
+        printf("Tone scan: -                \n");
+    else
+        printf("Tone scan: %5.1f Hz %5.1f dBv   \n", CtcssScanner::TONES[tone],
+            AudioCore::vrmsToDbv(core.getCtcssScanRms()));
+}
+
+// Used to compute the average load between two status updates
+static audio_load lastLoad = { 0 };
+// Used to track the number of late audio blocks during a config save
+static bool saveActive = false;
+static uint32_t saveStartLateCount = 0;
+static uint32_t lastSaveLateCount = 0;
+
+static void render_load() {
+    audio_load load;
+    audio_get_load(&load);
+    uint32_t blocks = load.blockCount - lastLoad.blockCount;
+    if (blocks > 0) {
+        const float blockUs = 1000000.0 * (float)ADC_SAMPLE_COUNT / 
+            (float)AudioCore::FS_ADC;
+        float periodUs = blockUs * (float)blocks;
+        float core0Pct = 100.0 * (float)(load.core0TotalUs - lastLoad.core0TotalUs) / periodUs;
+        float core1Pct = 100.0 * (float)(load.core1TotalUs - lastLoad.core1TotalUs) / periodUs;
+        printf("Load core0 %4.1f%% (max %u us), core1 %4.1f%% (max %u us), late %u (last save %u)      \n",
+            core0Pct, load.core0MaxUs, core1Pct, load.core1MaxUs, load.lateCount, lastSaveLateCount);
+    }
+    lastLoad = load;
+}
+
+static void render_jitter(DigitalAudioPort& core2) {
+    JitterBuffer::Stats js;
+    core2.getJitterStats(&js);
+    printf("Net depth %3u ms (target %3u ms), jitter %4.1f ms, drift %+5.0f ppm, underrun %u, overrun %u, late %u, concealed %u      \n",
+        js.depth / 8, js.target / 8, (float)js.jitterUs / 1000.0, core2.getDriftPpm(),
+        js.underruns, js.overruns, js.late, js.concealed);
+}
+
+static void render_status(Controller& ctl) {
+
+    const Rx& rx0 = ctl.getRx(0);
+    const Rx& rx1 = ctl.getRx(1);
+    const Tx& tx0 = ctl.getTx(0);
+    const Tx& tx1 = ctl.getTx(1);
+    const TxControl& txc0 = ctl.getTxControl(0);
+    const TxControl& txc1 = ctl.getTxControl(1);
+    AudioCore& core0 = ctl.getCore(0);
+    AudioCore& core1 = ctl.getCore(1);
 
     printf("\033[H");
     printf("W1TKZ Software Defined Repeater Controller (%s)\n", VERSION);
@@ -284,6 +336,7 @@ static void render_status(const Rx& rx0, const Rx& rx1, const Tx& tx0, const Tx&
         core0.getNoiseRms(), core0.getSignalRms2(),
         AudioCore::db(core0.getSignalRms() / core0.getNoiseRms()));
     printf("Tone dBFS: %f\n", AudioCore::vrmsToDbv(core0.getCtcssDecodeRms()));
+    print_tone_scan(core0);
     printf("AGC gain: %.1f\n", AudioCore::db(core0.getAgcGain()));
     printf("\n");
                 
@@ -341,46 +394,13 @@ static void render_status(const Rx& rx0, const Rx& rx1, const Tx& tx0, const Tx&
         core1.getSignalRms(),
         AudioCore::db(core1.getSignalRms() / core1.getNoiseRms()));
     printf("Tone dBFS: %f\n", AudioCore::vrmsToDbv(core1.getCtcssDecodeRms()));
+    print_tone_scan(core1);
     printf("AGC gain: %.1f\n", AudioCore::db(core1.getAgcGain()));
     printf("\n");
 
     printf("%u / %u / %d / %d      \n", longestIsr, longestLoop, txc0.getState(), txc1.getState());
-}
-
-static void transferConfigRx(const Config::ReceiveConfig& config, Rx& rx) {
-    rx.setCosMode((Rx::CosMode)config.cosMode);
-    rx.setCosActiveTime(config.cosActiveTime);
-    rx.setCosInactiveTime(config.cosInactiveTime);
-    rx.setCosLevel(config.cosLevel);
-    rx.setToneMode((Rx::ToneMode)config.toneMode);
-    rx.setToneActiveTime(config.toneActiveTime);
-    rx.setToneInactiveTime(config.toneInactiveTime);
-    rx.setToneLevel(config.toneLevel);
-    rx.setToneFreq(config.toneFreq);
-    rx.setGainLinear(AudioCore::dbToLinear(config.gain));
-    rx.setDelayTime(config.delayTime);
-    rx.setDtmfDetectLevel(config.dtmfDetectLevel);
-    rx.setDeemphMode(config.deemphMode);
-}
-
-static void transferConfigTx(const Config::TransmitConfig& config, Tx& tx) {
-    tx.setEnabled((bool)config.enabled);
-    tx.setPLToneMode((Tx::PLToneMode)config.toneMode);
-    tx.setPLToneLevel(config.toneLevel);
-    tx.setPLToneFreq(config.toneFreq);
-    tx.setCtMode((CourtesyToneGenerator::Type)config.ctMode);
-}
-
-static void transferControlConfig(const Config::ControlConfig& config, TxControl& txc,
-    AudioCoreOutputPortStd& acop) {
-    txc.setTimeoutTime(config.timeoutTime);
-    txc.setLockoutTime(config.lockoutTime);
-    txc.setHangTime(config.hangTime);
-    txc.setCtLevel(config.ctLevel);
-    txc.setIdMode(config.idMode);
-    txc.setIdLevel(config.idLevel);
-    for (unsigned i = 0; i < Config::maxReceivers; i++)
-        acop.setEligible(i, config.rxEligible[i]);
+    render_load();
+    render_jitter(ctl.getNetworkPort());
 }
 
 /**
@@ -389,90 +409,49 @@ static void transferControlConfig(const Config::ControlConfig& config, TxControl
  * This needs to happen once at started and then any 
  * time that the configuration is changed.
  */
-static void transferConfig(const Config& config,
-    Rx& rx0, Rx& rx1,
-    Tx& tx0, Tx& tx1,
-    TxControl& txc0, TxControl& txc1,
-    AudioCore& core0, AudioCore& core1,
-    AudioCoreOutputPortStd& acop0, AudioCoreOutputPortStd& acop1) 
-{
-    // General configuration
-    txc0.setCall(config.general.callSign);
-    txc0.setPass(config.general.pass);
-    txc0.setIdRequiredInt(config.general.idRequiredInt);
-    txc0.setDiagToneFreq(config.general.diagFreq);
-    txc0.setDiagToneLevel(config.general.diagLevel);
-
-    txc1.setCall(config.general.callSign);
-    txc1.setPass(config.general.pass);
-    txc1.setIdRequiredInt(config.general.idRequiredInt);
-    txc1.setDiagToneFreq(config.general.diagFreq);
-    txc1.setDiagToneLevel(config.general.diagLevel);
-
-    // Receiver configuration
-    transferConfigRx(config.rx0, rx0);
-    transferConfigRx(config.rx1, rx1);
-
-    // Transmitter configuration
-    transferConfigTx(config.tx0, tx0);
-    transferConfigTx(config.tx1, tx1);
-
-    // Controller configuration
-    transferControlConfig(config.txc0, txc0, acop0);
-    transferControlConfig(config.txc1, txc1, acop1);
+static void transferConfig(Controller& ctl) {
+    ctl.transferConfig();
+    networkAudioSetCodec(config.general.linkCodec);
 }
 
 int main(int argc, const char** argv) {
 
-    // Adjust system clock to more evenly divide the 
-    // audio sampling frequency.
-    set_sys_clock_khz(SYS_KHZ, true);
-
-    // Very high speed
-    stdio_uart_init_full(uart0, UART0_BAUD, CONSOLE_TX_PIN, CONSOLE_RX_PIN);
+    // System clock and console
+    platform_setup();
     streaming_uart_setup();
 
-    gpio_init(LED_PIN);
-    gpio_set_dir(LED_PIN, GPIO_OUT);
-    gpio_init(LED2_PIN);
-    gpio_set_dir(LED2_PIN, GPIO_OUT);
+    gpio.init(LED_PIN, true);
+    gpio.init(LED2_PIN, true);
     
-    gpio_init(R0_COS_PIN);
-    gpio_set_dir(R0_COS_PIN, GPIO_IN);
-    gpio_init(R0_CTCSS_PIN);
-    gpio_set_dir(R0_CTCSS_PIN, GPIO_IN);
-    gpio_init(R0_PTT_PIN);
-    gpio_set_dir(R0_PTT_PIN, GPIO_OUT);
-    gpio_put(R0_PTT_PIN, 0);
-    gpio_init(R1_COS_PIN);
-    gpio_set_dir(R1_COS_PIN, GPIO_IN);
-    gpio_init(R1_CTCSS_PIN);
-    gpio_set_dir(R1_CTCSS_PIN, GPIO_IN);
-    gpio_init(R1_PTT_PIN);
-    gpio_set_dir(R1_PTT_PIN, GPIO_OUT);
-    gpio_put(R1_PTT_PIN, 0);
+    gpio.init(R0_COS_PIN, false);
+    gpio.init(R0_CTCSS_PIN, false);
+    gpio.init(R0_PTT_PIN, true);
+    gpio.init(R1_COS_PIN, false);
+    gpio.init(R1_CTCSS_PIN, false);
+    gpio.init(R1_PTT_PIN, true);
 
     // Startup ID
-    sleep_ms(500);
-    gpio_put(LED_PIN, 1);
-    sleep_ms(500);
-    gpio_put(LED_PIN, 0);
+    platform_sleep_ms(500);
+    gpio.put(LED_PIN, 1);
+    platform_sleep_ms(500);
+    gpio.put(LED_PIN, 0);
 
     UIMode uiMode = UIMode::UIMODE_LOG;
-    Log log(&clock);
+    Log log(&sysClock);
     log.setEnabled(true);
 
     log.info("W1TKZ Software Defined Repeater Controller");
     log.info("Copyright (C) 2025 Bruce MacKinnon KC1FSZ");
     log.info("Firmware %s", VERSION);
 
-    if (watchdog_enable_caused_reboot()) {
+    if (platform_watchdog_caused_reboot()) {
         log.info("Rebooted by watchdog timer");
     } else {
         log.info("Clean boot");
     }
 
     // ----- READ CONFIGURATION FROM FLASH ------------------------------------
+    Config::setFlash(&configFlash);
     Config::loadConfig(&config);
     if (!config.isValid()) {
         log.info("Invalid config, setting factory default");
@@ -481,50 +460,26 @@ int main(int argc, const char** argv) {
     }
 
     // Enable the watchdog, requiring the watchdog to be updated or the chip 
-    // will reboot. The second arg is "pause on debug" which means 
-    // the watchdog will pause when stepping through code. From SDK docs:
-    //
-    // pause_on_debug: If set to true, the watchdog will pause its countdown 
-    // when a debugger is connected and active. This is useful during development 
-    // to prevent unexpected resets.
-    //watchdog_enable(WATCHDOG_INTERVAL_MS, 1);
-    // In production we turn this feature off
-    watchdog_enable(WATCHDOG_INTERVAL_MS, 0);
-
-    // Enable audio processing 
-    audio_setup(audio_proc);
+    // will reboot.
+    platform_watchdog_enable(WATCHDOG_INTERVAL_MS);
+
+    sysClock.reset();
+
+    // The controller is too big for the stack
+    const Controller::Pins pins = { R0_COS_PIN, R0_CTCSS_PIN, R0_PTT_PIN, 
+        R1_COS_PIN, R1_CTCSS_PIN, R1_PTT_PIN };
+    static Controller ctl(sysClock, log, gpio, config, pins);
+    controller = &ctl;
+
+    // Enable audio processing. The DSP runs on core1 from here on.
+    audio_setup(audio_proc, audio_sync);
 
     int strobe = 0;
     bool liveDisplay = false;
     bool liveLED = false;
 
-    clock.reset();
-
     // Display/diagnostic should happen twice per second
-    StdPollTimer flashTimer(clock, 500 * 1000);
-
-    StdTx tx0(clock, log, 0, R0_PTT_PIN, core0,
-        // IMPORTANT SAFETY MECHANISM: Polled to control keying
-        []() {
-            return config.tx0.enabled2;
-        }
-    );
-    StdTx tx1(clock, log, 1, R1_PTT_PIN, core1,
-        // IMPORTANT SAFETY MECHANISM: Polled to control keying
-        []() {
-            return config.tx1.enabled2;
-        }
-    );
-
-    StdRx rx0(clock, log, 0, R0_COS_PIN, R0_CTCSS_PIN, core0);
-    StdRx rx1(clock, log, 1, R1_COS_PIN, R1_CTCSS_PIN, core1);
-
-    // #### TODO: REVIEW THIS TEMPORARY BRIDGE CLASS
-    AudioCoreOutputPortStd acop0(core0, rx0, rx1, core2);
-    AudioCoreOutputPortStd acop1(core1, rx0, rx1, core2);
-
-    TxControl txCtl0(clock, log, tx0, acop0);
-    TxControl txCtl1(clock, log, tx1, acop1);
+    StdPollTimer flashTimer(sysClock, 500 * 1000);
 
     int i = 0;
 
@@ -546,32 +501,41 @@ int main(int argc, const char** argv) {
             log.setEnabled(false);
         },
         // Config change trigger
-        [&rx0, &rx1, &tx0, &tx1, &txCtl0, &txCtl1, &acop0, &acop1, &log]() {
+        [&log]() {
             // If anything in the configuration structure is 
             // changed then we force a transfer of all config
             // parameters from the config structure and into 
             // the controller objects.
             log.info("Transferring configuration");
-            transferConfig(config, rx0, rx1, tx0, tx1, txCtl0, txCtl1, core0, core1, acop0, acop1);
+            transferConfig(ctl);
         },
         // ID trigger
-        [&txCtl0, &txCtl1, &log]() {
-            txCtl0.forceId();
-            txCtl1.forceId();        
+        []() {
+            ctl.forceId();
         },
         // Test start trigger
-        [&txCtl0, &txCtl1](int r) {
-            if (r == 0)
-                txCtl0.startTest();
-            else if (r == 1)
-                txCtl1.startTest();
+        [](int r) {
+            ctl.startTest(r);
         },
         // Test stop trigger
-        [&txCtl0, &txCtl1](int r) {
-            if (r == 0)
-                txCtl0.stopTest();
-            else if (r == 1)
-                txCtl1.stopTest();
+        [](int r) {
+            ctl.stopTest(r);
+        },
+        // Profile trigger
+        [](bool reset) {
+#ifdef AUDIO_PROFILE
+            if (reset) {
+                ctl.getCore(0).getProfiler().reset();
+                ctl.getCore(1).getProfiler().reset();
+            } else {
+                printf("Radio 0\n");
+                ctl.getCore(0).getProfiler().show();
+                printf("Radio 1\n");
+                ctl.getCore(1).getProfiler().show();
+            }
+#else
+            printf("Not available, build with -DAUDIO_PROFILE=ON\n");
+#endif
         }
         );
 
@@ -579,36 +543,8 @@ int main(int argc, const char** argv) {
     shell.setOutput(&shellOutput);
     shell.setSink(&shellCommand);
 
-    // DTMF Command processing
-    CommandProcessor dtmfCmdProc(log, clock);
-    dtmfCmdProc.setAccessTrigger([&log, &txCtl0, &txCtl1](bool enabled) {
-        if (enabled) {
-            log.info("Access enabled");
-        } else {
-            log.info("Access disabled");
-        }
-    });
-    dtmfCmdProc.setDisableTrigger([&log]() {
-        log.info("Disable");
-        config.tx0.enabled2 = false;
-        config.tx1.enabled2 = false;
-        // Make sure these settings are non-volatile
-        Config::saveConfig(&config);
-    });
-    dtmfCmdProc.setReenableTrigger([&log]() {
-        log.info("Reenable");
-        config.tx0.enabled2 = true;
-        config.tx1.enabled2 = true;
-        // Make sure these settings are non-volatile
-        Config::saveConfig(&config);
-    });
-    dtmfCmdProc.setForceIdTrigger([&txCtl0, &txCtl1]() {
-        txCtl0.forceId();
-        txCtl1.forceId();
-    });
-
     // Force initial config transfer
-    transferConfig(config, rx0, rx1, tx0, tx1, txCtl0, txCtl1, core0, core1, acop0, acop1);
+    transferConfig(ctl);
 
     // ===== Main Event Loop =================================================
 
@@ -616,11 +552,11 @@ int main(int argc, const char** argv) {
 
     while (true) { 
 
-        watchdog_update();
+        platform_watchdog_update();
 
         perfTimerLoop.reset();
 
-        int c = getchar_timeout_us(0);
+        int c = console_getc();
         bool flash = flashTimer.poll();
 
         if (uiMode == UIMode::UIMODE_LOG) {
@@ -636,8 +572,7 @@ int main(int argc, const char** argv) {
                 uiMode = UIMode::UIMODE_STATUS;
                 log.setEnabled(false);
             } else if (c == 'i') {
-                txCtl0.forceId();
-                txCtl1.forceId();
+                ctl.forceId();
             }
             //if (flash)
             //    printf("DTMF diag %f\n", core1.getDtmfDetectDiagValue());
@@ -650,7 +585,7 @@ int main(int argc, const char** argv) {
         else if (uiMode == UIMode::UIMODE_STATUS) {
             // Do periodic display/diagnostic stuff
             if (flash)
-                render_status(rx0, rx1, tx0, tx1, txCtl0, txCtl1);
+                render_status(ctl);
             if (c == 'l') {
                 // Clear off the status screen
                 printf("\033[2J");
@@ -670,79 +605,49 @@ int main(int argc, const char** argv) {
                 shell.reset();
             } 
             else if (c == 'i') {
-                txCtl0.forceId();
-                txCtl1.forceId();
+                ctl.forceId();
             }
         }
 
         // Running LED
         if (flash) {
             if (liveLED) 
-                gpio_put(LED_PIN, 1);
+                gpio.put(LED_PIN, 1);
             else
-                gpio_put(LED_PIN, 0);
+                gpio.put(LED_PIN, 0);
             liveLED = !liveLED;
         }
 
         // Transmit LED
-        if (tx0.getPtt() || tx1.getPtt()) 
-            gpio_put(LED2_PIN, 1);
+        if (ctl.getTx(0).getPtt() || ctl.getTx(1).getPtt()) 
+            gpio.put(LED2_PIN, 1);
         else
-            gpio_put(LED2_PIN, 0);
-
-        // Check for commands
-        char d0 = core0.getLastDtmfDetection();
-        if (d0 != 0) {
-            log.info("DTMF [%c]", d0);
-            dtmfCmdProc.processSymbol(d0);
-        }
-        char d1 = core1.getLastDtmfDetection();
-        if (d1 != 0) {
-            log.info("DTMF [%c]", d1);
-            dtmfCmdProc.processSymbol(d1);
-        }
+            gpio.put(LED2_PIN, 0);
 
-        // Mute receivers when command processing is going on
-        core0.setRxMute(dtmfCmdProc.isAccess());
-        core1.setRxMute(dtmfCmdProc.isAccess());
+        // DTMF commands, receiver routing, transmit state machines
+        ctl.run();
 
-        // ----- Adjust Receiver Routing/Mixing -----------------------------------
+        // ----- Background Configuration Save -----------------------------
         //
-        // This is an ongoing process of adjusting the "cross gains" of the 
-        // transmitter to make sure the audio from the correct receivers is 
-        // being mixed and passed through to this transmitter. 
-        // 
-        // This is a low-cost operation so, to simplify the logic, it is just
-        // done all the time.
-        unsigned activeCount = 0;
-        if (rx0.isActive())
-            activeCount++;
-        if (rx1.isActive())
-            activeCount++;
-        if (core2.isActive())
-            activeCount++;
-
-        // Divide the gain evenly across the active receivers
-        float gain = (activeCount != 0) ? 1.0 / (float)activeCount : 0;
-        core0.setCrossGainLinear(0, rx0.isActive() ? gain : 0.0);
-        core0.setCrossGainLinear(1, rx1.isActive() ? gain : 0.0);
-        core0.setCrossGainLinear(2, core2.isActive() ? gain : 0.0);
-        core1.setCrossGainLinear(0, rx0.isActive() ? gain : 0.0);
-        core1.setCrossGainLinear(1, rx1.isActive() ? gain : 0.0);
-        core1.setCrossGainLinear(2, core2.isActive() ? gain : 0.0);
-        core2.setCrossGainLinear(0, rx0.isActive() ? gain : 0.0);
-        core2.setCrossGainLinear(1, rx1.isActive() ? gain : 0.0);
-        // Never echo audio back on this connection
-        core2.setCrossGainLinear(2, 0.0);
-   
-        // Run all components
-        tx0.run();
-        tx1.run();
-        rx0.run();
-        rx1.run();
-        txCtl0.run();
-        txCtl1.run();
-        dtmfCmdProc.run();
+        // Saves are requested from the shell and the DTMF commands and 
+        // are written to flash a step at a time. The number of audio 
+        // blocks that were late during the save is recorded so that 
+        // we can confirm that the save has no impact on the audio.
+        if (Config::isSavePending()) {
+            if (!saveActive) {
+                audio_load load;
+                audio_get_load(&load);
+                saveStartLateCount = load.lateCount;
+                saveActive = true;
+            }
+            if (Config::runSave()) {
+                audio_load load;
+                audio_get_load(&load);
+                lastSaveLateCount = load.lateCount - saveStartLateCount;
+                saveActive = false;
+                log.info("Configuration saved (%u late blocks)", lastSaveLateCount);
+            }
+        }
 
         uint32_t t = perfTimerLoop.elapsedUs();
         if (t > longestLoop)
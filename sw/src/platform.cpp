@@ -0,0 +1,81 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/watchdog.h"
+
+#include "platform.h"
+
+namespace kc1fsz {
+
+/*
+// THIS IS THE SETUP FOR DIGITAL-2 (2025-05 B) 
+// -------------------------------------------
+#define CONSOLE_TX_PIN (0)
+#define CONSOLE_RX_PIN (1)
+*/
+
+// THIS IS THE SETUP FOR DIGITAL-3 (2026-01) 
+// -------------------------------------------
+#define CONSOLE_TX_PIN (16)
+#define CONSOLE_RX_PIN (17)
+
+// System clock rate
+#define SYS_KHZ (153600)
+#define UART0_BAUD (460800)
+
+void platform_setup() {
+    // Adjust system clock to more evenly divide the 
+    // audio sampling frequency.
+    set_sys_clock_khz(SYS_KHZ, true);
+    // Very high speed
+    stdio_uart_init_full(uart0, UART0_BAUD, CONSOLE_TX_PIN, CONSOLE_RX_PIN);
+}
+
+void platform_sleep_ms(unsigned ms) {
+    sleep_ms(ms);
+}
+
+int console_getc() {
+    // PICO_ERROR_TIMEOUT (-1) if nothing is waiting
+    return getchar_timeout_us(0);
+}
+
+bool platform_watchdog_caused_reboot() {
+    return watchdog_enable_caused_reboot();
+}
+
+void platform_watchdog_enable(unsigned intervalMs) {
+    // The second arg is "pause on debug" which means the watchdog will 
+    // pause when stepping through code. From SDK docs:
+    //
+    // pause_on_debug: If set to true, the watchdog will pause its countdown 
+    // when a debugger is connected and active. This is useful during development 
+    // to prevent unexpected resets.
+    //
+    // In production we turn this feature off
+    watchdog_enable(intervalMs, 0);
+}
+
+void platform_watchdog_update() {
+    watchdog_update();
+}
+
+}
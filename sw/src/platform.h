@@ -0,0 +1,71 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+// The parts of the board that main() needs and that aren't covered by 
+// the GPIO (Gpio.h), flash (ConfigFlash.h), audio (i2s_setup.h) and 
+// network link (uart_setup.h) interfaces: the system clock, the console
+// and the watchdog.
+//
+// platform.cpp is the Pico implementation and linux/platform.cpp is the 
+// Linux implementation. The backend is picked by what is linked.
+
+#ifdef PICO_BUILD
+#include <pico/platform.h>
+#else
+// Puts time-critical code in RAM on the Pico, nothing to do elsewhere
+#ifndef __not_in_flash_func
+#define __not_in_flash_func(f) f
+#endif
+#ifndef PICO_DEFAULT_LED_PIN
+#define PICO_DEFAULT_LED_PIN (25)
+#endif
+#endif
+
+namespace kc1fsz {
+
+/**
+ * Sets up the system clock and the console. This should be the first 
+ * thing that main() does.
+ */
+void platform_setup();
+
+void platform_sleep_ms(unsigned ms);
+
+/**
+ * @returns The next character from the console, or -1 if nothing is
+ * waiting. Never blocks.
+ */
+int console_getc();
+
+/**
+ * @returns true if the last reset was caused by the watchdog.
+ */
+bool platform_watchdog_caused_reboot();
+
+/**
+ * Starts the watchdog. From here on platform_watchdog_update() needs 
+ * to be called more often than the interval or the system is reset.
+ */
+void platform_watchdog_enable(unsigned intervalMs);
+
+void platform_watchdog_update();
+
+}
@@ -0,0 +1,314 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include <cstring>
+#include <cstdarg>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "PcmFile.h"
+
+namespace kc1fsz {
+
+static uint32_t getLe32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t getLe16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static void putLe32(uint32_t v, uint8_t* p) {
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+    p[2] = (v >> 16) & 0xff;
+    p[3] = (v >> 24) & 0xff;
+}
+
+static void putLe16(uint16_t v, uint8_t* p) {
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+}
+
+// ----- PcmReader ------------------------------------------------------------
+
+PcmReader::~PcmReader() {
+    close();
+}
+
+void PcmReader::close() {
+    if (_base)
+        munmap(_base, _mapLen);
+    _base = 0;
+    _mapLen = 0;
+    _data = 0;
+    _frames = 0;
+    _channels = 0;
+    _rate = 0;
+}
+
+bool PcmReader::_fail(const std::string& msg) {
+    close();
+    _error = msg;
+    return false;
+}
+
+bool PcmReader::_map(const char* fn) {
+    close();
+    _error.clear();
+    int fd = ::open(fn, O_RDONLY);
+    if (fd < 0)
+        return _fail(std::string("can't open ") + fn);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return _fail(std::string("empty file ") + fn);
+    }
+    _mapLen = st.st_size;
+    void* p = mmap(0, _mapLen, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        _mapLen = 0;
+        return _fail(std::string("can't map ") + fn);
+    }
+    _base = p;
+    // The file will be read front to back
+    madvise(_base, _mapLen, MADV_SEQUENTIAL);
+    return true;
+}
+
+bool PcmReader::openRaw(const char* fn, Format format, unsigned channels, 
+    unsigned rate) {
+    if (channels == 0)
+        return _fail("no channels");
+    if (!_map(fn))
+        return false;
+    _data = (const uint8_t*)_base;
+    _format = format;
+    _channels = channels;
+    _rate = rate;
+    _frameSize = channels * ((format == PCM16) ? 2 : 4);
+    _frames = _mapLen / _frameSize;
+    return true;
+}
+
+bool PcmReader::openWav(const char* fn) {
+
+    if (!_map(fn))
+        return false;
+
+    const uint8_t* buf = (const uint8_t*)_base;
+    const size_t len = _mapLen;
+    if (len < 12 || memcmp(buf, "RIFF", 4) != 0 || memcmp(buf + 8, "WAVE", 4) != 0)
+        return _fail("not a WAV file");
+
+    unsigned tag = 0, channels = 0, bits = 0, rate = 0;
+    const uint8_t* data = 0;
+    size_t dataLen = 0;
+
+    // Walk the chunks
+    size_t pos = 12;
+    while (pos + 8 <= len) {
+        const uint8_t* chunk = buf + pos;
+        const size_t chunkLen = getLe32(chunk + 4);
+        // Streamed files sometimes leave the data length wrong
+        const size_t avail = std::min(chunkLen, len - pos - 8);
+        if (memcmp(chunk, "fmt ", 4) == 0 && avail >= 16) {
+            tag = getLe16(chunk + 8);
+            channels = getLe16(chunk + 10);
+            rate = getLe32(chunk + 12);
+            bits = getLe16(chunk + 22);
+            // WAVE_FORMAT_EXTENSIBLE keeps the real format in the sub-type
+            if (tag == 0xfffe && avail >= 26)
+                tag = getLe16(chunk + 32);
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            data = chunk + 8;
+            dataLen = avail;
+        }
+        // Chunks are padded to an even length
+        pos += 8 + chunkLen + (chunkLen & 1);
+    }
+
+    if (!data || channels == 0)
+        return _fail("no audio");
+
+    if (tag == 1 && bits == 16)
+        _format = PCM16;
+    else if (tag == 1 && bits == 32)
+        _format = PCM32;
+    else if (tag == 3 && bits == 32)
+        _format = FLOAT32;
+    else 
+        return _fail("unsupported sample format (need 16/32-bit PCM or 32-bit float)");
+
+    _data = data;
+    _channels = channels;
+    _rate = rate;
+    _frameSize = channels * bits / 8;
+    _frames = dataLen / _frameSize;
+    return true;
+}
+
+void PcmReader::readQ31(size_t pos, unsigned channel, int32_t* out, 
+    unsigned count) const {
+
+    unsigned n = 0;
+    if (pos < _frames && channel < _channels) {
+        n = (unsigned)std::min((size_t)count, _frames - pos);
+        const unsigned sampleSize = (_format == PCM16) ? 2 : 4;
+        const uint8_t* p = _data + pos * _frameSize + channel * sampleSize;
+        if (_format == PCM16) {
+            for (unsigned i = 0; i < n; i++, p += _frameSize)
+                out[i] = (int32_t)((uint32_t)getLe16(p) << 16);
+        } else if (_format == PCM32) {
+            for (unsigned i = 0; i < n; i++, p += _frameSize)
+                out[i] = (int32_t)getLe32(p);
+        } else {
+            for (unsigned i = 0; i < n; i++, p += _frameSize) {
+                const uint32_t u = getLe32(p);
+                float v;
+                memcpy(&v, &u, sizeof(v));
+                // Clip to the q31 range
+                v = std::max(-1.0f, std::min(v, 0.99999994f));
+                out[i] = (int32_t)(v * 2147483648.0f);
+            }
+        }
+    }
+    for (; n < count; n++)
+        out[n] = 0;
+}
+
+// ----- PcmWriter ------------------------------------------------------------
+
+bool PcmWriter::open(const char* fn, bool wav, PcmReader::Format format, 
+    unsigned rate) {
+
+    close();
+    if (format == PcmReader::FLOAT32)
+        return false;
+    _f = fopen(fn, "wb");
+    if (!_f)
+        return false;
+    _wav = wav;
+    _format = format;
+    _frames = 0;
+    _used = 0;
+    _buf.resize(BUF_SIZE);
+    _ok = true;
+
+    if (_wav) {
+        // Sizes are filled in by close()
+        const unsigned sampleSize = (_format == PcmReader::PCM16) ? 2 : 4;
+        uint8_t* h = _buf.data();
+        memcpy(h, "RIFF", 4);
+        putLe32(0, h + 4);
+        memcpy(h + 8, "WAVEfmt ", 8);
+        putLe32(16, h + 16);
+        putLe16(1, h + 20);
+        putLe16(1, h + 22);
+        putLe32(rate, h + 24);
+        putLe32(rate * sampleSize, h + 28);
+        putLe16(sampleSize, h + 32);
+        putLe16(sampleSize * 8, h + 34);
+        memcpy(h + 36, "data", 4);
+        putLe32(0, h + 40);
+        _used = 44;
+    }
+    return true;
+}
+
+void PcmWriter::_flush() {
+    if (_used && fwrite(_buf.data(), 1, _used, _f) != _used)
+        _ok = false;
+    _used = 0;
+}
+
+void PcmWriter::write(const int32_t* q31, unsigned count) {
+    if (!_f)
+        return;
+    const unsigned sampleSize = (_format == PcmReader::PCM16) ? 2 : 4;
+    for (unsigned i = 0; i < count; i++) {
+        if (_used + sampleSize > BUF_SIZE)
+            _flush();
+        if (sampleSize == 2)
+            putLe16((uint32_t)q31[i] >> 16, _buf.data() + _used);
+        else
+            putLe32((uint32_t)q31[i], _buf.data() + _used);
+        _used += sampleSize;
+    }
+    _frames += count;
+}
+
+bool PcmWriter::close() {
+    if (!_f)
+        return false;
+    _flush();
+    if (_wav) {
+        const unsigned sampleSize = (_format == PcmReader::PCM16) ? 2 : 4;
+        const uint32_t dataLen = _frames * sampleSize;
+        uint8_t b[4];
+        putLe32(36 + dataLen, b);
+        _ok = _ok && fseek(_f, 4, SEEK_SET) == 0 && fwrite(b, 1, 4, _f) == 4;
+        putLe32(dataLen, b);
+        _ok = _ok && fseek(_f, 40, SEEK_SET) == 0 && fwrite(b, 1, 4, _f) == 4;
+    }
+    if (fclose(_f) != 0)
+        _ok = false;
+    _f = 0;
+    return _ok;
+}
+
+// ----- TextWriter -----------------------------------------------------------
+
+bool TextWriter::open(const char* fn) {
+    close();
+    _f = fopen(fn, "w");
+    if (!_f)
+        return false;
+    // A bigger buffer than the default
+    setvbuf(_f, 0, _IOFBF, 64 * 1024);
+    _ok = true;
+    return true;
+}
+
+void TextWriter::printf(const char* fmt, ...) {
+    if (!_f)
+        return;
+    va_list ap;
+    va_start(ap, fmt);
+    if (vfprintf(_f, fmt, ap) < 0)
+        _ok = false;
+    va_end(ap);
+}
+
+bool TextWriter::close() {
+    if (!_f)
+        return false;
+    if (fclose(_f) != 0)
+        _ok = false;
+    _f = 0;
+    return _ok;
+}
+
+}
@@ -0,0 +1,230 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace kc1fsz {
+
+/**
+ * @brief Host-side (POSIX) reader for WAV and raw PCM files.
+ *
+ * The file is memory-mapped rather than read in, so captures of any 
+ * length can be handled without big buffers. Samples are converted to 
+ * q31 as they are requested. Only one channel is read at a time.
+ *
+ * Use PcmBlocksT to walk the file in audio blocks.
+ */
+class PcmReader {
+public:
+
+    enum Format { PCM16, PCM32, FLOAT32 };
+
+    PcmReader() { }
+    ~PcmReader();
+    PcmReader(const PcmReader&) = delete;
+    PcmReader& operator=(const PcmReader&) = delete;
+
+    /**
+     * Opens a RIFF/WAV file. 16/32-bit PCM and 32-bit float are 
+     * supported (including WAVE_FORMAT_EXTENSIBLE).
+     * @returns false if the file can't be used, see getError().
+     */
+    bool openWav(const char* fn);
+
+    /**
+     * Opens a headerless little-endian file with interleaved channels.
+     * @returns false if the file can't be used, see getError().
+     */
+    bool openRaw(const char* fn, Format format, unsigned channels, unsigned rate);
+
+    void close();
+
+    const std::string& getError() const { return _error; }
+    Format getFormat() const { return _format; }
+    unsigned getChannels() const { return _channels; }
+    unsigned getRate() const { return _rate; }
+
+    /**
+     * @returns The number of sample frames (one sample per channel) in 
+     * the file.
+     */
+    size_t getFrames() const { return _frames; }
+
+    /**
+     * Converts samples from one channel to q31. Anything past the end 
+     * of the file is read as zero.
+     *
+     * @param pos The first frame to read.
+     */
+    void readQ31(size_t pos, unsigned channel, int32_t* out, unsigned count) const;
+
+private:
+
+    bool _fail(const std::string& msg);
+    bool _map(const char* fn);
+
+    std::string _error;
+    void* _base = 0;
+    size_t _mapLen = 0;
+    const uint8_t* _data = 0;
+    Format _format = PCM16;
+    unsigned _channels = 0;
+    unsigned _rate = 0;
+    unsigned _frameSize = 0;
+    size_t _frames = 0;
+};
+
+/**
+ * @brief Walks one channel of a PcmReader in blocks of BS samples, which
+ * is the layout that AudioCore::cycleRx() wants. The last block is 
+ * padded out with zeros.
+ *
+ * Usage:
+ *
+ *   for (const int32_t* block : PcmBlocksT<AudioCore::BLOCK_SIZE_ADC>(reader))
+ *       core.cycleRx(block, cross);
+ *
+ * The block pointer is only valid until the iterator moves.
+ */
+template<unsigned BS> class PcmBlocksT {
+public:
+
+    static const unsigned BLOCK_SIZE = BS;
+
+    PcmBlocksT(const PcmReader& reader, unsigned channel = 0) 
+    :   _reader(reader),
+        _channel(channel),
+        _blocks((reader.getFrames() + BS - 1) / BS) { }
+
+    size_t size() const { return _blocks; }
+
+    class Iterator {
+    public:
+        Iterator(PcmBlocksT* owner, size_t block) : _owner(owner), _block(block) { }
+        const int32_t* operator*() const { 
+            _owner->_reader.readQ31(_block * BS, _owner->_channel, _owner->_buf, BS);
+            return _owner->_buf;
+        }
+        Iterator& operator++() { _block++; return *this; }
+        bool operator!=(const Iterator& other) const { return _block != other._block; }
+        size_t index() const { return _block; }
+    private:
+        PcmBlocksT* _owner;
+        size_t _block;
+    };
+
+    Iterator begin() { return Iterator(this, 0); }
+    Iterator end() { return Iterator(this, _blocks); }
+
+private:
+
+    const PcmReader& _reader;
+    const unsigned _channel;
+    const size_t _blocks;
+    int32_t _buf[BS];
+};
+
+/**
+ * @brief Buffered writer for mono WAV or raw PCM files.
+ *
+ * Samples are given in q31 and converted to the file format. The data
+ * goes out in large chunks and, for WAV, the header sizes are filled in 
+ * by close(). The buffer is on the heap so that a writer can live on a 
+ * (worker thread) stack.
+ */
+class PcmWriter {
+public:
+
+    PcmWriter() { }
+    ~PcmWriter() { close(); }
+    PcmWriter(const PcmWriter&) = delete;
+    PcmWriter& operator=(const PcmWriter&) = delete;
+
+    /**
+     * @param wav true for a WAV file, false for raw samples.
+     * @param format PCM16 or PCM32.
+     */
+    bool open(const char* fn, bool wav, PcmReader::Format format, unsigned rate);
+
+    void write(const int32_t* q31, unsigned count);
+
+    /**
+     * Flushes the buffer and finishes the header.
+     * @returns false if anything went wrong since open().
+     */
+    bool close();
+
+    size_t getFrames() const { return _frames; }
+
+private:
+
+    void _flush();
+
+    static const unsigned BUF_SIZE = 64 * 1024;
+
+    FILE* _f = 0;
+    bool _wav = false;
+    bool _ok = false;
+    PcmReader::Format _format = PcmReader::PCM16;
+    size_t _frames = 0;
+    unsigned _used = 0;
+    std::vector<uint8_t> _buf;
+};
+
+/**
+ * @brief Buffered writer for text/CSV output. Nothing is flushed per 
+ * line, unlike std::endl.
+ */
+class TextWriter {
+public:
+
+    TextWriter() { }
+    ~TextWriter() { close(); }
+    TextWriter(const TextWriter&) = delete;
+    TextWriter& operator=(const TextWriter&) = delete;
+
+    bool open(const char* fn);
+
+    /**
+     * printf-style. Lines need their own "\n".
+     */
+    void printf(const char* fmt, ...)
+#ifdef __GNUC__
+        __attribute__((format(printf, 2, 3)))
+#endif
+        ;
+
+    /**
+     * @returns false if anything went wrong since open().
+     */
+    bool close();
+
+private:
+
+    FILE* _f = 0;
+    bool _ok = false;
+};
+
+}
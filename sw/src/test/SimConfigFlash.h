@@ -0,0 +1,67 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cassert>
+#include <cstring>
+
+#include "ConfigFlash.h"
+
+namespace kc1fsz {
+
+/**
+ * @brief A flash sector in RAM. Starts out erased, like a new board. 
+ * The programming rules of the real part are checked.
+ */
+class SimConfigFlash : public ConfigFlash {
+public:
+
+    SimConfigFlash() { memset(_sector, 0xff, sizeof(_sector)); }
+
+    virtual void read(uint8_t* out, unsigned len) const {
+        assert(len <= SECTOR_SIZE);
+        memcpy(out, _sector, len);
+    }
+
+    virtual void erase() {
+        memset(_sector, 0xff, sizeof(_sector));
+        _eraseCount++;
+    }
+
+    virtual void program(unsigned offset, const uint8_t* data, unsigned len) {
+        assert(offset % PAGE_SIZE == 0 && len % PAGE_SIZE == 0);
+        assert(offset + len <= SECTOR_SIZE);
+        // Programming can only clear bits
+        for (unsigned i = 0; i < len; i++)
+            _sector[offset + i] &= data[i];
+        _programCount++;
+    }
+
+    unsigned getEraseCount() const { return _eraseCount; }
+    unsigned getProgramCount() const { return _programCount; }
+
+private:
+
+    uint8_t _sector[SECTOR_SIZE];
+    unsigned _eraseCount = 0;
+    unsigned _programCount = 0;
+};
+
+}
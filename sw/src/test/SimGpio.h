@@ -0,0 +1,63 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cassert>
+
+#include "Gpio.h"
+
+namespace kc1fsz {
+
+/**
+ * @brief Simulated pins. Inputs are driven by the test, outputs are
+ * read back by the test. Rising edges are counted so that (for example)
+ * the number of times a transmitter was keyed can be checked.
+ */
+class SimGpio : public Gpio {
+public:
+
+    static const unsigned PIN_COUNT = 48;
+
+    virtual void init(unsigned pin, bool) { assert(pin < PIN_COUNT); _pins[pin] = false; }
+
+    virtual void put(unsigned pin, bool value) { 
+        assert(pin < PIN_COUNT);
+        if (value && !_pins[pin])
+            _rises[pin]++;
+        _pins[pin] = value; 
+    }
+
+    virtual bool get(unsigned pin) const { 
+        assert(pin < PIN_COUNT);
+        return _pins[pin]; 
+    }
+
+    unsigned getRises(unsigned pin) const { 
+        assert(pin < PIN_COUNT);
+        return _rises[pin]; 
+    }
+
+private:
+
+    bool _pins[PIN_COUNT] = { };
+    unsigned _rises[PIN_COUNT] = { };
+};
+
+}
@@ -0,0 +1,167 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include "Simulator.h"
+
+namespace kc1fsz {
+
+static_assert(AudioCore::BLOCK_SIZE_ADC * 1000 % AudioCore::FS_ADC == 0, 
+    "Block must be a whole number of ms");
+
+static const float PI2 = 2.0f * 3.14159265f;
+
+Simulator::Simulator()
+:   _log(&_clock) {
+
+    // Quiet unless asked for (see getLog())
+    _log.setEnabled(false);
+
+    // This is what happens on a new board
+    Config::setFlash(&_flash);
+    Config::loadConfig(&_config);
+    if (!_config.isValid()) {
+        Config::setFactoryDefaults(&_config);
+        Config::saveConfig(&_config);
+    }
+
+    const Controller::Pins pins = { R0_COS_PIN, R0_CTCSS_PIN, R0_PTT_PIN, 
+        R1_COS_PIN, R1_CTCSS_PIN, R1_PTT_PIN };
+    _ctl = std::make_unique<Controller>(_clock, _log, _gpio, _config, pins);
+    _ctl->transferConfig();
+}
+
+void Simulator::setCarrier(unsigned r, bool on) {
+
+    _radio[r].carrier = on;
+
+    const Config::ReceiveConfig& rc = (r == 0) ? _config.rx0 : _config.rx1;
+    const bool cosActiveLow = rc.cosMode == Rx::CosMode::COS_EXT_LOW;
+    const bool toneActiveLow = rc.toneMode == Rx::ToneMode::TONE_EXT_LOW;
+    // An external tone decoder only sees the tone that it is set for
+    const bool tone = on && _radio[r].ctcssHz != 0 && 
+        std::fabs(_radio[r].ctcssHz - rc.toneFreq) < 1.0f;
+
+    _gpio.put(r == 0 ? R0_COS_PIN : R1_COS_PIN, on != cosActiveLow);
+    _gpio.put(r == 0 ? R0_CTCSS_PIN : R1_CTCSS_PIN, tone != toneActiveLow);
+}
+
+void Simulator::sendDtmf(unsigned r, const char* digits, unsigned toneMs, 
+    unsigned gapMs) {
+
+    static const float LOW[4] = { 697, 770, 852, 941 };
+    static const float HIGH[4] = { 1209, 1336, 1477, 1633 };
+    static const char* KEYS = "123A456B789C*0#D";
+
+    const bool wasOn = _radio[r].carrier;
+    const float voiceDbv = _radio[r].voiceDbv;
+    _radio[r].voiceDbv = -120;
+    setCarrier(r, true);
+    for (const char* d = digits; *d != 0; d++) {
+        const char* k = strchr(KEYS, *d);
+        if (k == 0)
+            continue;
+        const unsigned i = k - KEYS;
+        _radio[r].dtmfLowHz = LOW[i / 4];
+        _radio[r].dtmfHighHz = HIGH[i % 4];
+        run(toneMs);
+        _radio[r].dtmfLowHz = 0;
+        _radio[r].dtmfHighHz = 0;
+        run(gapMs);
+    }
+    _radio[r].voiceDbv = voiceDbv;
+    setCarrier(r, wasOn);
+}
+
+void Simulator::_makeAudio(Radio& radio, int32_t* out) {
+
+    if (!radio.carrier) {
+        memset(out, 0, AudioCore::BLOCK_SIZE_ADC * sizeof(int32_t));
+        return;
+    }
+
+    // 0dBv is 0.5 Vp, and the ADC full scale is 1.0 Vp
+    const float voiceA = AudioCore::dbvToPeak(radio.voiceDbv);
+    const float ctcssA = radio.ctcssHz != 0 ? AudioCore::dbvToPeak(radio.ctcssDbv) : 0;
+    const float dtmfA = AudioCore::dbvToPeak(-10);
+    const bool dtmf = radio.dtmfLowHz != 0;
+    const float fs = (float)AudioCore::FS_ADC;
+
+    for (unsigned i = 0; i < AudioCore::BLOCK_SIZE_ADC; i++) {
+        float v = ctcssA * std::sin(radio.ctcssPhi);
+        if (dtmf) 
+            v += dtmfA * (std::sin(radio.dtmfLowPhi) + std::sin(radio.dtmfHighPhi));
+        else
+            v += voiceA * std::sin(radio.voicePhi);
+        radio.ctcssPhi = std::fmod(radio.ctcssPhi + PI2 * radio.ctcssHz / fs, PI2);
+        radio.voicePhi = std::fmod(radio.voicePhi + PI2 * 1000.0f / fs, PI2);
+        radio.dtmfLowPhi = std::fmod(radio.dtmfLowPhi + PI2 * radio.dtmfLowHz / fs, PI2);
+        radio.dtmfHighPhi = std::fmod(radio.dtmfHighPhi + PI2 * radio.dtmfHighHz / fs, PI2);
+        v = std::max(-0.999f, std::min(v, 0.999f));
+        out[i] = (int32_t)(v * 2147483648.0f);
+    }
+}
+
+void Simulator::step() {
+
+    _blocks++;
+    _clock.setTime((uint32_t)(_blocks * BLOCK_MS));
+
+    if (_audioEnabled) {
+        int32_t in[2][AudioCore::BLOCK_SIZE_ADC];
+        int32_t out[2][AudioCore::BLOCK_SIZE_ADC];
+        _makeAudio(_radio[0], in[0]);
+        _makeAudio(_radio[1], in[1]);
+        _ctl->audioCycle(in[0], in[1], out[0], out[1]);
+        for (unsigned r = 0; r < 2; r++) {
+            float sum = 0;
+            for (unsigned i = 0; i < AudioCore::BLOCK_SIZE_ADC; i++) {
+                const float v = (float)out[r][i] / 2147483648.0f;
+                sum += v * v;
+            }
+            _radio[r].txRms = std::sqrt(sum / (float)AudioCore::BLOCK_SIZE_ADC);
+        }
+    }
+
+    // The main event loop
+    _ctl->run();
+    if (Config::isSavePending())
+        Config::runSave();
+}
+
+void Simulator::run(uint32_t ms) {
+    const uint32_t end = getTime() + ms;
+    while (getTime() < end)
+        step();
+}
+
+bool Simulator::runUntil(std::function<bool()> cond, uint32_t maxMs) {
+    const uint32_t end = getTime() + maxMs;
+    while (getTime() < end) {
+        step();
+        if (cond())
+            return true;
+    }
+    return false;
+}
+
+}
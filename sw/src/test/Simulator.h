@@ -0,0 +1,186 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <functional>
+
+#include "kc1fsz-tools/Log.h"
+
+#include "Config.h"
+#include "Controller.h"
+
+#include "TestClock.h"
+#include "SimGpio.h"
+#include "SimConfigFlash.h"
+
+namespace kc1fsz {
+
+/**
+ * @brief Runs the complete repeater controller on the host against a 
+ * simulated board: virtual pins, a virtual flash sector behind the 
+ * Config, and a clock that is advanced one audio block at a time. 
+ * Nothing depends on the wall clock so runs are repeatable and go 
+ * as fast as the host allows.
+ *
+ * Each step() does what the firmware does in one audio block: the 
+ * radio audio is synthesized from the current input settings and 
+ * pushed through Controller::audioCycle(), then one pass of the main
+ * loop work (Controller::run() and the background config save) is 
+ * made.
+ *
+ * The audio processing can be turned off for scenarios that only use 
+ * the hardware COS/CTCSS inputs. That makes long runs (hours of 
+ * repeater time) very fast. Soft COS/CTCSS and DTMF need the audio.
+ *
+ * NOTE: The Config save state is global, as it is in the firmware, 
+ * so only one Simulator should exist in a process at a time. 
+ * Use separate processes to run scenarios in parallel.
+ */
+class Simulator {
+public:
+
+    // The pins are the same as the DIGITAL-3 board
+    static const unsigned R0_COS_PIN = 14;
+    static const unsigned R0_CTCSS_PIN = 13;
+    static const unsigned R0_PTT_PIN = 12;
+    static const unsigned R1_COS_PIN = 0;
+    static const unsigned R1_CTCSS_PIN = 1;
+    static const unsigned R1_PTT_PIN = 15;
+
+    static const unsigned BLOCK_MS = AudioCore::BLOCK_SIZE_ADC * 1000 / AudioCore::FS_ADC;
+
+    /**
+     * The configuration starts out with the factory defaults, as it 
+     * would on a new board. Make any changes with getConfig() and then
+     * call applyConfig().
+     */
+    Simulator();
+
+    Config& getConfig() { return _config; }
+    Controller& getController() { return *_ctl; }
+    SimGpio& getGpio() { return _gpio; }
+    SimConfigFlash& getFlash() { return _flash; }
+    Log& getLog() { return _log; }
+
+    /**
+     * @brief Same as a configuration change from the shell.
+     */
+    void applyConfig() { _ctl->transferConfig(); }
+
+    void setAudioEnabled(bool b) { _audioEnabled = b; }
+
+    // ----- Radio Inputs ----------------------------------------------------
+
+    /**
+     * @brief Turns a signal on/off at the receiver. This drives the COS 
+     * pin (with the polarity from the receiver configuration) and the
+     * receiver audio. If a CTCSS frequency is set then the CTCSS pin
+     * is driven as well.
+     */
+    void setCarrier(unsigned r, bool on);
+
+    /**
+     * @brief Level of the 1kHz "voice" tone while the carrier is on.
+     */
+    void setVoiceLevel(unsigned r, float dbv) { _radio[r].voiceDbv = dbv; }
+
+    /**
+     * @param hz CTCSS tone sent with the carrier, 0 for none.
+     */
+    void setCtcss(unsigned r, float hz, float dbv = -26) { 
+        _radio[r].ctcssHz = hz; 
+        _radio[r].ctcssDbv = dbv; 
+    }
+
+    /**
+     * @brief Sends DTMF digits and then runs the simulation until they 
+     * have all been sent. The carrier is turned on and the voice tone 
+     * is turned off for the duration.
+     */
+    void sendDtmf(unsigned r, const char* digits, unsigned toneMs = 100, 
+        unsigned gapMs = 100);
+
+    // ----- Running ---------------------------------------------------------
+
+    /**
+     * @brief Advances by one audio block.
+     */
+    void step();
+
+    void run(uint32_t ms);
+
+    /**
+     * @brief Runs until the condition is true or the time limit passes.
+     * @returns true if the condition was met.
+     */
+    bool runUntil(std::function<bool()> cond, uint32_t maxMs);
+
+    uint32_t getTime() const { return _clock.time(); }
+
+    // ----- Outputs ---------------------------------------------------------
+
+    bool isPtt(unsigned r) const { return _gpio.get(r == 0 ? R0_PTT_PIN : R1_PTT_PIN); }
+
+    /**
+     * @returns The number of times that the transmitter has been keyed.
+     */
+    unsigned getKeyCount(unsigned r) const { 
+        return _gpio.getRises(r == 0 ? R0_PTT_PIN : R1_PTT_PIN); 
+    }
+
+    /**
+     * @returns The RMS of the last block sent to the transmitter DAC 
+     * (full scale is 1.0).
+     */
+    float getTxRms(unsigned r) const { return _radio[r].txRms; }
+
+private:
+
+    struct Radio {
+        bool carrier = false;
+        float voiceDbv = -10;
+        float ctcssHz = 0;
+        float ctcssDbv = -26;
+        // DTMF tone pair currently being sent (0 for none)
+        float dtmfLowHz = 0;
+        float dtmfHighHz = 0;
+        float voicePhi = 0;
+        float ctcssPhi = 0;
+        float dtmfLowPhi = 0;
+        float dtmfHighPhi = 0;
+        float txRms = 0;
+    };
+
+    void _makeAudio(Radio& radio, int32_t* out);
+
+    TestClock _clock;
+    Log _log;
+    SimGpio _gpio;
+    SimConfigFlash _flash;
+    Config _config;
+    std::unique_ptr<Controller> _ctl;
+    bool _audioEnabled = true;
+    uint64_t _blocks = 0;
+    Radio _radio[2];
+};
+
+}
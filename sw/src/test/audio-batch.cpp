@@ -0,0 +1,322 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+
+// Runs recorded receiver audio through the full repeater chain (AudioCore
+// receive -> MixBus -> AudioCore transmit) and writes the transmit audio
+// and a CSV of the per-block meters for each clip. Used to check filter
+// and AGC changes against field recordings.
+//
+// Usage: audio-batch [options] <clip.wav | directory> ...
+//
+//   -o dir    Output directory (default .). For each clip x.wav the 
+//             transmit audio goes to x.out.wav and the meters go to x.csv
+//   -n x.wav  Also play this 8k file into the network port 
+//             (DigitalAudioPort), looping it as needed
+//   -j n      Number of clips processed in parallel (default: all cores)
+//   -c hz     CTCSS decode frequency (default 123.0)
+//   -d ms     Receive delay (default 0)
+//   -e        Enable de-emphasis
+//   -a        Disable the AGC
+//   -p        Disable the CTCSS HPF
+//
+// Clips must be 32k. 16/32-bit PCM and 32-bit float are accepted and only
+// the first channel is used. The clips are streamed (memory-mapped), so 
+// long captures are fine.
+//
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+#include "kc1fsz-tools/Common.h"
+
+#include "TestClock.h"
+#include "AudioCore.h"
+#include "MixBus.h"
+#include "DigitalAudioPort.h"
+#include "PcmFile.h"
+
+using namespace std;
+using namespace kc1fsz;
+
+namespace fs = std::filesystem;
+
+struct Options {
+    string outDir = ".";
+    string netFn;
+    unsigned jobs = 0;
+    float ctcssHz = 123.0;
+    unsigned delayMs = 0;
+    bool deemph = false;
+    bool agc = true;
+    bool hpf = true;
+};
+
+// ----- Processing -----------------------------------------------------------
+
+struct ClipResult {
+    bool ok;
+    string err;
+    unsigned blocks;
+    double sec;
+};
+
+/**
+ * Everything for one clip. These are big, so they live on the heap.
+ */
+struct Chain {
+    Chain() 
+    :   core(0, clock), 
+        port(1, clock), 
+        mixBus(2) { }
+    TestClock clock;
+    AudioCore core;
+    DigitalAudioPort port;
+    MixBus mixBus;
+};
+
+static ClipResult processClip(const Options& opt, const fs::path& inFn, 
+    const vector<int16_t>& net) {
+
+    ClipResult r = { false, "", 0, 0 };
+    const auto start = chrono::steady_clock::now();
+
+    PcmReader in;
+    if (!in.openWav(inFn.c_str())) {
+        r.err = in.getError();
+        return r;
+    }
+    if (in.getRate() != AudioCore::FS_ADC) {
+        r.err = "sample rate is " + to_string(in.getRate()) + ", needs to be " + 
+            to_string(AudioCore::FS_ADC);
+        return r;
+    }
+
+    const fs::path stem = fs::path(opt.outDir) / inFn.stem();
+    TextWriter csv;
+    PcmWriter out;
+    if (!csv.open((stem.string() + ".csv").c_str()) ||
+        !out.open((stem.string() + ".out.wav").c_str(), true, PcmReader::PCM16, 
+            AudioCore::FS_ADC)) {
+        r.err = "can't write output for " + stem.string();
+        return r;
+    }
+    csv.printf("block,time_s,signal_dbv,noise_dbv,snr_db,ctcss_dbv,agc_db,out_dbv,out_peak_dbv,dtmf\n");
+
+    auto chain = make_unique<Chain>();
+    AudioCore& core = chain->core;
+    DigitalAudioPort& port = chain->port;
+    MixBus& mixBus = chain->mixBus;
+
+    core.setCtcssDecodeFreq(opt.ctcssHz);
+    core.setRxDelayMs(opt.delayMs);
+    core.setDeemphMode(opt.deemph ? 1 : 0);
+    core.setAgcEnabled(opt.agc);
+    core.setHPFEnabled(opt.hpf);
+    mixBus.setSourceGainLinear(0, 1.0);
+    mixBus.setSourceGainLinear(1, net.empty() ? 0.0 : 1.0);
+
+    float cross0[AudioCore::BLOCK_SIZE];
+    float cross1[AudioCore::BLOCK_SIZE];
+    const float* crossIns[2] = { cross0, cross1 };
+    float mix[AudioCore::BLOCK_SIZE];
+    int32_t dacOut[AudioCore::BLOCK_SIZE_ADC];
+
+    const unsigned frameSamples = JitterBuffer::FRAME_SAMPLES;
+    unsigned netPos = 0;
+    unsigned netSamples = 0;
+    uint8_t netSeq = 0;
+
+    PcmBlocksT<AudioCore::BLOCK_SIZE_ADC> blocks(in);
+    for (auto it = blocks.begin(); it != blocks.end(); ++it) {
+
+        const unsigned b = it.index();
+
+        const uint32_t nowMs = (uint32_t)((uint64_t)b * AudioCore::BLOCK_SIZE_ADC * 1000 
+            / AudioCore::FS_ADC);
+        chain->clock.setTime(nowMs);
+
+        // Network frames arrive at the real-time rate
+        if (!net.empty()) {
+            while (netSamples >= frameSamples) {
+                uint8_t frame[DigitalAudioPort::NETWORK_FRAME_SIZE];
+                for (unsigned i = 0; i < frameSamples; i++) {
+                    pack_int16_le(net[netPos], frame + i * 2);
+                    netPos = (netPos + 1) % net.size();
+                }
+                port.loadNetworkAudio(netSeq++, frame, sizeof(frame));
+                netSamples -= frameSamples;
+            }
+            netSamples += AudioCore::BLOCK_SIZE;
+        }
+
+        core.cycleRx(*it, cross0);
+        port.cycleRx(cross1);
+        mixBus.cycle(crossIns);
+        mixBus.getMix(0, mix);
+        core.cycleTx(mix, dacOut);
+
+        out.write(dacOut, AudioCore::BLOCK_SIZE_ADC);
+
+        const float s = core.getSignalRms();
+        const float n = core.getNoiseRms();
+        const char dtmf = core.getLastDtmfDetection();
+        csv.printf("%u,%.3f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%c\n", 
+            b, (float)nowMs / 1000.0f,
+            AudioCore::vrmsToDbv(s), AudioCore::vrmsToDbv(n), 
+            AudioCore::db(s / n),
+            AudioCore::vrmsToDbv(core.getCtcssDecodeRms()),
+            AudioCore::db(core.getAgcGain()),
+            AudioCore::vrmsToDbv(core.getOutRms()),
+            AudioCore::vrmsToDbv(core.getOutPeak() * 0.707f),
+            dtmf ? dtmf : ' ');
+    }
+
+    if (!csv.close() || !out.close()) {
+        r.err = "can't write output for " + stem.string();
+        return r;
+    }
+
+    r.ok = true;
+    r.blocks = blocks.size();
+    r.sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return r;
+}
+
+static void usage() {
+    cerr << "Usage: audio-batch [-o dir] [-n net.wav] [-j jobs] [-c hz] [-d ms] "
+        "[-e] [-a] [-p] <clip.wav | directory> ..." << endl;
+}
+
+int main(int argc, const char** argv) {
+
+    Options opt;
+    vector<fs::path> clips;
+
+    for (int i = 1; i < argc; i++) {
+        const string a = argv[i];
+        const bool hasArg = i + 1 < argc;
+        if (a == "-o" && hasArg)
+            opt.outDir = argv[++i];
+        else if (a == "-n" && hasArg)
+            opt.netFn = argv[++i];
+        else if (a == "-j" && hasArg)
+            opt.jobs = atoi(argv[++i]);
+        else if (a == "-c" && hasArg)
+            opt.ctcssHz = atof(argv[++i]);
+        else if (a == "-d" && hasArg)
+            opt.delayMs = atoi(argv[++i]);
+        else if (a == "-e")
+            opt.deemph = true;
+        else if (a == "-a")
+            opt.agc = false;
+        else if (a == "-p")
+            opt.hpf = false;
+        else if (a[0] == '-') {
+            usage();
+            return 2;
+        }
+        else if (fs::is_directory(a)) {
+            vector<fs::path> found;
+            for (const auto& e : fs::directory_iterator(a))
+                if (e.is_regular_file() && e.path().extension() == ".wav" &&
+                    e.path().stem().extension() != ".out")
+                    found.push_back(e.path());
+            sort(found.begin(), found.end());
+            clips.insert(clips.end(), found.begin(), found.end());
+        }
+        else
+            clips.push_back(a);
+    }
+
+    if (clips.empty()) {
+        usage();
+        return 2;
+    }
+
+    // The network audio is shared by all of the clips
+    vector<int16_t> net;
+    if (!opt.netFn.empty()) {
+        PcmReader r;
+        if (!r.openWav(opt.netFn.c_str()) || r.getRate() != DigitalAudioPort::FS) {
+            cerr << opt.netFn << ": " << 
+                (r.getError().empty() ? "needs to be 8k" : r.getError()) << endl;
+            return 2;
+        }
+        vector<int32_t> netIn(r.getFrames());
+        r.readQ31(0, 0, netIn.data(), netIn.size());
+        for (int32_t s : netIn)
+            net.push_back((int16_t)(s >> 16));
+    }
+
+    fs::create_directories(opt.outDir);
+
+    unsigned jobs = opt.jobs ? opt.jobs : thread::hardware_concurrency();
+    if (jobs == 0)
+        jobs = 1;
+    if (jobs > clips.size())
+        jobs = clips.size();
+
+    // Each worker takes the next clip off the list until there are none 
+    // left.
+    atomic<unsigned> next = 0;
+    atomic<unsigned> failures = 0;
+    mutex printLock;
+    const auto start = chrono::steady_clock::now();
+
+    auto worker = [&]() {
+        unsigned i;
+        while ((i = next.fetch_add(1)) < clips.size()) {
+            ClipResult r = processClip(opt, clips[i], net);
+            lock_guard<mutex> lock(printLock);
+            if (r.ok) {
+                const double audioSec = (double)r.blocks * AudioCore::BLOCK_SIZE_ADC / 
+                    (double)AudioCore::FS_ADC;
+                printf("%-40s %8.1fs audio %7.2fs %8.1fx\n", clips[i].string().c_str(), 
+                    audioSec, r.sec, audioSec / r.sec);
+            } else {
+                printf("%-40s FAILED: %s\n", clips[i].string().c_str(), r.err.c_str());
+                failures++;
+            }
+        }
+    };
+
+    vector<thread> threads;
+    for (unsigned t = 0; t < jobs; t++)
+        threads.emplace_back(worker);
+    for (thread& t : threads)
+        t.join();
+
+    printf("%zu clip(s), %u failed, %u job(s), %.2fs\n", clips.size(), 
+        (unsigned)failures, jobs, 
+        chrono::duration<double>(chrono::steady_clock::now() - start).count());
+
+    return failures ? 1 : 0;
+}
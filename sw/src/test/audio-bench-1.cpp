@@ -0,0 +1,335 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+
+// Times the audio processing on the host so that DSP changes can be 
+// judged before they go onto hardware. Each benchmark runs a fixed 
+// amount of audio through one piece of the pipeline and reports 
+// blocks/sec and the real-time factor (audio seconds processed per 
+// wall-clock second, so bigger is better).
+//
+// Usage: audio-bench-1 [-s seconds] [-o results.csv] [-b baseline.csv] [-t tolerance]
+//
+//   -s  Seconds of audio per benchmark (default 120)
+//   -o  Write the results as CSV. The same file can be used as a baseline.
+//   -b  Compare against an earlier CSV. The exit code is non-zero if any 
+//       benchmark is slower than the baseline by more than the tolerance.
+//   -t  Allowed slowdown as a fraction (default 0.2)
+//
+// The numbers are only comparable between runs on the same machine with
+// the same build options.
+//
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+
+#include "kc1fsz-tools/Common.h"
+
+#include "TestClock.h"
+#include "AudioCore.h"
+#include "DigitalAudioPort.h"
+#include "DigitalAudioPortRxHandler.h"
+
+using namespace std;
+using namespace kc1fsz;
+
+struct Result {
+    string name;
+    // What was actually run (not counting the warm-up) and how long it took
+    unsigned blocks;
+    double audioSec;
+    double wallSec;
+    // Time per block in the fastest chunk (see below)
+    double bestBlockSec;
+    double blocksPerSec() const { return 1.0 / bestBlockSec; }
+    double realtime() const { return audioSec / (double)blocks / bestBlockSec; }
+};
+
+// Keeps the optimizer from throwing the work away
+static volatile uint32_t sink = 0;
+
+// The blocks are timed in chunks of at least CHUNK_SEC and the rate of 
+// the fastest chunk is used. Interruptions from whatever else the machine
+// is doing only ever make a chunk slower, so this filters out most of the
+// noise. The cheap benchmarks are repeated until at least MIN_SEC has 
+// been spent so that there are enough chunks to choose from. The rates
+// that are reported come from the fastest chunk, the wall time is the 
+// total.
+static const double CHUNK_SEC = 0.002;
+static const double MIN_SEC = 0.25;
+
+/**
+ * Runs f(blockIndex) for the requested number of blocks (or more) after 
+ * a short warm-up.
+ */
+template<typename F> static Result run(const string& name, unsigned blocks, 
+    double blockSec, F f) {
+    for (unsigned b = 0; b < blocks / 10 + 1; b++)
+        f(b);
+    double best = 0;
+    double total = 0;
+    unsigned b = 0;
+    while (b < blocks || total < MIN_SEC) {
+        auto start = chrono::steady_clock::now();
+        unsigned n = 0;
+        double wall;
+        do {
+            f(b++);
+            n++;
+            wall = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        } while (wall < CHUNK_SEC);
+        total += wall;
+        const double perBlock = wall / (double)n;
+        if (best == 0 || perBlock < best)
+            best = perBlock;
+    }
+    return { name, b, b * blockSec, total, best };
+}
+
+// One second of 32k receiver audio: voice-band tones, a CTCSS tone and
+// some noise, at a realistic level.
+static void makeCodecAudio(int32_t* out, unsigned len) {
+    uint32_t r = 1;
+    for (unsigned i = 0; i < len; i++) {
+        const double t = (double)i / 32000.0;
+        r = r * 1664525 + 1013904223;
+        const double noise = ((double)(r >> 8) / (double)(1 << 24)) - 0.5;
+        const double s = 0.2 * sin(2.0 * M_PI * 440.0 * t) + 
+            0.1 * sin(2.0 * M_PI * 1270.0 * t) +
+            0.05 * sin(2.0 * M_PI * 123.0 * t) + 
+            0.02 * noise;
+        out[i] = (int32_t)(s * 2147483647.0);
+    }
+}
+
+template<unsigned BS> static void benchCore(unsigned seconds, vector<Result>& results) {
+
+    typedef AudioCoreT<BS> Core;
+    const unsigned blocks = seconds * Core::FS_ADC / BS;
+    const double blockSec = (double)BS / (double)Core::FS_ADC;
+    const string suffix = "." + to_string(BS);
+
+    static int32_t in[Core::FS_ADC];
+    makeCodecAudio(in, Core::FS_ADC);
+    const unsigned inBlocks = Core::FS_ADC / BS;
+
+    TestClock clock;
+    Core core(0, clock);
+    core.setCtcssDecodeFreq(123);
+    core.setCtcssEncodeFreq(123);
+    core.setCtcssEncodeEnabled(true);
+    core.setRxDelayMs(100);
+
+    float cross[Core::BLOCK_SIZE];
+    int32_t out[BS];
+
+    results.push_back(run("core.rx" + suffix, blocks, blockSec, 
+        [&core, &cross, inBlocks](unsigned b) {
+            core.cycleRx(in + (b % inBlocks) * BS, cross);
+            sink = sink + (uint32_t)(cross[0] * 1000.0f);
+        }));
+
+    results.push_back(run("core.tx" + suffix, blocks, blockSec, 
+        [&core, &cross, &out](unsigned) {
+            core.cycleTx(cross, out);
+            sink = sink + (uint32_t)out[0];
+        }));
+}
+
+template<unsigned BS> static void benchPort(unsigned seconds, vector<Result>& results) {
+
+    typedef DigitalAudioPortT<BS> Port;
+    const unsigned blocks = seconds * Port::FS_ADC / BS;
+    const double blockSec = (double)BS / (double)Port::FS_ADC;
+    const string suffix = "." + to_string(BS);
+
+    // One network frame that is re-sent over and over
+    uint8_t frame[Port::NETWORK_FRAME_SIZE];
+    for (unsigned i = 0; i < Port::NETWORK_FRAME_SIZE / 2; i++)
+        pack_int16_le((int16_t)(8000.0 * sin(i * 0.3)), frame + i * 2);
+
+    TestClock clock;
+    Port port(2, clock);
+    float cross[Port::BLOCK_SIZE];
+    unsigned samples = 0;
+    uint8_t seq = 0;
+
+    // Frames are loaded at the network rate (one per 160 samples) and
+    // the simulated time moves along with the blocks.
+    results.push_back(run("port.rx" + suffix, blocks, blockSec,
+        [&port, &clock, &cross, &frame, &samples, &seq](unsigned b) {
+            clock.setTime((uint32_t)((uint64_t)b * BS / 32));
+            while (samples >= JitterBuffer::FRAME_SAMPLES) {
+                port.loadNetworkAudio(seq++, frame, Port::NETWORK_FRAME_SIZE);
+                samples -= JitterBuffer::FRAME_SAMPLES;
+            }
+            port.cycleRx(cross);
+            samples += Port::BLOCK_SIZE;
+            sink = sink + (uint32_t)(cross[0] * 1000.0f);
+        }));
+
+    results.push_back(run("port.tx" + suffix, blocks, blockSec,
+        [&port, &cross](unsigned) {
+            port.cycleTx(cross);
+            if (port.isNetworkAudioPending()) {
+                uint8_t f[Port::NETWORK_FRAME_SIZE];
+                port.extractNetworkAudio(f, Port::NETWORK_FRAME_SIZE);
+                sink = sink + f[0];
+            }
+        }));
+}
+
+static void benchLink(unsigned seconds, vector<Result>& results) {
+
+    // One message per 20ms network frame
+    const unsigned frames = seconds * 50;
+    const double frameSec = 0.020;
+    const uint8_t flags = DigitalAudioPortRxHandler::makeFlags(LINK_CODEC_PCM16, 0, true);
+    const unsigned payloadLen = DigitalAudioPortRxHandler::payloadSize(flags);
+    const unsigned msgLen = DigitalAudioPortRxHandler::msgSize(flags);
+
+    uint8_t payload[MAX_PAYLOAD_SIZE];
+    for (unsigned i = 0; i < payloadLen; i++)
+        payload[i] = (i * 13 + 7) & 0xff;
+    uint8_t msg[MAX_NETWORK_MESSAGE_SIZE];
+
+    results.push_back(run("link.encode", frames, frameSec,
+        [&payload, &msg, payloadLen, msgLen, flags](unsigned b) {
+            payload[0] = (uint8_t)b;
+            DigitalAudioPortRxHandler::encodeMsg(payload, payloadLen, msg, msgLen, flags);
+            sink = sink + msg[msgLen - 1];
+        }));
+
+    results.push_back(run("link.decode", frames, frameSec,
+        [&msg, msgLen](unsigned) {
+            uint8_t out[MAX_PAYLOAD_SIZE];
+            if (DigitalAudioPortRxHandler::decodeMsg(msg, msgLen, out, sizeof(out)) != 0)
+                abort();
+            sink = sink + out[0];
+        }));
+}
+
+static bool writeCsv(const char* fn, const vector<Result>& results) {
+    ofstream f(fn);
+    if (!f.good())
+        return false;
+    f << "name,blocks,audio_s,wall_s,blocks_per_s,realtime,best_block_s" << endl;
+    for (const Result& r : results)
+        f << r.name << "," << r.blocks << "," << r.audioSec << "," << r.wallSec 
+          << "," << r.blocksPerSec() << "," << r.realtime() << "," 
+          << r.bestBlockSec << endl;
+    return true;
+}
+
+// Reads name -> blocks/sec from an earlier results file
+static bool readBaseline(const char* fn, vector<pair<string, double>>& baseline) {
+    ifstream f(fn);
+    if (!f.good())
+        return false;
+    string line;
+    // Skip the header
+    getline(f, line);
+    while (getline(f, line)) {
+        vector<string> cols;
+        stringstream ss(line);
+        string col;
+        while (getline(ss, col, ','))
+            cols.push_back(col);
+        if (cols.size() >= 5)
+            baseline.push_back({ cols[0], atof(cols[4].c_str()) });
+    }
+    return true;
+}
+
+int main(int argc, const char** argv) {
+
+    unsigned seconds = 120;
+    const char* outFn = 0;
+    const char* baselineFn = 0;
+    double tolerance = 0.2;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+            seconds = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            outFn = argv[++i];
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+            baselineFn = argv[++i];
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            tolerance = atof(argv[++i]);
+        else {
+            cerr << "Usage: audio-bench-1 [-s seconds] [-o results.csv] "
+                "[-b baseline.csv] [-t tolerance]" << endl;
+            return 2;
+        }
+    }
+
+    vector<Result> results;
+    benchCore<64>(seconds, results);
+    benchCore<128>(seconds, results);
+    benchCore<256>(seconds, results);
+    benchPort<64>(seconds, results);
+    benchPort<128>(seconds, results);
+    benchPort<256>(seconds, results);
+    benchLink(seconds, results);
+
+    vector<pair<string, double>> baseline;
+    if (baselineFn && !readBaseline(baselineFn, baseline)) {
+        cerr << "Unable to read " << baselineFn << endl;
+        return 2;
+    }
+
+    printf("%-16s %10s %12s %10s %9s\n", "Benchmark", "Blocks", "Blocks/sec", 
+        "Realtime", "Baseline");
+
+    unsigned failures = 0;
+    for (const Result& r : results) {
+        printf("%-16s %10u %12.0f %9.1fx", r.name.c_str(), r.blocks, 
+            r.blocksPerSec(), r.realtime());
+        for (const auto& b : baseline) {
+            if (b.first != r.name || b.second <= 0)
+                continue;
+            const double change = r.blocksPerSec() / b.second - 1.0;
+            printf(" %+8.1f%%", change * 100.0);
+            if (change < -tolerance) {
+                printf("  REGRESSION");
+                failures++;
+            }
+        }
+        printf("\n");
+    }
+
+    if (outFn && !writeCsv(outFn, results)) {
+        cerr << "Unable to write " << outFn << endl;
+        return 2;
+    }
+
+    if (failures) {
+        printf("%u benchmark(s) slower than the baseline by more than %.0f%%\n",
+            failures, tolerance * 100.0);
+        return 1;
+    }
+    return 0;
+}
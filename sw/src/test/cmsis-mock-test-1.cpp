@@ -0,0 +1,177 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+
+// Checks the host (mock) versions of the CMSIS-DSP filters against 
+// simple one-output-at-a-time implementations of what CMSIS does. The 
+// floating point results need to be exactly the same, which is what 
+// keeps the host simulations repeatable when the mock is changed.
+//
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <cassert>
+
+#include <arm_math.h>
+
+using namespace std;
+
+static float rnd() {
+    return (float)rand() / (float)RAND_MAX - 0.5f;
+}
+
+// Straight FIR on a continuous stream. Coefficients are in CMSIS 
+// (reversed) order so x[n] lines up with the last coefficient.
+static float refFir(const float* x, unsigned n, const float* c, unsigned numTaps) {
+    float a = 0;
+    for (unsigned i = 0; i < numTaps; i++) {
+        const int j = (int)n - (int)(numTaps - 1) + (int)i;
+        if (j >= 0 && c[i] != 0)
+            a += x[j] * c[i];
+    }
+    return a;
+}
+
+static void firTest() {
+    const unsigned numTaps = 127, blockSize = 64, blocks = 20;
+    float c[numTaps];
+    for (unsigned i = 0; i < numTaps; i++)
+        c[i] = rnd();
+    float state[numTaps + blockSize - 1];
+    arm_fir_instance_f32 f;
+    arm_fir_init_f32(&f, numTaps, c, state, blockSize);
+    static float x[blockSize * blocks];
+    for (unsigned i = 0; i < blockSize * blocks; i++)
+        x[i] = rnd();
+    for (unsigned b = 0; b < blocks; b++) {
+        float out[blockSize];
+        arm_fir_f32(&f, x + b * blockSize, out, blockSize);
+        for (unsigned k = 0; k < blockSize; k++)
+            assert(out[k] == refFir(x, b * blockSize + k, c, numTaps));
+    }
+}
+
+static void decimateTest() {
+    // Half-band style, every other tap is zero
+    const unsigned numTaps = 41, blockSize = 64, blocks = 20;
+    float c[numTaps];
+    for (unsigned i = 0; i < numTaps; i++)
+        c[i] = (i % 2 == 0 && i != 20) ? 0 : rnd();
+    float state[numTaps + blockSize - 1];
+    arm_fir_decimate_instance_f32 f;
+    arm_fir_decimate_init_f32(&f, numTaps, 2, c, state, blockSize);
+    static float x[blockSize * blocks];
+    for (unsigned i = 0; i < blockSize * blocks; i++)
+        x[i] = rnd();
+    for (unsigned b = 0; b < blocks; b++) {
+        float out[blockSize / 2];
+        arm_fir_decimate_f32(&f, x + b * blockSize, out, blockSize);
+        // Same as CMSIS, output k ends at input 2k + 1
+        for (unsigned k = 0; k < blockSize / 2; k++)
+            assert(out[k] == refFir(x, b * blockSize + 2 * k + 1, c, numTaps));
+    }
+}
+
+static void interpolateTest() {
+    const unsigned L = 4, numTaps = 124, blockSize = 16, blocks = 20;
+    const unsigned phaseLength = numTaps / L;
+    float c[numTaps];
+    for (unsigned i = 0; i < numTaps; i++)
+        c[i] = rnd();
+    float state[phaseLength + blockSize - 1];
+    arm_fir_interpolate_instance_f32 f;
+    arm_fir_interpolate_init_f32(&f, L, numTaps, c, state, blockSize);
+    static float x[blockSize * blocks];
+    for (unsigned i = 0; i < blockSize * blocks; i++)
+        x[i] = rnd();
+    for (unsigned b = 0; b < blocks; b++) {
+        float out[blockSize * L];
+        arm_fir_interpolate_f32(&f, x + b * blockSize, out, blockSize);
+        // Each input produces L outputs from the phaseLength inputs that
+        // end with it, output j of the group uses every L'th coefficient
+        // starting at L - 1 - j.
+        for (unsigned k = 0; k < blockSize * L; k++) {
+            const unsigned n = b * blockSize + k / L;
+            const unsigned j = k % L;
+            float a = 0;
+            for (unsigned i = 0; i < phaseLength; i++) {
+                const int m = (int)n - (int)(phaseLength - 1) + (int)i;
+                if (m >= 0)
+                    a += x[m] * c[(L - 1 - j) + i * L];
+            }
+            assert(out[k] == a);
+        }
+    }
+}
+
+static void biquadTest() {
+    // Two stages
+    const float c[10] = { 0.2, 0.3, 0.1, 0.5, -0.2,  1.0, -0.5, 0.25, 0.1, 0.05 };
+    float state[8];
+    arm_biquad_casd_df1_inst_f32 f;
+    arm_biquad_cascade_df1_init_f32(&f, 2, c, state);
+    const unsigned blockSize = 16, blocks = 10;
+    float x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+    float u1 = 0, u2 = 0, v1 = 0, v2 = 0;
+    for (unsigned b = 0; b < blocks; b++) {
+        float in[blockSize], out[blockSize];
+        for (unsigned i = 0; i < blockSize; i++)
+            in[i] = rnd();
+        arm_biquad_cascade_df1_f32(&f, in, out, blockSize);
+        for (unsigned i = 0; i < blockSize; i++) {
+            const float y = c[0] * in[i] + c[1] * x1 + c[2] * x2 + c[3] * y1 + c[4] * y2;
+            x2 = x1; x1 = in[i]; y2 = y1; y1 = y;
+            const float v = c[5] * y + c[6] * u1 + c[7] * u2 + c[8] * v1 + c[9] * v2;
+            u2 = u1; u1 = y; v2 = v1; v1 = v;
+            assert(out[i] == v);
+        }
+    }
+}
+
+static void q31Test() {
+    // Large values, where a 32-bit product would overflow
+    const unsigned numTaps = 4, blockSize = 8;
+    const q31_t c[numTaps] = { 0x40000000, -0x20000000, 0x10000000, 0x08000000 };
+    q31_t state[numTaps + blockSize - 1];
+    arm_fir_instance_q31 f;
+    arm_fir_init_q31(&f, numTaps, c, state, blockSize);
+    q31_t in[blockSize], out[blockSize];
+    for (unsigned i = 0; i < blockSize; i++)
+        in[i] = (i & 1) ? 0x70000000 : -0x70000000;
+    arm_fir_q31(&f, in, out, blockSize);
+    for (unsigned k = 0; k < blockSize; k++) {
+        double a = 0;
+        for (unsigned i = 0; i < numTaps; i++) {
+            const int j = (int)k - (int)(numTaps - 1) + (int)i;
+            if (j >= 0)
+                a += ((double)in[j] / 2147483648.0) * ((double)c[i] / 2147483648.0);
+        }
+        assert(fabs((double)out[k] / 2147483648.0 - a) < 1e-9);
+    }
+}
+
+int main(int, const char**) {
+    firTest();
+    decimateTest();
+    interpolateTest();
+    biquadTest();
+    q31Test();
+    return 0;
+}
@@ -0,0 +1,371 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+
+// Tests for the compressed link audio: the mu-law tables, a round trip 
+// through each codec, the mixed-codec framing in the receive parser, 
+// compatibility with the older firmware, the codec negotiation, and the 
+// cost of encoding/decoding one 20ms frame.
+//
+#include <iostream>
+#include <cstring>
+#include <cmath>
+#include <cassert>
+#include <chrono>
+
+#include "kc1fsz-tools/Common.h"
+
+#include "cobs.h"
+
+#include "DigitalAudioPortRxHandler.h"
+#include "LinkCodec.h"
+#include "LinkCrc.h"
+#include "LinkSession.h"
+
+using namespace std;
+using namespace kc1fsz;
+
+static const unsigned N = LinkCodec::FRAME_SAMPLES;
+
+static void makeTone(unsigned frame, float freq, float amp, uint8_t* pcm16le) {
+    for (unsigned i = 0; i < N; i++) {
+        float t = (float)(frame * N + i) / 8000.0;
+        pack_int16_le((int16_t)(amp * 32767.0 * sin(2.0 * M_PI * freq * t)), 
+            pcm16le + i * 2);
+    }
+}
+
+/**
+ * @returns The SNR in dB of a round-trip through the codec, allowing for 
+ * a fixed delay in the codec.
+ */
+static float roundTripSnr(unsigned codec, unsigned delay) {
+    LinkCodec enc, dec;
+    const unsigned frames = 50;
+    static int16_t in[N * frames];
+    static int16_t out[N * frames];
+    for (unsigned f = 0; f < frames; f++) {
+        uint8_t pcm[N * 2];
+        makeTone(f, 700, 0.5, pcm);
+        for (unsigned i = 0; i < N; i++)
+            in[f * N + i] = unpack_int16_le(pcm + i * 2);
+        uint8_t payload[PAYLOAD_SIZE];
+        unsigned len = enc.encode(codec, pcm, payload);
+        assert(len == DigitalAudioPortRxHandler::payloadSize(
+            DigitalAudioPortRxHandler::makeFlags(codec, 0)));
+        assert(dec.decode(codec, payload, len, pcm));
+        for (unsigned i = 0; i < N; i++)
+            out[f * N + i] = unpack_int16_le(pcm + i * 2);
+    }
+    // Skip the first few frames to let the codec settle
+    double sig = 0, err = 0;
+    for (unsigned i = N * 10; i < N * frames; i++) {
+        double e = (double)out[i] - (double)in[i - delay];
+        sig += (double)in[i - delay] * (double)in[i - delay];
+        err += e * e;
+    }
+    return 10.0 * log10(sig / err);
+}
+
+/**
+ * The receive side of the older firmware (before the codec/capabilities
+ * flags): a fixed-size message is accumulated from each header byte and
+ * then decoded with the original decodeMsg().
+ */
+class LegacyReceiver {
+public:
+
+    void feed(const uint8_t* data, unsigned len) {
+        for (unsigned i = 0; i < len; i++) {
+            if (data[i] == HEADER_CODE) {
+                _msg[0] = 0;
+                _msgLen = 1;
+                _haveHeader = true;
+            } else if (_haveHeader) {
+                _msg[_msgLen++] = data[i];
+                if (_msgLen == NETWORK_MESSAGE_SIZE) {
+                    uint8_t payload[PAYLOAD_SIZE];
+                    if (decodeMsg(_msg, _msgLen, payload, PAYLOAD_SIZE) == 0)
+                        rxCount++;
+                    else
+                        badCount++;
+                    _haveHeader = false;
+                }
+            }
+        }
+    }
+
+    unsigned rxCount = 0;
+    unsigned badCount = 0;
+
+private:
+
+    // Copied from the older DigitalAudioPortRxHandler
+    static int decodeMsg(const uint8_t* msg, unsigned msgLen,
+        uint8_t* payload, unsigned payloadLen) {    
+        assert(msgLen == NETWORK_MESSAGE_SIZE);
+        assert(payloadLen == PAYLOAD_SIZE);
+        // Header
+        if (msg[0] != HEADER_CODE)
+            return -1;
+        // CRC is everything, including the header
+        int16_t expectedCrc = linkCrc(msg, 1 + FLAGS_LEN + PAYLOAD_SIZE + COBS_OVERHEAD);
+        int16_t crc = DigitalAudioPortRxHandler::decodeCrc(msg + NETWORK_MESSAGE_SIZE - 3);
+        if (crc != expectedCrc)
+            return -2;
+        if (msg[1] != 0x01)
+            return -3;
+        unsigned cobsOverhead = msg[2];
+        if (!(cobsOverhead == 1 || cobsOverhead == 2))
+            return -4;
+        cobs_decode_result rd = cobs_decode(payload, PAYLOAD_SIZE,
+            msg + 3, PAYLOAD_SIZE + cobsOverhead);
+        if (rd.status != COBS_DECODE_OK)
+            return -5;
+        if (rd.out_len != PAYLOAD_SIZE)
+            return -6;
+        return 0;
+    }
+
+    uint8_t _msg[NETWORK_MESSAGE_SIZE];
+    unsigned _msgLen = 0;
+    bool _haveHeader = false;
+};
+
+/**
+ * Moves everything that one session sends into the receive buffer of 
+ * another.
+ */
+static void transfer(LinkSession& from, LinkSession& to, uint8_t* toBuf,
+    unsigned toBufSize, unsigned& toWrPtr, unsigned& flagsSeen) {
+    from.processTx([toBuf, toBufSize, &toWrPtr, &flagsSeen](const uint8_t* msg, 
+        unsigned len) {
+        if (!(msg[1] & FLAGS_ANNOUNCE))
+            flagsSeen = msg[1];
+        for (unsigned i = 0; i < len; i++) {
+            toBuf[toWrPtr] = msg[i];
+            toWrPtr = (toWrPtr + 1) % toBufSize;
+        }
+        return 0;
+    });
+    to.processRx(toWrPtr);
+}
+
+int main(int, const char**) {
+
+    // ----- mu-law -----------------------------------------------------------
+
+    // Every code decodes and re-encodes to itself (other than the 
+    // duplicate zero)
+    for (unsigned u = 0; u < 256; u++) {
+        if (u == 0x7f)
+            continue;
+        assert(LinkCodec::linearToUlaw(LinkCodec::ulawToLinear(u)) == u);
+    }
+    // Some standard values
+    assert(LinkCodec::linearToUlaw(0) == 0xff);
+    assert(LinkCodec::ulawToLinear(0xff) == 0);
+    assert(LinkCodec::ulawToLinear(0x80) == 32124);
+    assert(LinkCodec::ulawToLinear(0x00) == -32124);
+    assert(LinkCodec::linearToUlaw(32767) == 0x80);
+    assert(LinkCodec::linearToUlaw(-32768) == 0x00);
+    // Monotonic
+    for (int i = -32768; i < 32767; i++) {
+        int a = LinkCodec::ulawToLinear(LinkCodec::linearToUlaw(i));
+        int b = LinkCodec::ulawToLinear(LinkCodec::linearToUlaw(i + 1));
+        assert(b >= a);
+    }
+
+    // ----- Round trips ------------------------------------------------------
+
+    float snrPcm = roundTripSnr(LINK_CODEC_PCM16, 0);
+    float snrUlaw = roundTripSnr(LINK_CODEC_ULAW, 0);
+    // GSM has no algorithmic delay at the frame level
+    float snrGsm = roundTripSnr(LINK_CODEC_GSM, 0);
+    printf("Round-trip SNR   : PCM16 %.1f dB, mu-law %.1f dB, GSM %.1f dB\n", 
+        snrPcm, snrUlaw, snrGsm);
+    assert(snrPcm > 90);
+    assert(snrUlaw > 30);
+
+    // ----- Framing ----------------------------------------------------------
+
+    {
+        // Messages with different codecs back-to-back in the ring
+        static uint8_t rxBuf[512];
+        DigitalAudioPortRxHandler h(rxBuf, sizeof(rxBuf));
+        unsigned wr = 0;
+        unsigned nextCodec = 0;
+        unsigned count = 0;
+        for (unsigned m = 0; m < 300; m++) {
+            const unsigned codec = m % LINK_CODEC_COUNT;
+            const uint8_t flags = DigitalAudioPortRxHandler::makeFlags(codec, 
+                LinkCodec::getCaps());
+            assert(DigitalAudioPortRxHandler::isValidFlags(flags));
+            const unsigned payloadLen = DigitalAudioPortRxHandler::payloadSize(flags);
+            uint8_t payload[PAYLOAD_SIZE];
+            for (unsigned i = 0; i < payloadLen; i++)
+                payload[i] = (m + i) & 0xff;
+            uint8_t msg[NETWORK_MESSAGE_SIZE];
+            const unsigned msgLen = DigitalAudioPortRxHandler::msgSize(flags);
+            DigitalAudioPortRxHandler::encodeMsg(payload, payloadLen, msg, msgLen, flags);
+            uint8_t check[PAYLOAD_SIZE];
+            assert(DigitalAudioPortRxHandler::decodeMsg(msg, msgLen, check, 
+                PAYLOAD_SIZE) == 0);
+            assert(memcmp(check, payload, payloadLen) == 0);
+            for (unsigned i = 0; i < msgLen; i++) {
+                rxBuf[wr] = msg[i];
+                wr = (wr + 1) % sizeof(rxBuf);
+            }
+            h.processRxBuf(wr, [&nextCodec, &count, m](const uint8_t* p, unsigned len, 
+                uint8_t flags) {
+                assert(DigitalAudioPortRxHandler::getCodec(flags) == nextCodec);
+                assert(DigitalAudioPortRxHandler::getCaps(flags) == LinkCodec::getCaps());
+                assert(len == DigitalAudioPortRxHandler::payloadSize(flags));
+                assert(p[0] == (m & 0xff));
+                nextCodec = (nextCodec + 1) % LINK_CODEC_COUNT;
+                count++;
+            });
+        }
+        assert(count == 300);
+        assert(h.getBadCount() == 0);
+
+        // The legacy flags byte is still valid and means PCM16 with
+        // no advertised capabilities
+        assert(DigitalAudioPortRxHandler::isValidFlags(0x01));
+        assert(DigitalAudioPortRxHandler::getCodec(0x01) == LINK_CODEC_PCM16);
+        assert(DigitalAudioPortRxHandler::getCaps(0x01) == 0);
+        assert(DigitalAudioPortRxHandler::msgSize(0x01) == NETWORK_MESSAGE_SIZE);
+        // Unknown codecs and empty announcements are rejected
+        assert(!DigitalAudioPortRxHandler::isValidFlags(0x00));
+        assert(!DigitalAudioPortRxHandler::isValidFlags(0x81));
+        // An announcement has no payload
+        const uint8_t ann = DigitalAudioPortRxHandler::makeAnnounceFlags(
+            LinkCodec::getCaps());
+        assert(DigitalAudioPortRxHandler::isValidFlags(ann));
+        assert(DigitalAudioPortRxHandler::msgSize(ann) == ANNOUNCE_MESSAGE_SIZE);
+        assert(!DigitalAudioPortRxHandler::isValidFlags(ann | FLAGS_SEQ));
+        // Round trip of an announcement (no payload buffer at all)
+        uint8_t annMsg[ANNOUNCE_MESSAGE_SIZE];
+        DigitalAudioPortRxHandler::encodeMsg(0, 0, annMsg, ANNOUNCE_MESSAGE_SIZE, ann);
+        assert(annMsg[0] == HEADER_CODE && annMsg[1] == ann && annMsg[2] == 1);
+        for (unsigned i = 1; i < ANNOUNCE_MESSAGE_SIZE; i++)
+            assert(annMsg[i] != 0);
+        uint8_t annPayload[1];
+        const int annRc = DigitalAudioPortRxHandler::decodeMsg(annMsg, 
+            ANNOUNCE_MESSAGE_SIZE, annPayload, sizeof(annPayload));
+        assert(annRc == 0);
+        // The sequence number adds a byte to the payload
+        assert(DigitalAudioPortRxHandler::isValidFlags(0x09));
+        assert(DigitalAudioPortRxHandler::payloadSize(0x09) == MAX_PAYLOAD_SIZE);
+        assert(DigitalAudioPortRxHandler::msgSize(0x09) == MAX_NETWORK_MESSAGE_SIZE);
+        assert(!DigitalAudioPortRxHandler::isValidFlags(0x07));
+    }
+
+    // ----- Older firmware on the other end ----------------------------------
+
+    {
+        // Everything that we send has to be acceptable to the older 
+        // firmware until it advertises capabilities (which it never will)
+        static uint8_t rxBuf[512];
+        LinkSession s(rxBuf, sizeof(rxBuf));
+        s.setCodec(LINK_CODEC_GSM);
+        LegacyReceiver legacy;
+        for (unsigned f = 0; f < 50; f++) {
+            uint8_t pcm[PAYLOAD_SIZE];
+            makeTone(f, 700, 0.5, pcm);
+            s.send(pcm, PAYLOAD_SIZE);
+            s.processTx([&legacy](const uint8_t* msg, unsigned len) {
+                // Only the original flags byte on audio frames
+                assert(len == ANNOUNCE_MESSAGE_SIZE || msg[1] == 0x01);
+                legacy.feed(msg, len);
+                return 0;
+            });
+            // The older firmware sends 0x01 frames back
+            uint8_t payload[PAYLOAD_SIZE] = { 0 };
+            uint8_t msg[NETWORK_MESSAGE_SIZE];
+            DigitalAudioPortRxHandler::encodeMsg(payload, PAYLOAD_SIZE, msg, 
+                NETWORK_MESSAGE_SIZE);
+            for (unsigned i = 0; i < NETWORK_MESSAGE_SIZE; i++)
+                rxBuf[(f * NETWORK_MESSAGE_SIZE + i) % sizeof(rxBuf)] = msg[i];
+            s.processRx(((f + 1) * NETWORK_MESSAGE_SIZE) % sizeof(rxBuf));
+            s.receive([](uint8_t, const uint8_t*, unsigned) { });
+        }
+        assert(legacy.rxCount == 50);
+        assert(legacy.badCount == 0);
+    }
+
+    // ----- Negotiation between two current peers ---------------------------
+
+    {
+        static uint8_t bufA[512], bufB[512];
+        LinkSession a(bufA, sizeof(bufA)), b(bufB, sizeof(bufB));
+        a.setCodec(LINK_CODEC_GSM);
+        b.setCodec(LINK_CODEC_ULAW);
+        unsigned wrA = 0, wrB = 0, flagsAtoB = 0, flagsBtoA = 0;
+        uint8_t pcm[PAYLOAD_SIZE];
+        makeTone(0, 700, 0.5, pcm);
+        // Both start out sending the original format
+        a.send(pcm, PAYLOAD_SIZE);
+        transfer(a, b, bufB, sizeof(bufB), wrB, flagsAtoB);
+        assert(flagsAtoB == 0x01);
+        // B has heard the announcement from A
+        b.send(pcm, PAYLOAD_SIZE);
+        transfer(b, a, bufA, sizeof(bufA), wrA, flagsBtoA);
+        assert(DigitalAudioPortRxHandler::getCodec(flagsBtoA) == LINK_CODEC_ULAW);
+        assert(flagsBtoA & FLAGS_SEQ);
+        a.send(pcm, PAYLOAD_SIZE);
+        transfer(a, b, bufB, sizeof(bufB), wrB, flagsAtoB);
+        assert(DigitalAudioPortRxHandler::getCodec(flagsAtoB) == LINK_CODEC_GSM);
+        assert(flagsAtoB & FLAGS_SEQ);
+        // And it stays that way
+        for (unsigned f = 0; f < 10; f++) {
+            b.send(pcm, PAYLOAD_SIZE);
+            transfer(b, a, bufA, sizeof(bufA), wrA, flagsBtoA);
+            a.send(pcm, PAYLOAD_SIZE);
+            transfer(a, b, bufB, sizeof(bufB), wrB, flagsAtoB);
+            a.receive([](uint8_t, const uint8_t*, unsigned) { });
+            b.receive([](uint8_t, const uint8_t*, unsigned) { });
+        }
+        assert(DigitalAudioPortRxHandler::getCodec(flagsBtoA) == LINK_CODEC_ULAW);
+        assert(DigitalAudioPortRxHandler::getCodec(flagsAtoB) == LINK_CODEC_GSM);
+        assert(a.getRxCodecErrors() == 0 && b.getRxCodecErrors() == 0);
+    }
+
+    // ----- Cost -------------------------------------------------------------
+
+    for (unsigned codec = 0; codec < LINK_CODEC_COUNT; codec++) {
+        LinkCodec c;
+        uint8_t pcm[N * 2];
+        makeTone(0, 700, 0.5, pcm);
+        uint8_t payload[PAYLOAD_SIZE];
+        const unsigned frames = 2000;
+        auto start = chrono::steady_clock::now();
+        for (unsigned f = 0; f < frames; f++) {
+            unsigned len = c.encode(codec, pcm, payload);
+            c.decode(codec, payload, len, pcm);
+        }
+        double us = chrono::duration<double>(chrono::steady_clock::now() - start).count() 
+            * 1e6 / frames;
+        const uint8_t flags = DigitalAudioPortRxHandler::makeFlags(codec, 0);
+        printf("Codec %u          : %3u byte messages, %8.2f us/frame (encode+decode)\n", 
+            codec, DigitalAudioPortRxHandler::msgSize(flags), us);
+    }
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+
+// Compares the table-driven link CRC against crcSlow(). Checks that
+// both produce the same result on random frames (i.e. the wire format
+// hasn't changed) and then reports the throughput of each.
+//
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <cassert>
+#include <chrono>
+
+#include "crc.h"
+
+#include "LinkCrc.h"
+#include "DigitalAudioPortRxHandler.h"
+
+using namespace std;
+using namespace kc1fsz;
+
+// The part of a frame that is covered by the CRC
+static const unsigned CRC_SPAN = 1 + FLAGS_LEN + PAYLOAD_SIZE + COBS_OVERHEAD;
+static const unsigned FRAME_COUNT = 64;
+static const unsigned ITERATIONS = 2000;
+
+// Keeps the optimizer from throwing away the work
+static volatile uint16_t sink = 0;
+
+template<typename F> static double measure(const uint8_t* frames, F f) {
+    auto start = chrono::steady_clock::now();
+    uint16_t acc = 0;
+    for (unsigned i = 0; i < ITERATIONS; i++)
+        for (unsigned k = 0; k < FRAME_COUNT; k++)
+            acc ^= f(frames + k * CRC_SPAN, CRC_SPAN);
+    auto end = chrono::steady_clock::now();
+    sink = acc;
+    double sec = chrono::duration<double>(end - start).count();
+    return (double)ITERATIONS * FRAME_COUNT * CRC_SPAN / sec;
+}
+
+int main(int, const char**) {
+
+    static uint8_t frames[FRAME_COUNT * CRC_SPAN];
+    srand(1);
+    for (unsigned i = 0; i < sizeof(frames); i++)
+        frames[i] = rand() & 0xff;
+
+    // Standard check value
+    const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    assert(crcSlow(check, 9) == 0x29b1);
+    assert(linkCrc(check, 9) == 0x29b1);
+
+    // Bit-compatibility on every length, including the partial/empty cases
+    for (unsigned k = 0; k < FRAME_COUNT; k++) 
+        for (unsigned len = 0; len <= CRC_SPAN; len++) 
+            assert(crcSlow(frames + k * CRC_SPAN, len) == 
+                linkCrc(frames + k * CRC_SPAN, len));
+
+    // Full encode/decode round trip through the link framing
+    uint8_t msg[NETWORK_MESSAGE_SIZE];
+    uint8_t payload[PAYLOAD_SIZE];
+    DigitalAudioPortRxHandler::encodeMsg(frames, PAYLOAD_SIZE, msg, NETWORK_MESSAGE_SIZE);
+    assert(DigitalAudioPortRxHandler::decodeMsg(msg, NETWORK_MESSAGE_SIZE, 
+        payload, PAYLOAD_SIZE) == 0);
+    assert(memcmp(payload, frames, PAYLOAD_SIZE) == 0);
+    assert((uint16_t)DigitalAudioPortRxHandler::decodeCrc(msg + NETWORK_MESSAGE_SIZE - 3) ==
+        crcSlow(msg, CRC_SPAN));
+
+    const double slowRate = measure(frames, 
+        [](const uint8_t* d, unsigned n) { return (uint16_t)crcSlow(d, n); });
+    const double fastRate = measure(frames, 
+        [](const uint8_t* d, unsigned n) { return linkCrc(d, n); });
+
+    printf("Frame CRC span   : %u bytes\n", CRC_SPAN);
+    printf("crcSlow          : %8.2f MB/s\n", slowRate / 1e6);
+    printf("linkCrc          : %8.2f MB/s\n", fastRate / 1e6);
+    printf("Speedup          : %8.2fx\n", fastRate / slowRate);
+
+    return 0;
+}
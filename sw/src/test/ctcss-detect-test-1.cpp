@@ -0,0 +1,109 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+
+// Unit test for the sliding-window CTCSS detector. Checks the level, 
+// the confidence against a neighbouring tone and noise, and how long it
+// takes to lock onto a tone that has just come on.
+//
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+#include "CtcssDetector.h"
+
+using namespace std;
+using namespace kc1fsz;
+
+static const double PI2 = 2.0 * 3.14159265358979323846;
+static const unsigned BLOCK_SIZE = 8;
+
+/**
+ * Feeds the detector a tone (plus noise) for some number of samples.
+ */
+static void feed(CtcssDetector& det, unsigned& t, unsigned samples, 
+    float toneHz, float toneAmp, float noiseAmp) {
+    float block[BLOCK_SIZE];
+    for (unsigned b = 0; b < samples / BLOCK_SIZE; b++) {
+        for (unsigned i = 0; i < BLOCK_SIZE; i++, t++) 
+            block[i] = toneAmp * cos(PI2 * toneHz * t / CtcssDetector::FS) + 
+                noiseAmp * ((float)rand() / (float)RAND_MAX - 0.5);
+        det.process(block, BLOCK_SIZE);
+    }
+}
+
+int main(int, const char**) {
+
+    CtcssDetector det;
+    det.setFreq(123.0);
+
+    // Level of a clean tone. The window isn't a whole number of cycles
+    // so the level ripples a little (+/- 0.3 dB at the low end).
+    unsigned t = 0;
+    feed(det, t, 200, 123.0, 0.1, 0);
+    printf("Clean:     mag %f confidence %f\n", det.getMag(), det.getConfidence());
+    assert(fabs(det.getMag() - 0.1) < 0.005);
+    assert(det.getConfidence() > 0.95);
+
+    // The gain of the stage in front is taken back out
+    det.setFreq(123.0, 2.0);
+    feed(det, t, 200, 123.0, 0.2, 0);
+    assert(fabs(det.getMag() - 0.1) < 0.005);
+
+    // A tone with some noise on top 
+    det.setFreq(123.0);
+    feed(det, t, 200, 123.0, 0.1, 0.1);
+    printf("Noisy:     mag %f confidence %f\n", det.getMag(), det.getConfidence());
+    assert(fabs(det.getMag() - 0.1) < 0.01);
+    assert(det.getConfidence() > 0.8);
+
+    // A strong tone two steps away leaks into the level, but the 
+    // confidence is low
+    det.reset();
+    feed(det, t, 200, 136.5, 0.2, 0);
+    printf("Neighbour: mag %f confidence %f\n", det.getMag(), det.getConfidence());
+    assert(det.getConfidence() < 0.15);
+
+    // Noise only
+    det.reset();
+    feed(det, t, 200, 0, 0, 0.2);
+    printf("Noise:     mag %f confidence %f\n", det.getMag(), det.getConfidence());
+    assert(det.getConfidence() < 0.25);
+
+    // Silence 
+    det.reset();
+    feed(det, t, 200, 0, 0, 0);
+    assert(det.getMag() == 0);
+    assert(det.getConfidence() == 0);
+
+    // Lock time for a tone that comes on after noise
+    det.reset();
+    feed(det, t, 200, 0, 0, 0.02);
+    unsigned lockMs = 0;
+    while (det.getConfidence() < 0.3) {
+        feed(det, t, BLOCK_SIZE, 123.0, 0.1, 0.02);
+        lockMs += BLOCK_SIZE;
+        assert(lockMs < 1000);
+    }
+    printf("Lock:      %u ms\n", lockMs);
+    assert(lockMs <= 40);
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+
+// Checks the CTCSS elimination in both of the filter modes. A tone plus
+// a 1 kHz "voice" tone go in and the receive audio that comes out (the 
+// 8k audio that goes onto the mix bus) is measured at both frequencies.
+//
+#include <iostream>
+#include <cassert>
+#include <cmath>
+
+#include "TestClock.h"
+#include "AudioCore.h"
+
+using namespace std;
+using namespace kc1fsz;
+
+static const double PI2 = 2.0 * 3.14159265358979323846;
+
+/**
+ * @returns The amplitude at hz (single-bin DFT).
+ */
+static float level(const float* x, unsigned n, float hz, unsigned fs) {
+    double re = 0, im = 0;
+    for (unsigned i = 0; i < n; i++) {
+        re += x[i] * cos(PI2 * hz * i / fs);
+        im += x[i] * sin(PI2 * hz * i / fs);
+    }
+    return 2.0 * sqrt(re * re + im * im) / (double)n;
+}
+
+/**
+ * @returns The tone rejection (dB) relative to the 1 kHz level.
+ */
+static float rejection(uint32_t mode, float toneHz) {
+
+    TestClock clock;
+    AudioCore core(0, clock);
+    core.setAgcEnabled(false);
+    core.setHpfMode(mode);
+    core.setCtcssDecodeFreq(toneHz);
+
+    // 2 seconds, the second one is measured
+    const unsigned blocks = 2 * AudioCore::FS_ADC / AudioCore::BLOCK_SIZE_ADC;
+    const unsigned measureLen = (blocks / 2) * AudioCore::BLOCK_SIZE;
+    float* out = new float[measureLen];
+    int32_t in[AudioCore::BLOCK_SIZE_ADC];
+    float cross[AudioCore::BLOCK_SIZE];
+    unsigned t = 0;
+
+    for (unsigned b = 0; b < blocks; b++) {
+        for (unsigned i = 0; i < AudioCore::BLOCK_SIZE_ADC; i++, t++) {
+            const double v = 0.1 * cos(PI2 * toneHz * t / AudioCore::FS_ADC) + 
+                0.1 * cos(PI2 * 1000.0 * t / AudioCore::FS_ADC);
+            in[i] = v * 2147483647.0;
+        }
+        core.cycleRx(in, cross);
+        if (b >= blocks / 2)
+            for (unsigned i = 0; i < AudioCore::BLOCK_SIZE; i++)
+                out[(b - blocks / 2) * AudioCore::BLOCK_SIZE + i] = cross[i];
+    }
+
+    const float tone = level(out, measureLen, toneHz, AudioCore::FS);
+    const float voice = level(out, measureLen, 1000.0, AudioCore::FS);
+    delete [] out;
+    return 20.0 * log10(voice / tone);
+}
+
+int main(int, const char**) {
+
+    const float tones[] = { 67.0, 100.0, 123.0, 162.2, 203.5, 250.3 };
+
+    printf("Tone    FIR(dB)  IIR(dB)\n");
+    for (float hz : tones) {
+        const float fir = rejection(AudioCore::HPF_MODE_FIR, hz);
+        const float iir = rejection(AudioCore::HPF_MODE_IIR, hz);
+        printf("%5.1f  %7.1f  %7.1f\n", hz, fir, iir);
+        // The FIR only really works on the low tones, the notch 
+        // should handle all of them
+        assert(iir > 40.0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+
+// Unit test for the CTCSS tone scanner. Each of the standard tones is 
+// sent (with some speech-band audio on top) and the scanner needs to 
+// pick the right one and get the level right.
+//
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+#include "CtcssScanner.h"
+
+using namespace std;
+using namespace kc1fsz;
+
+static const double PI2 = 2.0 * 3.14159265358979323846;
+
+/**
+ * Runs the scanner over a tone (plus some other audio) until one full 
+ * window has been completed after the start-up.
+ */
+static void run(CtcssScanner& scanner, float toneHz, float toneAmp, 
+    float voiceAmp) {
+    const unsigned fs = CtcssScanner::FS_IN;
+    const unsigned blockSize = 32;
+    float block[blockSize];
+    unsigned t = 0;
+    scanner.reset();
+    const uint32_t start = scanner.getWindowCount();
+    // The first window includes the LPF start-up so it is skipped
+    while (scanner.getWindowCount() < start + 2) {
+        for (unsigned i = 0; i < blockSize; i++, t++) {
+            float v = toneAmp * cos(PI2 * toneHz * t / fs);
+            // A few tones in the voice band, plus a little noise
+            v += voiceAmp * (cos(PI2 * 440.0 * t / fs) + 
+                cos(PI2 * 720.0 * t / fs) + cos(PI2 * 1250.0 * t / fs));
+            v += 0.1 * voiceAmp * ((float)rand() / (float)RAND_MAX - 0.5);
+            block[i] = v;
+        }
+        scanner.process(block, blockSize);
+    }
+}
+
+int main(int, const char**) {
+
+    CtcssScanner scanner;
+
+    assert(CtcssScanner::findTone(88.5) == 8);
+    assert(CtcssScanner::findTone(123) == 18);
+    assert(CtcssScanner::findTone(254.1) == 49);
+    assert(CtcssScanner::findTone(150.0) == -1);
+
+    // Every tone, clean and under audio that is 20 dB stronger
+    const float voiceAmps[] = { 0, 0.2 };
+    for (float voiceAmp : voiceAmps) {
+        for (unsigned k = 0; k < CtcssScanner::TONE_COUNT; k++) {
+            const float amp = 0.02;
+            run(scanner, CtcssScanner::TONES[k], amp, voiceAmp);
+            assert(scanner.getStrongestTone() == (int)k);
+            const float errDb = 20.0 * log10(scanner.getStrongestMag() / amp);
+            assert(fabs(errDb) < ((voiceAmp == 0) ? 0.1 : 0.5));
+        }
+    }
+
+    // The closest pair of tones are well separated
+    run(scanner, 67.0, 0.02, 0);
+    assert(scanner.getMag(1) < 0.02 * 0.2);
+    run(scanner, 69.3, 0.02, 0);
+    assert(scanner.getMag(0) < 0.02 * 0.2);
+
+    // An encoder that is a little off frequency still works
+    run(scanner, 100.4, 0.02, 0.2);
+    assert(scanner.getStrongestTone() == CtcssScanner::findTone(100.0));
+
+    // Nothing there, just the voice
+    run(scanner, 0, 0, 0.2);
+    assert(scanner.getStrongestMag() < 0.02 * 0.1);
+
+    cout << "OK" << endl;
+    return 0;
+}
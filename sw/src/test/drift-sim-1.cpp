@@ -0,0 +1,157 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+
+// Simulates a long transmission from a peer whose clock is off from ours
+// by a given number of ppm. Frames arrive every 20ms of *peer* time (with
+// a bit of jitter) and are played out in 8ms blocks of *local* time.
+//
+// The first set of columns is the plain JitterBuffer, which has to drop
+// or conceal frames every time the drift adds up to a frame. The second
+// set is the full DigitalAudioPort receive path with the DriftResampler,
+// which should run indefinitely with no underruns/overruns and a bounded
+// depth.
+//
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+#include "kc1fsz-tools/Common.h"
+
+#include "TestClock.h"
+#include "JitterBuffer.h"
+#include "DigitalAudioPort.h"
+
+using namespace std;
+using namespace kc1fsz;
+
+typedef DigitalAudioPortT<256> Port;
+
+static const unsigned FRAME = JitterBuffer::FRAME_SAMPLES;
+static const uint32_t BLOCK_MS = 8;
+// Length of the simulated transmission
+static const unsigned SIM_S = 30 * 60;
+// Time to ignore at the start while the loop pulls in
+static const unsigned SETTLE_S = 60;
+static const uint32_t JITTER_US = 5000;
+
+struct Result {
+    JitterBuffer::Stats stats;
+    unsigned minDepth;
+    unsigned maxDepth;
+    float ppm;
+};
+
+// Calls f(seq, frame, arrivalUs) for each frame that arrives by nowUs
+template<typename F> static void arrivals(double ppm, uint64_t nowUs, unsigned& next, 
+    F f) {
+    const double periodUs = 20000.0 / (1.0 + ppm * 1e-6);
+    while (true) {
+        const uint64_t t = (uint64_t)((double)next * periodUs) + (rand() % JITTER_US);
+        if (t > nowUs)
+            break;
+        uint8_t pcm[FRAME * 2];
+        for (unsigned i = 0; i < FRAME; i++)
+            pack_int16_le((int16_t)(8000.0 * sin((next * FRAME + i) * 0.3)), pcm + i * 2);
+        f((uint8_t)next, pcm);
+        next++;
+    }
+}
+
+static Result runPlain(double ppm) {
+    JitterBuffer jb(Port::BLOCK_SIZE);
+    Result r = { };
+    r.minDepth = ~0U;
+    unsigned next = 0;
+    srand(1);
+    for (uint64_t ms = 0; ms < SIM_S * 1000; ms += BLOCK_MS) {
+        arrivals(ppm, ms * 1000, next, [&jb, ms](uint8_t seq, const uint8_t* pcm) {
+            jb.put(seq, pcm, ms * 1000);
+        });
+        float out[Port::BLOCK_SIZE];
+        jb.get(out);
+        if (ms > SETTLE_S * 1000) {
+            r.minDepth = min(r.minDepth, jb.getDepth());
+            r.maxDepth = max(r.maxDepth, jb.getDepth());
+        }
+    }
+    jb.getStats(&r.stats);
+    return r;
+}
+
+static Result runPort(double ppm) {
+    TestClock clock;
+    Port port(0, clock);
+    Result r = { };
+    r.minDepth = ~0U;
+    unsigned next = 0;
+    srand(1);
+    for (uint64_t ms = 0; ms < SIM_S * 1000; ms += BLOCK_MS) {
+        clock.setTime(ms);
+        arrivals(ppm, ms * 1000, next, [&port](uint8_t seq, const uint8_t* pcm) {
+            port.loadNetworkAudio(seq, pcm, FRAME * 2);
+        });
+        float out[Port::BLOCK_SIZE];
+        port.cycleRx(out);
+        if (ms > SETTLE_S * 1000) {
+            JitterBuffer::Stats st;
+            port.getJitterStats(&st);
+            r.minDepth = min(r.minDepth, (unsigned)st.depth);
+            r.maxDepth = max(r.maxDepth, (unsigned)st.depth);
+        }
+    }
+    port.getJitterStats(&r.stats);
+    r.ppm = port.getDriftPpm();
+    return r;
+}
+
+int main(int, const char**) {
+
+    printf("%u minute transmission, %u ms jitter\n\n", SIM_S / 60, JITTER_US / 1000);
+    printf("         | Jitter buffer only              | With drift resampler\n");
+    printf("  Offset | Under  Over  Concl   Depth(ms) | Under  Over  Concl   Depth(ms)   Est\n");
+    printf("   (ppm) |                                 |                              (ppm)\n");
+
+    const double offsets[] = { -1000, -500, -200, -100, -50, -10, 0, 
+        10, 50, 100, 200, 500, 1000 };
+    for (double ppm : offsets) {
+        const Result a = runPlain(ppm);
+        const Result b = runPort(ppm);
+        printf("  %+6.0f | %5u %5u %5u  %4u - %4u | %5u %5u %5u  %4u - %4u  %+6.1f\n", 
+            ppm, 
+            a.stats.underruns, a.stats.overruns, a.stats.concealed, 
+            a.minDepth / 8, a.maxDepth / 8,
+            b.stats.underruns, b.stats.overruns, b.stats.concealed, 
+            b.minDepth / 8, b.maxDepth / 8, b.ppm);
+        // Anything inside of the correction range should run clean 
+        // with the depth held to within a few ms.
+        if (fabs(ppm) < DriftResampler::MAX_PPM) {
+            assert(b.stats.underruns == 0);
+            assert(b.stats.overruns == 0);
+            assert(b.stats.concealed == 0);
+            assert(b.maxDepth - b.minDepth < FRAME + 16 * 8);
+            assert(fabs(b.ppm - ppm) < 30);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,311 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+
+// Simulation of the network receive path: 20ms frames arrive with 
+// jitter/loss/re-ordering and are pulled out in 8ms audio blocks, with
+// the arrivals only noticed on audio block boundaries (which is how 
+// the firmware works). Checks that the output is the input stream 
+// (delayed) and looks at the statistics.
+//
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <cassert>
+#include <vector>
+#include <algorithm>
+
+#include "kc1fsz-tools/Common.h"
+
+#include "JitterBuffer.h"
+
+using namespace std;
+using namespace kc1fsz;
+
+static const unsigned FRAME = JitterBuffer::FRAME_SAMPLES;
+static const unsigned BLOCK = 64;
+static const uint32_t BLOCK_US = 8000;
+static const uint32_t FRAME_US = 20000;
+
+// Input sample n of the stream. Never zero so that silence is 
+// easy to spot.
+static int16_t sampleAt(unsigned n) {
+    return (int16_t)(1 + (n * 37) % 20000);
+}
+
+struct Scenario {
+    const char* name;
+    unsigned frames;
+    // Peak arrival jitter (uniform)
+    uint32_t jitterUs;
+    // Percent of frames lost
+    unsigned lossPct;
+    // Percent of frames swapped with the next one
+    unsigned swapPct;
+    // Percent of frames that are delivered twice
+    unsigned dupPct;
+    // Frame number where a stall happens (everything is held back and
+    // then released at once), or 0
+    unsigned stallAt;
+    uint32_t stallUs;
+};
+
+struct Result {
+    JitterBuffer::Stats stats;
+    // Output samples that were an exact (in order) copy of the input
+    unsigned matched;
+    // Silence in the middle of a talk-spurt
+    unsigned zeroGaps;
+    unsigned lost;
+    unsigned maxDepth;
+    unsigned firstTarget;
+    // Statistics at the end of the first talk-spurt
+    JitterBuffer::Stats first;
+};
+
+static Result run(const Scenario& sc, unsigned spurts = 1) {
+
+    JitterBuffer jb(BLOCK);
+    Result r;
+    memset(&r, 0, sizeof(r));
+    srand(7);
+
+    for (unsigned spurt = 0; spurt < spurts; spurt++) {
+
+        // Build the arrival schedule
+        struct Arrival { uint32_t us; unsigned frame; };
+        vector<Arrival> arrivals;
+        const uint32_t t0 = spurt * (sc.frames + 50) * FRAME_US;
+        for (unsigned f = 0; f < sc.frames; f++) {
+            if (sc.lossPct && (unsigned)(rand() % 100) < sc.lossPct && 
+                f > 0 && f < sc.frames - 1) {
+                r.lost++;
+                continue;
+            }
+            uint32_t t = t0 + f * FRAME_US + (sc.jitterUs ? rand() % sc.jitterUs : 0);
+            if (sc.stallAt && f >= sc.stallAt && f < sc.stallAt + sc.stallUs / FRAME_US)
+                t = t0 + sc.stallAt * FRAME_US + sc.stallUs;
+            arrivals.push_back({ t, f });
+            if (sc.dupPct && (unsigned)(rand() % 100) < sc.dupPct)
+                arrivals.push_back({ t, f });
+        }
+        for (unsigned i = 0; i + 1 < arrivals.size(); i++) {
+            if (sc.swapPct && (unsigned)(rand() % 100) < sc.swapPct) {
+                swap(arrivals[i].frame, arrivals[i + 1].frame);
+                i++;
+            }
+        }
+        stable_sort(arrivals.begin(), arrivals.end(), 
+            [](const Arrival& a, const Arrival& b) { return a.us < b.us; });
+
+        // Run the audio ticks
+        const unsigned ticks = (sc.frames * FRAME_US + 500000) / BLOCK_US;
+        unsigned next = 0;
+        // Position in the input stream that we expect to see next
+        unsigned expect = 0;
+        bool started = false, inGap = false, tentative = false;
+        unsigned anchor = 0, zeroRun = 0;
+        for (unsigned tick = 0; tick < ticks; tick++) {
+            const uint32_t now = t0 + tick * BLOCK_US;
+            while (next < arrivals.size() && arrivals[next].us <= now) {
+                uint8_t pcm[FRAME * 2];
+                const unsigned f = arrivals[next].frame;
+                for (unsigned i = 0; i < FRAME; i++)
+                    pack_int16_le(sampleAt(f * FRAME + i), pcm + i * 2);
+                jb.put((uint8_t)(f + spurt * 100), pcm, now);
+                next++;
+            }
+            float out[BLOCK];
+            jb.get(out);
+            JitterBuffer::Stats st;
+            jb.getStats(&st);
+            if (spurt == 0 && r.firstTarget == 0 && jb.isPlaying())
+                r.firstTarget = st.target;
+            r.maxDepth = max(r.maxDepth, (unsigned)st.depth);
+            for (unsigned i = 0; i < BLOCK; i++) {
+                const int16_t s = (int16_t)lround(out[i] * 32767.0f);
+                // A few zeros can come out of a deep fade, a longer run
+                // is a gap in the audio.
+                if (s == 0) {
+                    if (started && ++zeroRun >= 16)
+                        inGap = true;
+                    continue;
+                }
+                zeroRun = 0;
+                // Either the next sample in the input or the start of a
+                // later frame (frames are only ever skipped whole). 
+                // Anything else is concealment or a fade.
+                const unsigned base = expect - expect % FRAME;
+                unsigned k;
+                for (k = 0; k <= 8; k++) {
+                    const unsigned n = (k == 0) ? expect : base + k * FRAME;
+                    if (s == sampleAt(n)) {
+                        if (k == 0)
+                            tentative = false;
+                        else {
+                            // A faded sample can look like the start of a
+                            // frame by accident, so a jump isn't trusted
+                            // until the next sample agrees.
+                            anchor = expect;
+                            tentative = true;
+                        }
+                        if (inGap && n < (sc.frames - 1) * FRAME)
+                            r.zeroGaps++;
+                        inGap = false;
+                        started = true;
+                        expect = n + 1;
+                        r.matched++;
+                        break;
+                    }
+                }
+                if (k > 8 && tentative) {
+                    expect = anchor;
+                    tentative = false;
+                    r.matched--;
+                }
+            }
+        }
+        if (spurt == 0)
+            jb.getStats(&r.first);
+        assert(next == arrivals.size());
+    }
+    jb.getStats(&r.stats);
+    return r;
+}
+
+static void show(const Scenario& sc, const Result& r) {
+    printf("%-10s frames %5u lost %3u under %2u over %3u late %3u conceal %3u depth(max) %3u ms target %3u->%3u ms jitter %5.1f ms\n",
+        sc.name, r.stats.frames, r.lost, r.stats.underruns, r.stats.overruns, r.stats.late, 
+        r.stats.concealed, r.maxDepth / 8, r.firstTarget / 8, r.stats.target / 8, 
+        (float)r.stats.jitterUs / 1000.0);
+}
+
+int main(int, const char**) {
+
+    const unsigned tail = JitterBuffer::MAX_CONCEAL_FRAMES;
+
+    // Clean network. The end of the talk-spurt is the only underrun 
+    // and the only concealment is the fade-out at the end.
+    {
+        Scenario sc = { "clean", 1000, 0, 0, 0, 0, 0, 0 };
+        Result r = run(sc);
+        show(sc, r);
+        assert(r.stats.frames == 1000);
+        assert(r.stats.underruns == 1);
+        assert(r.stats.concealed == tail);
+        assert(r.matched == 1000 * FRAME);
+        assert(r.zeroGaps == 0);
+    }
+
+    // Duplicates are ignored
+    {
+        Scenario sc = { "dup", 1000, 0, 0, 0, 10, 0, 0 };
+        Result r = run(sc);
+        show(sc, r);
+        assert(r.stats.frames == 1000);
+        assert(r.stats.underruns == 1);
+        assert(r.stats.concealed == tail);
+        assert(r.matched == 1000 * FRAME);
+    }
+
+    // Random loss is concealed without breaking the talk-spurt. The 
+    // frame after a concealed frame is faded back in so it doesn't 
+    // count as matched.
+    {
+        Scenario sc = { "loss", 1000, 0, 5, 0, 0, 0, 0 };
+        Result r = run(sc);
+        show(sc, r);
+        assert(r.lost > 0);
+        assert(r.stats.concealed == r.lost + tail);
+        assert(r.stats.underruns == 1);
+        assert(r.matched >= (1000 - 2 * r.lost) * FRAME);
+        assert(r.zeroGaps == 0);
+    }
+
+    // Re-ordering and jitter: the first talk-spurt starts out with no 
+    // estimate and takes a hit or two (late frames get concealed), but 
+    // the target grows right away so that the rest of the talk-spurt is
+    // clean. The second talk-spurt starts out with the bigger target.
+    {
+        Scenario scs[] = {
+            { "reorder", 1000, 0, 0, 10, 0, 0, 0 },
+            { "jitter", 1000, 30000, 0, 0, 0, 0, 0 }
+        };
+        for (const Scenario& sc : scs) {
+            Result r = run(sc, 2);
+            show(sc, r);
+            assert(r.first.late > 0);
+            assert(r.first.late <= 3);
+            assert(r.stats.target > r.firstTarget);
+            assert(r.stats.late == r.first.late);
+            assert(r.stats.concealed - r.first.concealed == tail);
+            assert(r.stats.underruns - r.first.underruns == 1);
+            assert(r.stats.frames - r.first.frames == 1000);
+        }
+    }
+
+    // The sequence numbers start over (i.e. the peer restarted) between
+    // talk-spurts. The new talk-spurt plays right away instead of being
+    // thrown out as late.
+    {
+        JitterBuffer jb(BLOCK);
+        uint32_t now = 0;
+        float out[BLOCK];
+        unsigned tick = 0;
+        for (unsigned spurt = 0; spurt < 2; spurt++) {
+            const unsigned firstSeq = (spurt == 0) ? 40 : 0;
+            for (unsigned f = 0; f < 50; f++) {
+                uint8_t pcm[FRAME * 2];
+                for (unsigned i = 0; i < FRAME; i++)
+                    pack_int16_le(sampleAt(f * FRAME + i), pcm + i * 2);
+                jb.put((uint8_t)(firstSeq + f), pcm, now);
+                // Run the audio ticks up to the next frame
+                for (; tick * BLOCK_US < now + FRAME_US; tick++)
+                    jb.get(out);
+                now += FRAME_US;
+            }
+            // Let it play out and stop
+            for (unsigned i = 0; i < 100; i++, tick++)
+                jb.get(out);
+            now = tick * BLOCK_US;
+            assert(!jb.isPlaying());
+        }
+        JitterBuffer::Stats st;
+        jb.getStats(&st);
+        printf("seqreset   frames %5u under %2u late %3u\n", st.frames, 
+            st.underruns, st.late);
+        assert(st.frames == 100);
+        assert(st.late == 0);
+        assert(st.underruns == 2);
+    }
+
+    // A 200ms stall followed by a burst. The buffer trims itself back
+    // down instead of carrying the extra delay for the rest of the 
+    // talk-spurt.
+    {
+        Scenario sc = { "stall", 1000, 0, 0, 0, 0, 300, 200000 };
+        Result r = run(sc);
+        show(sc, r);
+        assert(r.stats.overruns > 0);
+        assert(r.maxDepth <= r.stats.target + 3 * FRAME);
+    }
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+
+// Measures the receive->transmit latency of the audio path for each of
+// the supported block sizes and both of the CTCSS filter modes.
+//
+// An impulse is pushed through cycleRx()/cycleTx() and the position of
+// the peak in the output gives the delay through the DSP (filter group
+// delays, mostly). On top of that the DMA buffering adds:
+//
+//  * One full block on the ADC side (the block must be complete before
+//    it can be processed).
+//  * Between zero and one block on the DAC side, depending on the
+//    phase between the ADC and DAC DMA cycles.
+//
+#include <iostream>
+#include <cstring>
+#include <cmath>
+
+#include "TestClock.h"
+#include "AudioCore.h"
+
+using namespace std;
+using namespace kc1fsz;
+
+template<unsigned BS> static void measure(uint32_t hpfMode) {
+
+    typedef AudioCoreT<BS> Core;
+
+    TestClock clock;
+    Core core(0, clock);
+    core.setAgcEnabled(false);
+    core.setCtcssEncodeEnabled(false);
+    core.setToneEnabled(false);
+    core.setRxDelayMs(0);
+    core.setHpfMode(hpfMode);
+
+    // 250ms of test audio with an impulse near the start
+    const unsigned blocks = (Core::FS_ADC / 4) / Core::BLOCK_SIZE_ADC;
+    const unsigned len = blocks * Core::BLOCK_SIZE_ADC;
+    const unsigned impulsePos = 1000;
+    int32_t in[len];
+    int32_t out[len];
+    memset(in, 0, sizeof(in));
+    in[impulsePos] = 0x40000000;
+
+    // The mix bus is bypassed here since it doesn't add any delay
+    float cross[Core::BLOCK_SIZE];
+
+    for (unsigned b = 0; b < blocks; b++) {
+        core.cycleRx(in + b * Core::BLOCK_SIZE_ADC, cross);
+        core.cycleTx(cross, out + b * Core::BLOCK_SIZE_ADC);
+    }
+
+    // Find the peak of the impulse response
+    unsigned peakPos = 0;
+    int32_t peak = 0;
+    for (unsigned i = 0; i < len; i++) {
+        int32_t a = abs(out[i]);
+        if (a > peak) {
+            peak = a;
+            peakPos = i;
+        }
+    }
+
+    const float msPerSample = 1000.0 / (float)Core::FS_ADC;
+    const float blockMs = (float)Core::BLOCK_SIZE_ADC * msPerSample;
+    const float dspMs = (float)(peakPos - impulsePos) * msPerSample;
+    const float minMs = dspMs + blockMs;
+    const float maxMs = dspMs + 2.0 * blockMs;
+
+    printf("%5u  %4s  %6.2f  %7.2f  %6.2f - %6.2f\n", BS, 
+        (hpfMode == Core::HPF_MODE_IIR) ? "IIR" : "FIR", 
+        blockMs, dspMs, minMs, maxMs);
+}
+
+int main(int, const char**) {
+    printf("Block  HPF  Period  DSP(ms)  Total(ms)\n");
+    measure<64>(AudioCoreT<64>::HPF_MODE_FIR);
+    measure<128>(AudioCoreT<128>::HPF_MODE_FIR);
+    measure<256>(AudioCoreT<256>::HPF_MODE_FIR);
+    measure<64>(AudioCoreT<64>::HPF_MODE_IIR);
+    measure<128>(AudioCoreT<128>::HPF_MODE_IIR);
+    measure<256>(AudioCoreT<256>::HPF_MODE_IIR);
+    return 0;
+}
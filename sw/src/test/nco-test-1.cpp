@@ -0,0 +1,113 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+
+// Unit test for the table-based oscillator. Checks the accuracy against
+// the math library, phase continuity across frequency changes, and 
+// that the fixed-point phase doesn't drift over a long run.
+//
+#include <iostream>
+#include <cassert>
+#include <cmath>
+
+#include "Nco.h"
+
+using namespace std;
+using namespace kc1fsz;
+
+int main(int, const char**) {
+
+    const float fs = 8000;
+    const double PI2 = 2.0 * 3.14159265358979323846;
+
+    // Accuracy over a range of frequencies
+    {
+        const float freqs[] = { 67.0, 123.0, 254.1, 1000.0, 1234.5, 3999.0 };
+        for (float hz : freqs) {
+            Nco nco(fs);
+            nco.setFreq(hz);
+            float out[1000];
+            nco.generate(out, 1000, 0.5);
+            double maxErr = 0;
+            for (unsigned i = 0; i < 1000; i++) {
+                double e = fabs(out[i] - 0.5 * cos(PI2 * hz * i / fs));
+                if (e > maxErr) 
+                    maxErr = e;
+            }
+            // Leaves room for the rounding of the phase increment
+            assert(maxErr < 5e-5);
+        }
+    }
+
+    // Generating in pieces gives the same result as one call and 
+    // accumulate() adds to what is there.
+    {
+        Nco a(fs), b(fs);
+        a.setFreq(440);
+        b.setFreq(440);
+        float x[96], y[96];
+        a.generate(x, 96, 1.0);
+        for (unsigned i = 0; i < 96; i++)
+            y[i] = 1.0;
+        b.accumulate(y, 32, 1.0);
+        b.accumulate(y + 32, 64, 1.0);
+        for (unsigned i = 0; i < 96; i++)
+            assert(fabs(y[i] - 1.0 - x[i]) < 1e-6);
+    }
+
+    // Frequency changes are phase continuous: the step between 
+    // adjacent samples never gets bigger than the higher frequency
+    // allows.
+    {
+        Nco nco(fs);
+        nco.setFreq(100);
+        float out[400];
+        nco.generate(out, 200, 1.0);
+        nco.setFreq(150);
+        nco.generate(out + 200, 200, 1.0);
+        const float maxStep = PI2 * 150.0 / fs;
+        for (unsigned i = 1; i < 400; i++)
+            assert(fabs(out[i] - out[i - 1]) <= maxStep + 1e-5);
+        // The first sample after the change follows on from the 
+        // phase reached at the old frequency.
+        const double phi = PI2 * 100.0 * 200 / fs;
+        assert(fabs(out[200] - cos(phi)) < 5e-5);
+    }
+
+    // A long run (one hour at 32k) doesn't drift
+    {
+        const float fs2 = 32000;
+        Nco nco(fs2);
+        // This frequency is an exact number of phase steps
+        nco.setFreq(fs2 / 64.0);
+        float out[256];
+        for (unsigned b = 0; b < 3600 * 125; b++)
+            nco.generate(out, 256, 1.0);
+        // Still exactly on the peak every 64 samples
+        assert(fabs(out[0] - 1.0) < 1e-6);
+        assert(fabs(out[64] - 1.0) < 1e-6);
+        assert(fabs(out[16]) < 1e-6);
+        nco.reset();
+        nco.generate(out, 1, 1.0);
+        assert(out[0] == 1.0);
+    }
+
+    cout << "OK" << endl;
+    return 0;
+}
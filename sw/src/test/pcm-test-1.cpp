@@ -0,0 +1,133 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+
+// Round trips through the PCM file reader/writers (WAV and raw) and 
+// checks the block iteration.
+//
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+
+#include "PcmFile.h"
+
+using namespace std;
+using namespace kc1fsz;
+
+static const char* WAV_FN = "/tmp/pcm-test-1.wav";
+static const char* RAW_FN = "/tmp/pcm-test-1.raw";
+
+int main(int, const char**) {
+
+    // 1000 samples doesn't divide evenly into blocks
+    const unsigned len = 1000;
+    vector<int32_t> ref(len);
+    for (unsigned i = 0; i < len; i++)
+        ref[i] = (int32_t)((i * 2654435761u) & 0xffff0000);
+    ref[1] = 0x7fff0000;
+    ref[2] = (int32_t)0x80000000;
+
+    // WAV, PCM16, written in odd-sized pieces
+    {
+        PcmWriter w;
+        const bool opened = w.open(WAV_FN, true, PcmReader::PCM16, 32000);
+        assert(opened);
+        w.write(ref.data(), 7);
+        w.write(ref.data() + 7, len - 7);
+        assert(w.getFrames() == len);
+        const bool closed = w.close();
+        assert(closed);
+    }
+    {
+        PcmReader r;
+        const bool opened = r.openWav(WAV_FN);
+        assert(opened);
+        assert(r.getFormat() == PcmReader::PCM16);
+        assert(r.getChannels() == 1);
+        assert(r.getRate() == 32000);
+        assert(r.getFrames() == len);
+
+        vector<int32_t> back(len);
+        r.readQ31(0, 0, back.data(), len);
+        assert(back == ref);
+
+        // Reads past the end are zero-filled
+        int32_t tail[8];
+        r.readQ31(len - 4, 0, tail, 8);
+        assert(memcmp(tail, ref.data() + len - 4, 4 * sizeof(int32_t)) == 0);
+        for (unsigned i = 4; i < 8; i++)
+            assert(tail[i] == 0);
+
+        // Blocks
+        const unsigned BS = 64;
+        PcmBlocksT<BS> blocks(r);
+        assert(blocks.size() == (len + BS - 1) / BS);
+        unsigned count = 0;
+        for (const int32_t* b : blocks) {
+            for (unsigned i = 0; i < BS; i++) {
+                const unsigned k = count * BS + i;
+                assert(b[i] == (k < len ? ref[k] : 0));
+            }
+            count++;
+        }
+        assert(count == blocks.size());
+    }
+
+    // Raw, PCM32, read back as stereo to check the channel selection
+    {
+        PcmWriter w;
+        const bool opened = w.open(RAW_FN, false, PcmReader::PCM32, 8000);
+        assert(opened);
+        w.write(ref.data(), len);
+        const bool closed = w.close();
+        assert(closed);
+    }
+    {
+        PcmReader r;
+        const bool opened = r.openRaw(RAW_FN, PcmReader::PCM32, 2, 8000);
+        assert(opened);
+        assert(r.getFrames() == len / 2);
+        vector<int32_t> left(len / 2), right(len / 2);
+        r.readQ31(0, 0, left.data(), len / 2);
+        r.readQ31(0, 1, right.data(), len / 2);
+        for (unsigned i = 0; i < len / 2; i++) {
+            assert(left[i] == ref[i * 2]);
+            assert(right[i] == ref[i * 2 + 1]);
+        }
+    }
+
+    // Errors
+    {
+        PcmReader r;
+        const bool openedMissing = r.openWav("/tmp/pcm-test-1-missing.wav");
+        assert(!openedMissing);
+        assert(!r.getError().empty());
+        const bool openedRaw = r.openWav(RAW_FN);
+        assert(!openedRaw);
+        assert(r.getFrames() == 0);
+    }
+
+    remove(WAV_FN);
+    remove(RAW_FN);
+
+    cout << "pcm-test-1 OK" << endl;
+    return 0;
+}
@@ -0,0 +1,102 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+
+// Runs the audio processing with AUDIO_PROFILE enabled and checks that
+// the per-stage statistics add up.
+//
+#include <iostream>
+#include <cstring>
+#include <cassert>
+
+#include "TestClock.h"
+#include "AudioCore.h"
+#include "AudioProfiler.h"
+
+using namespace std;
+using namespace kc1fsz;
+
+#ifndef AUDIO_PROFILE
+#error "Build with AUDIO_PROFILE defined"
+#endif
+
+static void bucketTest() {
+    assert(AudioProfiler::bucket(0) == 0);
+    assert(AudioProfiler::bucket(127) == 0);
+    assert(AudioProfiler::bucket(128) == 1);
+    assert(AudioProfiler::bucket(255) == 1);
+    assert(AudioProfiler::bucket(256) == 2);
+    assert(AudioProfiler::bucket(0xffffffff) == AudioProfiler::HIST_BUCKETS - 1);
+}
+
+static void coreTest() {
+
+    typedef AudioCoreT<256> Core;
+
+    TestClock clock;
+    Core core(0, clock);
+
+    int32_t in[Core::BLOCK_SIZE_ADC];
+    int32_t out[Core::BLOCK_SIZE_ADC];
+    float cross[Core::BLOCK_SIZE];
+    for (unsigned i = 0; i < Core::BLOCK_SIZE_ADC; i++)
+        in[i] = (i & 1) ? 0x01000000 : -0x01000000;
+
+    const unsigned blocks = AudioProfiler::PUBLISH_BLOCKS * 4;
+    for (unsigned b = 0; b < blocks; b++) {
+        core.cycleRx(in, cross);
+        core.cycleTx(cross, out);
+    }
+
+    AudioProfiler::Stats stats;
+    core.getProfiler().getStats(&stats);
+    assert(stats.blocks == blocks);
+
+    for (unsigned s = 0; s < AudioProfiler::STAGE_COUNT; s++) {
+        const AudioProfiler::StageStats& st = stats.stages[s];
+        assert(st.count == blocks);
+        assert(st.min <= st.max);
+        assert(st.total >= (uint64_t)st.min * st.count);
+        assert(st.total <= (uint64_t)st.max * st.count);
+        uint32_t histTotal = 0;
+        for (unsigned b = 0; b < AudioProfiler::HIST_BUCKETS; b++)
+            histTotal += st.hist[b];
+        assert(histTotal == st.count);
+    }
+
+    core.getProfiler().show();
+
+    // The reset is picked up by the audio side at the end of the next 
+    // block and published right away.
+    core.getProfiler().reset();
+    core.getProfiler().getStats(&stats);
+    assert(stats.blocks == blocks);
+    core.cycleRx(in, cross);
+    core.cycleTx(cross, out);
+    core.getProfiler().getStats(&stats);
+    assert(stats.blocks == 0);
+    for (unsigned s = 0; s < AudioProfiler::STAGE_COUNT; s++)
+        assert(stats.stages[s].count == 0);
+}
+
+int main(int, const char**) {
+    bucketTest();
+    coreTest();
+    return 0;
+}
@@ -0,0 +1,226 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+
+// Exercises the link receive parser the way the UART DMA drives it: a 
+// stream of encoded messages (with some corruption and line noise mixed 
+// in) is written into a 512 byte circular buffer in random-sized chunks
+// and processRxBuf() is called after each chunk. Checks that every good
+// message comes out intact and in order (including the ones that wrap
+// around the end of the buffer) and then reports the throughput.
+//
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <cassert>
+#include <chrono>
+
+#include "DigitalAudioPortRxHandler.h"
+
+using namespace std;
+using namespace kc1fsz;
+
+static const unsigned RX_BUF_SIZE = 512;
+
+static void makePayload(unsigned seq, uint8_t* payload) {
+    for (unsigned i = 0; i < PAYLOAD_SIZE; i++)
+        payload[i] = (seq * 7 + i * 13) & 0xff;
+    // Make sure there are some zeros for COBS to deal with
+    payload[seq % PAYLOAD_SIZE] = 0;
+    memcpy(payload, &seq, sizeof(seq));
+}
+
+int main(int, const char**) {
+
+    static uint8_t rxBuf[RX_BUF_SIZE];
+
+    // ----- Correctness ------------------------------------------------------
+
+    {
+        DigitalAudioPortRxHandler h(rxBuf, RX_BUF_SIZE);
+        srand(1);
+        unsigned wr = 0;
+        unsigned sent = 0, corrupted = 0, expectedSeq = 0;
+        unsigned received = 0;
+
+        auto cb = [&expectedSeq, &received](const uint8_t* msg, unsigned msgLen, 
+            uint8_t) {
+            assert(msgLen == PAYLOAD_SIZE);
+            unsigned seq;
+            memcpy(&seq, msg, sizeof(seq));
+            // Corrupted messages are skipped, but never re-ordered
+            assert(seq >= expectedSeq);
+            uint8_t expected[PAYLOAD_SIZE];
+            makePayload(seq, expected);
+            assert(memcmp(msg, expected, PAYLOAD_SIZE) == 0);
+            expectedSeq = seq + 1;
+            received++;
+        };
+
+        for (unsigned m = 0; m < 5000; m++) {
+            uint8_t payload[PAYLOAD_SIZE];
+            makePayload(m, payload);
+            uint8_t msg[NETWORK_MESSAGE_SIZE];
+            DigitalAudioPortRxHandler::encodeMsg(payload, PAYLOAD_SIZE, msg, 
+                NETWORK_MESSAGE_SIZE);
+            // The contiguous decoder should agree
+            uint8_t check[PAYLOAD_SIZE];
+            assert(DigitalAudioPortRxHandler::decodeMsg(msg, NETWORK_MESSAGE_SIZE, 
+                check, PAYLOAD_SIZE) == 0);
+            assert(memcmp(check, payload, PAYLOAD_SIZE) == 0);
+
+            // Sometimes damage a message, sometimes truncate it
+            unsigned len = NETWORK_MESSAGE_SIZE;
+            if (m % 17 == 3) {
+                msg[1 + rand() % (NETWORK_MESSAGE_SIZE - 1)] ^= 0x10;
+                // A flip can create a zero, which just looks like truncation
+                corrupted++;
+            } else if (m % 23 == 5) {
+                len = 1 + rand() % (NETWORK_MESSAGE_SIZE - 1);
+                corrupted++;
+            }
+            sent++;
+
+            // Occasional line noise between messages (no zeros)
+            uint8_t noise[8];
+            unsigned noiseLen = (m % 5 == 0) ? (1 + rand() % 8) : 0;
+            for (unsigned i = 0; i < noiseLen; i++)
+                noise[i] = 1 + rand() % 255;
+
+            // Feed it in the way the DMA would, in random chunks
+            unsigned pos = 0;
+            const unsigned total = len + noiseLen;
+            while (pos < total) {
+                unsigned chunk = 1 + rand() % 200;
+                if (chunk > total - pos)
+                    chunk = total - pos;
+                for (unsigned i = 0; i < chunk; i++, pos++) {
+                    rxBuf[wr] = (pos < len) ? msg[pos] : noise[pos - len];
+                    wr = (wr + 1) % RX_BUF_SIZE;
+                }
+                h.processRxBuf(wr, cb);
+            }
+        }
+
+        printf("Sent %u, damaged %u, received %u, bad %u\n", sent, corrupted,
+            received, h.getBadCount());
+        assert(received == h.getRxCount());
+        assert(received >= sent - corrupted);
+        assert(received + h.getBadCount() <= sent);
+    }
+
+    // ----- Catch up after a stall --------------------------------------------
+
+    {
+        // A bigger buffer so that several messages can pile up
+        static uint8_t bigBuf[4096];
+        DigitalAudioPortRxHandler h(bigBuf, sizeof(bigBuf));
+        unsigned wr = 0;
+        for (unsigned m = 0; m < 10; m++) {
+            uint8_t payload[PAYLOAD_SIZE];
+            makePayload(m, payload);
+            DigitalAudioPortRxHandler::encodeMsg(payload, PAYLOAD_SIZE, 
+                bigBuf + wr, NETWORK_MESSAGE_SIZE);
+            wr += NETWORK_MESSAGE_SIZE;
+        }
+        unsigned count = 0;
+        assert(h.processRxBuf(wr, [&count](const uint8_t*, unsigned, uint8_t) { count++; }) == 10);
+        assert(count == 10);
+    }
+
+    // ----- Overrun -----------------------------------------------------------
+
+    {
+        // The reader stalls in the middle of a message and the writer 
+        // goes all the way around the buffer. The damaged message 
+        // should be counted as an overrun, not as a bad message.
+        DigitalAudioPortRxHandler h(rxBuf, RX_BUF_SIZE);
+        uint8_t stream[NETWORK_MESSAGE_SIZE * 8];
+        for (unsigned m = 0; m < 8; m++) {
+            uint8_t payload[PAYLOAD_SIZE];
+            makePayload(m, payload);
+            DigitalAudioPortRxHandler::encodeMsg(payload, PAYLOAD_SIZE, 
+                stream + m * NETWORK_MESSAGE_SIZE, NETWORK_MESSAGE_SIZE);
+        }
+        unsigned pos = 0, count = 0;
+        auto cb = [&count](const uint8_t*, unsigned, uint8_t) { count++; };
+        auto feed = [&pos, &stream](unsigned len) {
+            for (unsigned i = 0; i < len; i++, pos++)
+                rxBuf[pos % RX_BUF_SIZE] = stream[pos];
+        };
+        // Half of the first message
+        feed(NETWORK_MESSAGE_SIZE / 2);
+        h.processRxBuf(pos % RX_BUF_SIZE, cb);
+        // Lap the reader
+        feed(RX_BUF_SIZE + 100);
+        h.processRxBuf(pos % RX_BUF_SIZE, cb, true);
+        // Back to normal
+        while (pos < sizeof(stream)) {
+            feed(50);
+            h.processRxBuf(pos % RX_BUF_SIZE, cb);
+        }
+        printf("Overrun: received %u, bad %u, overrun %u\n", count,
+            h.getBadCount(), h.getOverrunCount());
+        assert(h.getOverrunCount() == 1);
+        assert(h.getBadCount() == 0);
+        // Everything after the lap comes through
+        assert(count == 5);
+    }
+
+    // ----- Throughput --------------------------------------------------------
+
+    {
+        DigitalAudioPortRxHandler h(rxBuf, RX_BUF_SIZE);
+        // Pre-encode a message and lay it into the ring back-to-back, 
+        // one message per "tick", so that it lands at a different offset
+        // every time (wrap included).
+        uint8_t payload[PAYLOAD_SIZE];
+        makePayload(1, payload);
+        uint8_t msg[NETWORK_MESSAGE_SIZE];
+        DigitalAudioPortRxHandler::encodeMsg(payload, PAYLOAD_SIZE, msg, 
+            NETWORK_MESSAGE_SIZE);
+
+        const unsigned frames = 200000;
+        unsigned wr = 0;
+        unsigned received = 0;
+        uint32_t sum = 0;
+        double sec = 0;
+        for (unsigned m = 0; m < frames; m++) {
+            for (unsigned i = 0; i < NETWORK_MESSAGE_SIZE; i++) {
+                rxBuf[wr] = msg[i];
+                wr = (wr + 1) & (RX_BUF_SIZE - 1);
+            }
+            auto start = chrono::steady_clock::now();
+            received += h.processRxBuf(wr, [&sum](const uint8_t* m, unsigned, uint8_t) { 
+                sum += m[PAYLOAD_SIZE - 1]; });
+            sec += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        }
+        assert(received == frames);
+        assert(h.getBadCount() == 0);
+
+        const double fps = (double)frames / sec;
+        printf("Frames/sec       : %10.0f\n", fps);
+        printf("Bytes/sec        : %10.0f\n", fps * NETWORK_MESSAGE_SIZE);
+        printf("Link needs       : %10.0f frames/sec (%u bytes/sec)\n", 50.0,
+            50 * NETWORK_MESSAGE_SIZE);
+        printf("(checksum %u)\n", (unsigned)sum);
+    }
+
+    return 0;
+}
@@ -0,0 +1,416 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+
+// Scripted scenarios that run the whole controller in the simulator 
+// (see Simulator.h). Each scenario runs in its own process so several 
+// can go at once.
+//
+// Usage: sim-test-1 [-j jobs] [-v] [scenario ...]
+//
+//   -j n   Number of scenarios run in parallel (default: all cores)
+//   -v     Show the controller log
+//
+// With no names all of the scenarios are run.
+//
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <chrono>
+#include <thread>
+
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "Simulator.h"
+
+using namespace std;
+using namespace kc1fsz;
+
+// Both receivers on hardware COS (active high), no CTCSS, both 
+// transmitters enabled. Otherwise the factory (cross-band) setup: 
+// radio 0 is repeated on transmitter 1 and vice versa, and only 
+// transmitter 0 sends the ID.
+static void setupHardwareCos(Simulator& sim) {
+    Config& c = sim.getConfig();
+    c.rx0.cosMode = Rx::CosMode::COS_EXT_HIGH;
+    c.rx0.toneMode = Rx::ToneMode::TONE_IGNORE;
+    c.rx1.cosMode = Rx::CosMode::COS_EXT_HIGH;
+    c.rx1.toneMode = Rx::ToneMode::TONE_IGNORE;
+    c.tx0.enabled = true;
+    c.tx1.enabled = true;
+    sim.applyConfig();
+}
+
+static int txcState(Simulator& sim, unsigned r) {
+    return sim.getController().getTxControl(r).getState();
+}
+
+// A short transmission: the repeater keys up, sends the courtesy tone,
+// hangs, drops, and then sends the first ID once things are quiet.
+static void kerchunk(Simulator& sim) {
+
+    sim.getConfig().tx0.ctMode = CourtesyToneGenerator::Type::FAST_UPCHIRP;
+    setupHardwareCos(sim);
+    sim.run(1000);
+    assert(!sim.isPtt(0) && !sim.isPtt(1));
+
+    sim.setCarrier(1, true);
+    const bool keyed = sim.runUntil([&sim]() { return sim.isPtt(0); }, 200);
+    assert(keyed);
+    sim.run(300);
+    // Audio is passed through
+    assert(sim.getTxRms(0) > 0.05);
+    sim.setCarrier(1, false);
+    const uint32_t unkey = sim.getTime();
+
+    // Courtesy tone after the pause
+    const bool paused = sim.runUntil(
+        [&sim]() { return sim.getTxRms(0) < 0.001; }, 500);
+    assert(paused);
+    const bool toneOn = sim.runUntil(
+        [&sim]() { return sim.getTxRms(0) > 0.01; }, 3000);
+    assert(toneOn);
+    assert(sim.getTime() - unkey > 1500);
+    assert(sim.isPtt(0));
+
+    // Then the hang time
+    const bool dropped = sim.runUntil([&sim]() { return !sim.isPtt(0); }, 5000);
+    assert(dropped);
+    assert(sim.getTime() - unkey > 3000);
+
+    // The first ID comes once the repeater has been quiet for a bit
+    const bool idKeyed = sim.runUntil([&sim]() { return sim.isPtt(0); }, 10000);
+    assert(idKeyed);
+    const bool idStarted = sim.runUntil(
+        [&sim]() { return txcState(sim, 0) == TxControl::ID; }, 2000);
+    assert(idStarted);
+    const bool idDone = sim.runUntil([&sim]() { return !sim.isPtt(0); }, 30000);
+    assert(idDone);
+
+    assert(sim.getKeyCount(0) == 2);
+    // Cross-band, so the other transmitter never keys
+    assert(sim.getKeyCount(1) == 0);
+}
+
+// Soft CTCSS decode on radio 0 (the factory setup): the wrong tone is 
+// ignored and the right tone keys transmitter 1.
+static void softCtcss(Simulator& sim) {
+
+    Config& c = sim.getConfig();
+    c.tx1.enabled = true;
+    // The factory detect level (-60dBv) is left alone. A strong tone 
+    // on another frequency leaks through above that level but is 
+    // rejected by the decoder's confidence check.
+    sim.applyConfig();
+    sim.run(1000);
+
+    sim.setCtcss(0, 88.5);
+    sim.setCarrier(0, true);
+    const bool wrongKeyed = sim.runUntil(
+        [&sim]() { return sim.isPtt(1); }, 2000);
+    assert(!wrongKeyed);
+    sim.setCarrier(0, false);
+    sim.run(1000);
+
+    sim.setCtcss(0, 123.0);
+    sim.setCarrier(0, true);
+    // Key-up is mostly the receiver debounce, the tone decode itself
+    // locks in a few tens of milliseconds.
+    const bool keyed = sim.runUntil([&sim]() { return sim.isPtt(1); }, 120);
+    assert(keyed);
+    // Audio is passed through
+    sim.run(500);
+    assert(sim.getTxRms(1) > 0.05);
+    sim.setCarrier(0, false);
+    const bool dropped = sim.runUntil([&sim]() { return !sim.isPtt(1); }, 6000);
+    assert(dropped);
+}
+
+// A receiver that accepts a set of tones (via the tone scanner) in 
+// place of the single decode frequency.
+static void toneSet(Simulator& sim) {
+
+    Config& c = sim.getConfig();
+    c.tx1.enabled = true;
+    c.rx0.toneLevel = -36;
+    c.rx0.toneSet = ((uint64_t)1 << CtcssScanner::findTone(88.5)) | 
+        ((uint64_t)1 << CtcssScanner::findTone(100.0));
+    sim.applyConfig();
+    sim.run(1000);
+
+    // Neither a tone outside of the set nor the (replaced) decode 
+    // frequency will key
+    const float rejects[] = { 131.8, 123.0 };
+    for (float hz : rejects) {
+        sim.setCtcss(0, hz);
+        sim.setCarrier(0, true);
+        const bool keyed = sim.runUntil(
+            [&sim]() { return sim.isPtt(1); }, 2000);
+        assert(!keyed);
+        sim.setCarrier(0, false);
+        sim.run(1000);
+    }
+
+    // Both tones in the set are accepted. The scan window is ~384ms so
+    // this is slower than the single-tone decode.
+    const float accepts[] = { 100.0, 88.5 };
+    for (float hz : accepts) {
+        sim.setCtcss(0, hz);
+        sim.setCarrier(0, true);
+        const bool keyed = sim.runUntil(
+            [&sim]() { return sim.isPtt(1); }, 1500);
+        assert(keyed);
+        assert(sim.getController().getCore(0).getCtcssScanTone() == 
+            CtcssScanner::findTone(hz));
+        sim.setCarrier(0, false);
+        const bool dropped = sim.runUntil(
+            [&sim]() { return !sim.isPtt(1); }, 6000);
+        assert(dropped);
+        sim.run(1000);
+    }
+}
+
+// A stuck transmitter: the timeout drops the transmitter, the lockout 
+// is extended while the input stays active and the repeater comes back
+// (with an ID) once the input has gone away.
+static void timeout(Simulator& sim) {
+
+    sim.setAudioEnabled(false);
+    setupHardwareCos(sim);
+    sim.run(1000);
+
+    const uint32_t start = sim.getTime();
+    sim.setCarrier(1, true);
+    const bool keyed = sim.runUntil([&sim]() { return sim.isPtt(0); }, 200);
+    assert(keyed);
+
+    // 120s timeout
+    const bool droppedEarly = sim.runUntil(
+        [&sim]() { return !sim.isPtt(0); }, 118000);
+    assert(!droppedEarly);
+    const bool dropped = sim.runUntil([&sim]() { return !sim.isPtt(0); }, 4000);
+    assert(dropped);
+    assert(txcState(sim, 0) == TxControl::LOCKOUT);
+
+    // Still stuck at the end of the 60s lockout, which gets extended
+    const bool rekeyed = sim.runUntil([&sim]() { return sim.isPtt(0); }, 80000);
+    assert(!rekeyed);
+    sim.setCarrier(1, false);
+    assert(txcState(sim, 0) == TxControl::LOCKOUT);
+
+    // The extended lockout ends 240s in, followed by an ID
+    const bool idKeyed = sim.runUntil([&sim]() { return sim.isPtt(0); }, 45000);
+    assert(idKeyed);
+    assert(sim.getTime() - start >= 240000);
+    assert(txcState(sim, 0) == TxControl::PRE_ID);
+    const bool idDone = sim.runUntil([&sim]() { return !sim.isPtt(0); }, 30000);
+    assert(idDone);
+}
+
+// Four hours of a 10s transmission every 2 minutes, then an hour of 
+// silence. The ID has to go out at least every 10 minutes while the 
+// repeater is in use, never more often, never during a transmission, 
+// and not at all when nobody is using the repeater.
+static void idTiming(Simulator& sim) {
+
+    sim.setAudioEnabled(false);
+    setupHardwareCos(sim);
+
+    vector<uint32_t> ids;
+    int lastState = txcState(sim, 0);
+    bool carrier = false;
+    auto watch = [&]() {
+        const int state = txcState(sim, 0);
+        if (state == TxControl::ID && lastState != TxControl::ID) {
+            assert(!carrier);
+            ids.push_back(sim.getTime());
+        }
+        lastState = state;
+        return false;
+    };
+
+    const uint32_t hour = 60 * 60 * 1000;
+    while (sim.getTime() < 4 * hour) {
+        carrier = true;
+        sim.setCarrier(1, true);
+        sim.runUntil(watch, 10 * 1000);
+        carrier = false;
+        sim.setCarrier(1, false);
+        sim.runUntil(watch, 110 * 1000);
+    }
+    const size_t busyIds = ids.size();
+    sim.runUntil(watch, hour);
+
+    assert(busyIds >= 20 && busyIds <= 24);
+    for (size_t i = 1; i < busyIds; i++) {
+        const uint32_t gap = ids[i] - ids[i - 1];
+        assert(gap >= 600 * 1000 && gap <= 740 * 1000);
+    }
+    // Only the ID that covers the last transmissions
+    assert(ids.size() - busyIds <= 1);
+}
+
+// DTMF commands: unlock and disable the transmitters, make sure that
+// they stay off and that the setting made it to flash, then re-enable.
+static void dtmfDisable(Simulator& sim) {
+
+    setupHardwareCos(sim);
+    sim.run(1000);
+    const unsigned erases = sim.getFlash().getEraseCount();
+
+    sim.sendDtmf(1, "*780");
+    assert(!sim.getConfig().tx0.enabled2);
+    assert(!sim.getConfig().tx1.enabled2);
+    assert(!sim.isPtt(0));
+    const bool disableSaved = sim.runUntil(
+        []() { return !Config::isSavePending(); }, 1000);
+    assert(disableSaved);
+    assert(sim.getFlash().getEraseCount() == erases + 1);
+    {
+        Config saved;
+        Config::loadConfig(&saved);
+        assert(saved.isValid());
+        assert(!saved.tx0.enabled2 && !saved.tx1.enabled2);
+    }
+
+    // Let the command access time out, then try to use the repeater
+    sim.run(35000);
+    sim.setCarrier(1, true);
+    const bool keyedDisabled = sim.runUntil(
+        [&sim]() { return sim.isPtt(0); }, 2000);
+    assert(!keyedDisabled);
+    sim.setCarrier(1, false);
+    sim.run(1000);
+
+    sim.sendDtmf(1, "*781");
+    assert(sim.getConfig().tx0.enabled2);
+    const bool enableSaved = sim.runUntil(
+        []() { return !Config::isSavePending(); }, 1000);
+    assert(enableSaved);
+    {
+        Config saved;
+        Config::loadConfig(&saved);
+        assert(saved.tx0.enabled2 && saved.tx1.enabled2);
+    }
+    sim.run(35000);
+    sim.setCarrier(1, true);
+    const bool keyed = sim.runUntil([&sim]() { return sim.isPtt(0); }, 500);
+    assert(keyed);
+}
+
+struct Scenario {
+    const char* name;
+    void (*fn)(Simulator&);
+};
+
+static const Scenario scenarios[] = {
+    { "kerchunk", kerchunk },
+    { "soft-ctcss", softCtcss },
+    { "tone-set", toneSet },
+    { "timeout", timeout },
+    { "id-timing", idTiming },
+    { "dtmf-disable", dtmfDisable },
+};
+
+/**
+ * Runs in the child process. A failed assert shows up as a crash.
+ */
+static void runScenario(const Scenario& s, bool verbose) {
+    // Don't lose the log if an assert fails
+    setvbuf(stdout, 0, _IOLBF, 0);
+    const auto start = chrono::steady_clock::now();
+    // Big, so on the heap
+    auto sim = make_unique<Simulator>();
+    sim->getLog().setEnabled(verbose);
+    s.fn(*sim);
+    const double wallSec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    printf("%-14s PASS  %9.1f s simulated in %6.3f s\n", s.name, 
+        (double)sim->getTime() / 1000.0, wallSec);
+    fflush(stdout);
+}
+
+int main(int argc, const char** argv) {
+
+    unsigned jobs = thread::hardware_concurrency();
+    bool verbose = false;
+    vector<const Scenario*> todo;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+            jobs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-v") == 0)
+            verbose = true;
+        else {
+            const Scenario* found = 0;
+            for (const Scenario& s : scenarios)
+                if (strcmp(s.name, argv[i]) == 0)
+                    found = &s;
+            if (!found) {
+                cerr << "Unknown scenario " << argv[i] << endl;
+                return 2;
+            }
+            todo.push_back(found);
+        }
+    }
+    if (todo.empty())
+        for (const Scenario& s : scenarios)
+            todo.push_back(&s);
+    if (jobs == 0)
+        jobs = 1;
+
+    // Fork a process per scenario, keeping up to jobs running
+    vector<pair<pid_t, const Scenario*>> running;
+    unsigned failures = 0;
+    size_t next = 0;
+
+    while (next < todo.size() || !running.empty()) {
+        while (next < todo.size() && running.size() < jobs) {
+            fflush(stdout);
+            pid_t pid = fork();
+            if (pid < 0) {
+                perror("fork");
+                return 2;
+            }
+            if (pid == 0) {
+                runScenario(*todo[next], verbose);
+                _exit(0);
+            }
+            running.push_back({ pid, todo[next] });
+            next++;
+        }
+        int status;
+        pid_t pid = wait(&status);
+        for (auto it = running.begin(); it != running.end(); ++it) {
+            if (it->first == pid) {
+                if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                    printf("%-14s FAIL\n", it->second->name);
+                    failures++;
+                }
+                running.erase(it);
+                break;
+            }
+        }
+    }
+
+    printf("%zu scenario(s), %u failed\n", todo.size(), failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,151 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+
+// Unit test for the Snapshot that passes settings from the main loop 
+// to the audio processing (and meter readings back). The last part 
+// runs a writer and reader on separate threads to check that a torn 
+// copy is never accepted.
+//
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <atomic>
+
+#include "Snapshot.h"
+
+using namespace std;
+using namespace kc1fsz;
+
+struct Settings {
+    unsigned version = 0;
+    float values[31] = { };
+};
+
+// Has padding after each bool
+struct Padded {
+    bool a = false;
+    float b = 0;
+    bool c = false;
+};
+
+int main(int, const char**) {
+
+    // Basic
+    {
+        Snapshot<Settings> s;
+        Settings v;
+        uint32_t seq = 99;
+        // The defaults can be read before anything is published
+        assert(s.read(v, &seq));
+        assert(seq == 0);
+        assert(v.version == 0);
+
+        v.version = 1;
+        v.values[3] = 3;
+        s.publish(v);
+        assert(s.getSeq() == 1);
+        Settings w;
+        assert(s.read(w, &seq));
+        assert(seq == 1);
+        assert(w.version == 1 && w.values[3] == 3);
+
+        // Publishing the same thing again is skipped
+        s.publish(v);
+        assert(s.getSeq() == 1);
+
+        // Many versions, the reader always gets the latest
+        for (unsigned i = 2; i < 100; i++) {
+            v.version = i;
+            s.publish(v);
+            if (i % 7 == 0) {
+                assert(s.read(w, &seq));
+                assert(w.version == i);
+                assert(seq == s.getSeq());
+            }
+        }
+    }
+
+    // The comparison includes the padding, which is zero in a 
+    // value-initialized struct
+    {
+        Snapshot<Padded> s;
+        Padded v = Padded();
+        v.b = 1;
+        s.publish(v);
+        assert(s.getSeq() == 1);
+        v.a = true;
+        s.publish(v);
+        assert(s.getSeq() == 2);
+        s.publish(v);
+        v.b = 1;
+        s.publish(v);
+        assert(s.getSeq() == 2);
+        Padded w;
+        assert(s.read(w));
+        assert(w.a && w.b == 1 && !w.c);
+    }
+
+    // Threaded
+    {
+        const unsigned COUNT = 200000;
+        static Snapshot<Settings> s;
+        static atomic<bool> done = false;
+        thread writer([]() {
+            Settings v;
+            for (unsigned i = 1; i <= COUNT; i++) {
+                v.version = i;
+                for (unsigned k = 0; k < 31; k++)
+                    v.values[k] = (float)(i + k);
+                s.publish(v);
+                if (i % 16 == 0)
+                    this_thread::yield();
+            }
+            done = true;
+        });
+        unsigned reads = 0, torn = 0, last = 0;
+        while (!done || last < COUNT) {
+            Settings v;
+            uint32_t seq;
+            if (!s.read(v, &seq)) {
+                torn++;
+                continue;
+            }
+            reads++;
+            // Nothing published yet
+            if (seq == 0)
+                continue;
+            // Every field must come from the same version and versions
+            // never go backwards.
+            assert(v.version == seq);
+            for (unsigned k = 0; k < 31; k++)
+                assert(v.values[k] == (float)(v.version + k));
+            assert(v.version >= last);
+            last = v.version;
+            if (reads % 16 == 0)
+                this_thread::yield();
+        }
+        writer.join();
+        assert(last == COUNT);
+        cout << "Reads " << reads << ", torn (retried) " << torn << endl;
+    }
+
+    cout << "All tests passed" << endl;
+    return 0;
+}
@@ -0,0 +1,110 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+
+// Unit test for the SPSC ring that connects the link interrupt to the 
+// audio interrupt. The last part runs a producer and consumer on
+// separate threads to check that nothing is lost or re-ordered.
+//
+#include <iostream>
+#include <cassert>
+#include <thread>
+
+#include "SpscRing.h"
+
+using namespace std;
+using namespace kc1fsz;
+
+struct Frame {
+    unsigned seq;
+    uint8_t data[64];
+};
+
+int main(int, const char**) {
+
+    // Basic full/empty
+    {
+        SpscRing<unsigned, 4> r;
+        assert(r.empty());
+        assert(r.front() == 0);
+        unsigned v;
+        assert(!r.pop(v));
+        assert(r.push(1));
+        assert(r.push(2));
+        assert(r.push(3));
+        // One slot is always left open
+        assert(!r.push(4));
+        assert(r.size() == 3);
+        assert(*r.front() == 1);
+        r.pop();
+        assert(r.pop(v) && v == 2);
+        assert(r.push(5));
+        assert(r.pop(v) && v == 3);
+        assert(r.pop(v) && v == 5);
+        assert(r.empty());
+    }
+
+    // Wrap many times
+    {
+        SpscRing<unsigned, 8> r;
+        unsigned next = 0;
+        for (unsigned i = 0; i < 1000; i++) {
+            assert(r.push(i));
+            if (i % 3 == 2) {
+                unsigned v;
+                while (r.pop(v)) 
+                    assert(v == next++);
+            }
+        }
+    }
+
+    // Threaded
+    {
+        const unsigned COUNT = 100000;
+        static SpscRing<Frame, 4> r;
+        thread producer([]() {
+            Frame f;
+            for (unsigned i = 0; i < COUNT; i++) {
+                f.seq = i;
+                for (unsigned k = 0; k < sizeof(f.data); k++)
+                    f.data[k] = (i + k) & 0xff;
+                while (!r.push(f))
+                    this_thread::yield();
+            }
+        });
+        unsigned next = 0;
+        while (next < COUNT) {
+            const Frame* f = r.front();
+            if (!f) {
+                this_thread::yield();
+                continue;
+            }
+            assert(f->seq == next);
+            for (unsigned k = 0; k < sizeof(f->data); k++)
+                assert(f->data[k] == ((next + k) & 0xff));
+            r.pop();
+            next++;
+        }
+        producer.join();
+        assert(r.empty());
+    }
+
+    cout << "All tests passed" << endl;
+    return 0;
+}
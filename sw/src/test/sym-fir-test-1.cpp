@@ -0,0 +1,144 @@
+/**
+ * Software Defined Repeater Controller
+ * Copyright (C) 2025, Bruce MacKinnon KC1FSZ
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * NOT FOR COMMERCIAL USE WITHOUT PERMISSION.
+ */
+
+// Checks the folded (symmetric) FIR kernels against the CMSIS-DSP 
+// versions they replace, across several blocks so that the history 
+// handling is covered too. The results aren't bit-exact (the additions
+// are in a different order) so there is a small tolerance. Also prints
+// the host timing for each.
+//
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <cassert>
+#include <chrono>
+
+#include <arm_math.h>
+
+#include "SymmetricFir.h"
+
+using namespace std;
+using namespace kc1fsz;
+
+static float rnd() {
+    return (float)rand() / (float)RAND_MAX - 0.5f;
+}
+
+static void makeSymmetric(float* h, unsigned n) {
+    for (unsigned i = 0; i < (n + 1) / 2; i++) {
+        h[i] = rnd() * 0.1f;
+        h[n - 1 - i] = h[i];
+    }
+}
+
+static const unsigned BLOCKS = 2000;
+static const unsigned MAX_TAPS = 128;
+static const unsigned MAX_BLOCK_SIZE = 64;
+static const unsigned MAX_L = 4;
+
+static void testFir(unsigned numTaps, unsigned blockSize) {
+
+    float h[MAX_TAPS];
+    makeSymmetric(h, numTaps);
+    float state0[MAX_TAPS + MAX_BLOCK_SIZE - 1];
+    float state1[MAX_TAPS + MAX_BLOCK_SIZE - 1];
+    arm_fir_instance_f32 f0;
+    fir_sym_instance_f32 f1;
+    arm_fir_init_f32(&f0, numTaps, h, state0, blockSize);
+    fir_sym_init_f32(&f1, numTaps, h, state1, blockSize);
+
+    float in[MAX_BLOCK_SIZE], out0[MAX_BLOCK_SIZE], out1[MAX_BLOCK_SIZE];
+    float maxErr = 0;
+    chrono::nanoseconds t0(0), t1(0);
+
+    for (unsigned b = 0; b < BLOCKS; b++) {
+        for (unsigned i = 0; i < blockSize; i++)
+            in[i] = rnd();
+        auto a = chrono::steady_clock::now();
+        arm_fir_f32(&f0, in, out0, blockSize);
+        auto m = chrono::steady_clock::now();
+        fir_sym_f32(&f1, in, out1, blockSize);
+        auto e = chrono::steady_clock::now();
+        t0 += m - a;
+        t1 += e - m;
+        for (unsigned i = 0; i < blockSize; i++)
+            maxErr = max(maxErr, fabs(out0[i] - out1[i]));
+    }
+
+    printf("FIR         taps %3u block %3u  err %.2e  ns/block %6lld -> %6lld\n", 
+        numTaps, blockSize, maxErr, (long long)t0.count() / BLOCKS, 
+        (long long)t1.count() / BLOCKS);
+    assert(maxErr < 1e-5);
+}
+
+static void testInterpolate(unsigned numTaps, unsigned L, unsigned blockSize) {
+
+    float h[MAX_TAPS];
+    makeSymmetric(h, numTaps);
+    float state0[MAX_TAPS + MAX_BLOCK_SIZE - 1];
+    float state1[MAX_TAPS + MAX_BLOCK_SIZE - 1];
+    float folded[fir_sym_interpolate_folded_size(MAX_TAPS)];
+    arm_fir_interpolate_instance_f32 f0;
+    fir_sym_interpolate_instance_f32 f1;
+    arm_fir_interpolate_init_f32(&f0, L, numTaps, h, state0, blockSize);
+    fir_sym_interpolate_init_f32(&f1, L, numTaps, h, folded, state1, blockSize);
+
+    float in[MAX_BLOCK_SIZE], out0[MAX_BLOCK_SIZE * MAX_L], out1[MAX_BLOCK_SIZE * MAX_L];
+    float maxErr = 0;
+    chrono::nanoseconds t0(0), t1(0);
+
+    for (unsigned b = 0; b < BLOCKS; b++) {
+        for (unsigned i = 0; i < blockSize; i++)
+            in[i] = rnd();
+        auto a = chrono::steady_clock::now();
+        arm_fir_interpolate_f32(&f0, in, out0, blockSize);
+        auto m = chrono::steady_clock::now();
+        fir_sym_interpolate_f32(&f1, in, out1, blockSize);
+        auto e = chrono::steady_clock::now();
+        t0 += m - a;
+        t1 += e - m;
+        for (unsigned i = 0; i < blockSize * L; i++)
+            maxErr = max(maxErr, fabs(out0[i] - out1[i]));
+    }
+
+    printf("Interpolate taps %3u block %3u  err %.2e  ns/block %6lld -> %6lld\n", 
+        numTaps, blockSize, maxErr, (long long)t0.count() / BLOCKS, 
+        (long long)t1.count() / BLOCKS);
+    assert(maxErr < 1e-5);
+}
+
+int main(int, const char**) {
+
+    // The sizes used by AudioCore (FILTER_F and FILTER_N) at each of 
+    // the block sizes, plus odd/even lengths and block sizes that 
+    // don't fill the lanes.
+    const unsigned blockSizes[] = { 16, 32, 64, 7 };
+    for (unsigned bs : blockSizes) {
+        testFir(127, bs);
+        testFir(41, bs);
+        testFir(40, bs);
+        testInterpolate(124, 4, bs);
+        testInterpolate(128, 4, bs);
+        testInterpolate(24, 2, bs);
+        testInterpolate(26, 2, bs);
+    }
+
+    return 0;
+}
@@ -24,6 +24,7 @@ When targeting RP2350 (Pico 2), command used to load code onto the board:
 #include "util/dsp_util.h"
 
 #include "AudioCore.h"
+#include "MixBus.h"
 
 #define LED_PIN (PICO_DEFAULT_LED_PIN)
 
@@ -66,8 +67,9 @@ int main(int, const char**) {
     core0.setCtcssEncodeEnabled(false);
     //core0.setDelayMs(100);
     core0.setRxGainLinear(1.0);
-    core0.setCrossGainLinear(0, 1.0);
-    core0.setCrossGainLinear(1, 0.0);
+    MixBus mixBus(2);
+    mixBus.setSourceGainLinear(0, 1.0);
+    mixBus.setSourceGainLinear(1, 0.0);
     core0.setRxGainLinear(1.0);
 
     AudioCore core1(1, 2);
@@ -121,8 +123,12 @@ int main(int, const char**) {
 
         core0.cycleRx(adc_in_0, cross_out_0);
         core1.cycleRx(adc_in_1, cross_out_1);
-        core0.cycleTx(cross_ins, dac_out_0);
-        core1.cycleTx(cross_ins, dac_out_1);
+        mixBus.cycle(cross_ins);
+        float mix[AudioCore::BLOCK_SIZE];
+        mixBus.getMix(0, mix);
+        core0.cycleTx(mix, dac_out_0);
+        mixBus.getMix(1, mix);
+        core1.cycleTx(mix, dac_out_1);
 
         adc_in_0 += AudioCore::BLOCK_SIZE_ADC;
         adc_in_1 += AudioCore::BLOCK_SIZE_ADC;
@@ -1,13 +1,16 @@
 #include <iostream>
-#include <fstream>
+#include <algorithm>
 #include <random>
 #include <string>
+#include <vector>
 
 // Radlib
 #include "util/dsp_util.h"
 
 #include "TestClock.h"
 #include "AudioCore.h"
+#include "MixBus.h"
+#include "PcmFile.h"
 
 using namespace std;
 using namespace kc1fsz;
@@ -36,24 +39,27 @@ void generateWhiteNoiseQ31(q31_t* out, unsigned numSamples, double amplitude) {
 }
 
 /**
- * @brief The file is assumed to be in 16-bit PCM format, so a conversion
- * to 32-bit PCM (q31_t) is needed as well.
+ * @brief Loads a WAV file (first channel), or a raw 32k PCM16 file if 
+ * the name doesn't end in .wav, converted to q31.
  */
 unsigned loadFromFile(const char* fn, int32_t* target, unsigned target_max) {
-    ifstream is(fn);
-    unsigned i = 0;
-    float scale = 32767.0;
-    std::string line;
-    while (getline(is, line))
-        if (i < target_max)
-            target[i++] = (stof(line) / scale) * 2147483648.0;
-    return i;
+    PcmReader r;
+    const std::string name(fn);
+    const bool wav = name.size() > 4 && name.substr(name.size() - 4) == ".wav";
+    if (!(wav ? r.openWav(fn) : r.openRaw(fn, PcmReader::PCM16, 1, AudioCore::FS_ADC))) {
+        cerr << fn << ": " << r.getError() << endl;
+        return 0;
+    }
+    const unsigned n = std::min((size_t)target_max, r.getFrames());
+    r.readQ31(0, 0, target, n);
+    return n;
 }
 
 int main(int argc, const char** argv) {
 
     TestClock clock;
-    AudioCore core0(0, 2, clock), core1(1, 2, clock);
+    AudioCore core0(0, clock), core1(1, clock);
+    MixBus mixBus(2);
 
     core0.setCtcssDecodeFreq(123);
     core0.setCtcssEncodeFreq(123);
@@ -63,14 +69,12 @@ int main(int argc, const char** argv) {
     core0.setToneEnabled(false);
     core0.setToneFreq(1000);
     core0.setToneLevel(-10);
-    core0.setCrossGainLinear(0, 1.0);
-    core0.setCrossGainLinear(1, 0.0);
+    mixBus.setSourceGainLinear(0, 1.0);
+    mixBus.setSourceGainLinear(1, 0.0);
     core0.setAgcEnabled(true);
     core0.setAgcTargetDbv(-10);
 
     core1.setCtcssDecodeFreq(88.5);
-    core1.setCrossGainLinear(0, 0.5);
-    core1.setCrossGainLinear(1, 0.5);
 
     float  plDecodeLevel = -50;
 
@@ -79,7 +83,8 @@ int main(int argc, const char** argv) {
     //core0.setDiagToneLevel(-3);
     //core0.setDiagToneEnabled(true);
 
-    ofstream os("/tmp/clip-3b.txt");
+    PcmWriter os;
+    os.open("/tmp/clip-3b.wav", true, PcmReader::PCM16, AudioCore::FS_ADC);
     //bool noiseSquelchEnabled = true;
     bool noiseSquelchEnabled = false;
     enum SquelchState { OPEN, CLOSED, TAIL }
@@ -97,19 +102,16 @@ int main(int argc, const char** argv) {
 
         const unsigned test_in_max = AudioCore::FS_ADC * 7;
         const unsigned test_blocks = test_in_max / AudioCore::BLOCK_SIZE_ADC;
-        int32_t test_in_0[test_in_max];
-        int32_t test_in_1[test_in_max];
-        for (unsigned i = 0; i < test_in_max; i++) {
-            test_in_0[i] = 0;
-            test_in_1[i] = 0;
-        }
+        // These are too big for the stack
+        vector<int32_t> test_in_0(test_in_max, 0);
+        vector<int32_t> test_in_1(test_in_max, 0);
 
         // Fill in the test audio
         float ft = 1000;
         //float ft = sweepTone;
-        //generateWhiteNoiseQ31(test_in_0, test_in_max, 1.0);
-        //make_real_tone_q31(test_in_0, test_in_max, AudioCore::FS_ADC, ft, 0.98); 
-        //loadFromFile("../tests/clip-3.txt", test_in_0, test_in_max);
+        //generateWhiteNoiseQ31(test_in_0.data(), test_in_max, 1.0);
+        //make_real_tone_q31(test_in_0.data(), test_in_max, AudioCore::FS_ADC, ft, 0.98); 
+        //loadFromFile("../tests/clip-3.wav", test_in_0.data(), test_in_max);
 
         // Modulate amplitude
         {
@@ -150,8 +152,8 @@ int main(int argc, const char** argv) {
             }
         }
 
-        int32_t* adc_in_0 = test_in_0;
-        int32_t* adc_in_1 = test_in_1;
+        int32_t* adc_in_0 = test_in_0.data();
+        int32_t* adc_in_1 = test_in_1.data();
 
         float cross_out_0[AudioCore::BLOCK_SIZE];
         float cross_out_1[AudioCore::BLOCK_SIZE];
@@ -166,21 +168,22 @@ int main(int argc, const char** argv) {
 
             core0.cycleRx(adc_in_0, cross_out_0);
             //core1.cycleRx(adc_in_1, cross_out_1);
-            core0.cycleTx(cross_ins, dac_out_0);
-            //core1.cycleTx(cross_ins, dac_out_1);
+            mixBus.cycle(cross_ins);
+            float mix[AudioCore::BLOCK_SIZE];
+            mixBus.getMix(0, mix);
+            core0.cycleTx(mix, dac_out_0);
+            //mixBus.getMix(1, mix);
+            //core1.cycleTx(mix, dac_out_1);
 
             adc_in_0 += AudioCore::BLOCK_SIZE_ADC;
             adc_in_1 += AudioCore::BLOCK_SIZE_ADC;
 
             // Write out a block of audio at 32K
-            for (unsigned i = 0; i < AudioCore::BLOCK_SIZE_ADC; i++) {
-                if (!noiseSquelchEnabled ||
-                    squelchState != SquelchState::CLOSED) {
-                    os << (dac_out_0[i] >> 16) << endl; 
-                } else {
-                    os << 0 << endl;
-                }
+            if (noiseSquelchEnabled && squelchState == SquelchState::CLOSED) {
+                for (unsigned i = 0; i < AudioCore::BLOCK_SIZE_ADC; i++)
+                    dac_out_0[i] = 0;
             }
+            os.write(dac_out_0, AudioCore::BLOCK_SIZE_ADC);
                         
             float n_0 = AudioCore::vrmsToDbv(core0.getNoiseRms());
             float s_0 = AudioCore::vrmsToDbv(core0.getSignalRms());
@@ -198,9 +201,9 @@ int main(int argc, const char** argv) {
             else
                 state = 'O';
 
-            cout << block << " " << snr << " " << state << " " << pl_0 << " " << o_0 << endl;
-            //cout << block << " " << s_0 << " " << n_0 << " " << pl_0 << endl;
-            cout << AudioCore::db(core0.getAgcGain()) << endl;
+            cout << block << " " << snr << " " << state << " " << pl_0 << " " << o_0 << "\n";
+            //cout << block << " " << s_0 << " " << n_0 << " " << pl_0 << "\n";
+            cout << AudioCore::db(core0.getAgcGain()) << "\n";
 
             if (squelchState == SquelchState::CLOSED) {
                 // Look for unsquelch
@@ -33,7 +33,7 @@
 
 #include "kc1fsz-tools/Common.h"
 
-#include "DigitalAudioPortRxHandler.h"
+#include "LinkSession.h"
 #include "uart_setup.h"
 
 using namespace std;
@@ -47,6 +47,10 @@ namespace kc1fsz {
 // This is one more bit since the counter gets to 1000..00
 #define UART_RX_BUF_MASK_COUNT (0b1111111111)
 #define UART_RX_BUF_MASK (0b111111111)
+// How long it takes the DMA to go all the way around the receive buffer
+// (10 bits per byte on the wire). The link processing has to run at least 
+// this often or partially received messages will be overwritten.
+#define UART_RX_BUF_US ((UART_RX_BUF_SIZE * 10 * 1000000ULL) / NETWORK_BAUD)
 
 #define UART_TX_BUF_SIZE 512
 #define UART_TX_BUF_BITS (9)
@@ -63,7 +67,6 @@ static uint dma_ch_rx = 0;
 // This buffer is used with the DMA ring feature so it needs to be power-of-two
 // aligned.
 static uint8_t __attribute__((aligned(UART_RX_BUF_SIZE))) rx_buf[UART_RX_BUF_SIZE];
-static DigitalAudioPortRxHandler rxBufHandler(rx_buf, UART_RX_BUF_SIZE);
 
 // Transmit Related:
 
@@ -77,9 +80,22 @@ static unsigned TxBufLen = 0;
 static bool TxDmaInProcess = false;
 static unsigned TxDmaLength = 0;
 
-static unsigned TxBufOverflow = 0;
 static unsigned OverlapSendDiscardedCount = 0;
 
+// Link Processing Related:
+//
+// All of the framing work (COBS, CRC, UART DMA management) happens in a 
+// user interrupt that runs at the lowest priority, so it can be pre-empted
+// by the audio DMA interrupt. The audio interrupt only moves ready-to-use 
+// PCM frames in/out of the session.
+
+static LinkSession session(rx_buf, UART_RX_BUF_SIZE);
+static unsigned link_irq = 0;
+// When the receive buffer was last processed
+static uint32_t link_last_rx_us = 0;
+
+static void link_irq_handler();
+
 /*
 // THIS IS THE SETUP FOR DIGITAL-2 (2025-05 B) 
 // -------------------------------------------
@@ -157,6 +173,13 @@ void streaming_uart_setup() {
         // Not started yet
         false);
 
+    // The link processing interrupt. This has to be below the priority
+    // of the audio DMA interrupt.
+    link_irq = user_irq_claim_unused(true);
+    irq_set_exclusive_handler(link_irq, link_irq_handler);
+    irq_set_priority(link_irq, PICO_LOWEST_IRQ_PRIORITY);
+    irq_set_enabled(link_irq, true);
+
     // Start the ball rolling on the RX side
     dma_channel_start(dma_ch_rx);
     enabled = true;
@@ -215,10 +238,12 @@ static void startTxDMAIfPossible() {
     TxDmaLength = TxBufLen;
 }
 
-void networkAudioReceiveIfAvailable(receive_processor cb) {
-
-    if (!enabled) 
-        return;
+// ****************************************************************************
+// NOTE: This function is called from the link interrupt, which runs at the 
+// lowest priority and can be pre-empted by the audio interrupt. 
+// ****************************************************************************
+//
+static void link_irq_handler() {
 
     // Force cache consistency. 
     // 
@@ -244,31 +269,53 @@ void networkAudioReceiveIfAvailable(receive_processor cb) {
     if (dmaWritePtr == UART_RX_BUF_SIZE)
         dmaWritePtr = 0;
 
-    // Process the received bytes if possible.
-    rxBufHandler.processRxBuf(
-        dmaWritePtr,
-        // This callback is fired for each **complete** message pulled from the circular
-        // buffer. The header byte/CRC are NOT included.
-        [cb](const uint8_t* decodedBuf, unsigned decodedLen) {
-            cb(decodedBuf, decodedLen);
-        }
-    );
+    // Process all of the complete messages received so far. If we were
+    // held off for longer than it takes to fill the buffer then anything 
+    // that fails to decode is counted as an overrun.
+    const uint32_t now = time_us_32();
+    const bool stalled = (now - link_last_rx_us) > UART_RX_BUF_US;
+    link_last_rx_us = now;
+    session.processRx(dmaWritePtr, stalled);
+
+    // Encode and queue anything that the audio side wants to send
+    session.processTx(queueForTx);
+
     // Check if there is anything waiting to go out
     startTxDMAIfPossible();
 }
 
-void networkAudioSend(const uint8_t* frame, unsigned len) { 
-    if (enabled) {
-        assert(len == PAYLOAD_SIZE);
+// ****************************************************************************
+// NOTE: This function is called from inside of the audio frame ISR so keep it 
+// short!
+// ****************************************************************************
+void networkAudioReceiveIfAvailable(receive_processor cb) {
+
+    if (!enabled) 
+        return;
 
-        // Encode the message in COBS format
-        uint8_t txFrame[NETWORK_MESSAGE_SIZE];
-        DigitalAudioPortRxHandler::encodeMsg(frame, PAYLOAD_SIZE,
-            txFrame, NETWORK_MESSAGE_SIZE);
+    // Hand over everything that has arrived, the jitter buffer sorts 
+    // out the timing.
+    session.receive(cb);
 
-        // Ship out
-        queueForTx(txFrame, NETWORK_MESSAGE_SIZE);
-        startTxDMAIfPossible();
+    // Schedule the link processing. This runs as soon as the audio
+    // interrupt (and anything else above the lowest priority) is 
+    // finished.
+    irq_set_pending(link_irq);
+}
+
+void networkAudioSetCodec(unsigned codec) {
+    session.setCodec(codec);
+}
+
+// ****************************************************************************
+// NOTE: This function is called from inside of the audio frame ISR so keep it 
+// short!
+// ****************************************************************************
+void networkAudioSend(const uint8_t* frame, unsigned len) { 
+    if (enabled) {
+        // The encoding happens later in the link interrupt
+        session.send(frame, len);
+        irq_set_pending(link_irq);
     }
 }
 
@@ -6,15 +6,34 @@ namespace kc1fsz {
 
 void streaming_uart_setup();
 
-typedef void (*receive_processor)(const uint8_t* buf, unsigned len);
+/**
+ * @param seq The sequence number of the frame (wraps).
+ */
+typedef void (*receive_processor)(uint8_t seq, const uint8_t* buf, unsigned len);
 
 /**
  * Called on every audio tick. Checks for inbound network audio and 
- * dispatches the callback if any is available.
+ * dispatches the callback if any is available. 
+ *
+ * The frames have already been decoded/checked by the link interrupt, 
+ * this only hands over the PCM. This also schedules the link interrupt 
+ * to process whatever has arrived on the UART since the last tick.
  */
 void networkAudioReceiveIfAvailable(receive_processor cb);
 
 /**
+ * Sets the preferred encoding for the audio sent on the link (see 
+ * LinkCodecType). The preferred encoding is only used once the peer
+ * has advertised that it can receive it, until then PCM16 is sent.
+ * Received audio is always decoded according to its own flags.
+ */
+void networkAudioSetCodec(unsigned codec);
+
+/**
+ * Queues a frame for transmission. The compression, the encoding and 
+ * the UART DMA happen later in the link interrupt, so this is safe to 
+ * call from the audio interrupt.
+ *
  * @param audioFrame Does not include header/CRC/COBS
  * @param len At this point (160 * 2)
  */